@@ -598,6 +598,13 @@ namespace discenfw
 		*/
 		const std::vector<xp::Action>& GetForbiddenActions(const std::string& agentName) const;
 
+		/*!
+		Get from the given agent a counter incremented each time its suggested or forbidden actions change
+		(see GetSuggestedActions(), GetForbiddenActions()).
+		@param agentName name of the CyberSystemAgent
+		*/
+		unsigned GetActionHintsVersion(const std::string& agentName) const;
+
 		/*!
 		Get a list of available actions for the current state (consulting the current experience).
 		@param roleId role identifier: actions can be different for different roles in some cyber systems
@@ -741,6 +748,26 @@ namespace discenfw
 		bool SaveExperience(const std::string& agentName, const std::string& filePath, const std::string& goalName = "");
 
 
+		/*!
+		Save a checkpoint of the experience for the given agent without pausing the training:
+		the experience is serialized and saved to a JSON text file in background.
+		@param agentName name of the CyberSystemAgent
+		@param filePath Path to the JSON text file (replaced only when completely written).
+		@param goalName Optional name of goal, if not specified the current goal is used.
+		@return Return false if the checkpoint was not started, or if the given agent does not exist.
+		@see WaitForCheckpoint()
+		*/
+		bool SaveCheckpoint(const std::string& agentName, const std::string& filePath, const std::string& goalName = "");
+
+
+		/*!
+		Wait for the checkpoint of the given agent being saved (if any) to be completed.
+		@param agentName name of the CyberSystemAgent
+		@return Return false if the last checkpoint failed, or if the given agent does not exist.
+		*/
+		bool WaitForCheckpoint(const std::string& agentName);
+
+
 		/*!
 		Optimize the stored experience for assistance (keep only best successful episodes and failures)
 		@param agentName name of the CyberSystemAgent
@@ -760,6 +787,19 @@ namespace discenfw
 		*/
 		void ClearAllExperiences();
 
+		/*!
+		Remove from the system model the states no more referenced by the experiences,
+		the learners and the current episodes of all the agents or by the shared arenas
+		(e.g. after optimizing experiences for assistance).
+		The indices of the remaining states change, thus experiences saved before must be saved again
+		(saved policy tables are still valid, their states are matched by content).
+		@note Agents not registered in the framework (e.g. those of a xp::VectorEnvironment) are not taken into account:
+		do not call this while they exist, collect the states with xp::EnvironmentModel::CollectUnusedStates() instead,
+		adding the states marked by xp::VectorEnvironment::MarkReachableStates().
+		@return The number of removed states.
+		*/
+		int CollectUnusedStates();
+
 		/*!
 		Enable logging for the given agent, used for debugging.
 		@param agentName name of the CyberSystemAgent
@@ -0,0 +1,168 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+#include "discenfw/xp/ref.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace discenfw
+{
+	namespace xp
+	{
+		class EnvironmentModel;
+
+
+		/*!
+		Immutable greedy policy compiled from learned state-action values.
+
+		For each state the best actions are stored in a contiguous table, thus a query takes constant time
+		and needs neither locks nor random numbers (ties are broken choosing the first action).
+		States are identified by a key computed from their content (FNV-1a hash of entity states and features),
+		saved with the table and used to find the states in the environment model,
+		thus a saved table is still valid if the model states are reordered or collected.
+		The table can be saved to a binary file and memory-mapped from it.
+		@note Data is stored in the native byte order (little endian on supported platforms).
+		*/
+		class DISCENFW_API GreedyPolicyTable
+		{
+		public:
+
+			GreedyPolicyTable();
+			~GreedyPolicyTable();
+
+			/*!
+			Compile the table from the given state-action values.
+			@param stateActionValues learned values (see RLAgent::GetStateActionValues())
+			@param model environment model storing the states and actions
+			@return false if the model is not defined.
+			*/
+			bool Build(
+				const std::map<StateActionRef, float>& stateActionValues,
+				std::shared_ptr<EnvironmentModel> model
+				);
+
+			/*!
+			Save the table to a binary file.
+			*/
+			bool Save(const std::string& filePath) const;
+
+			/*!
+			Map the table from a binary file (see Save()).
+			@param filePath path of the file
+			@param model environment model used to decode states and actions
+			@return false if the file could not be opened or it is not valid.
+			*/
+			bool Open(const std::string& filePath, std::shared_ptr<EnvironmentModel> model);
+
+			/*!
+			Release the table data.
+			*/
+			void Clear();
+
+			/*!
+			Check if the table is defined (built or opened).
+			*/
+			bool IsDefined() const { return Offsets != nullptr; }
+
+			/*!
+			Get the number of states (size of the environment model when the table was built).
+			*/
+			int GetStateCount() const { return (int)StateCount; }
+
+			/*!
+			Get the number of distinct actions in the table.
+			*/
+			int GetActionCount() const { return (int)Actions.size(); }
+
+			/*!
+			Get the index of the given state in the table, -1 if not found.
+			*/
+			int GetStateId(const StateRef& state) const;
+
+			/*!
+			Get the number of best actions for the given state index (0 if no value was learned).
+			*/
+			int GetBestActionCount(int stateId) const;
+
+			/*!
+			Get the identifiers of the best actions for the given state index (see GetBestActionCount()).
+			*/
+			const uint32_t* GetBestActionIds(int stateId) const;
+
+			/*!
+			Get the action with the given identifier.
+			*/
+			const ActionRef& GetAction(uint32_t actionId) const { return Actions[actionId]; }
+
+			/*!
+			Get the first best action for the given state, null if not found.
+			*/
+			ActionRef GetBestAction(const StateRef& state) const;
+
+			/*!
+			Choose the first best action for the given state among the given actions.
+			@return The index in the given array of the chosen action, -1 if no best action is possible.
+			*/
+			int ChooseAction(const std::vector<ActionRef>& possibleActions, const StateRef& state) const;
+
+			/*!
+			Add the states with best actions to the given set (see EnvironmentModel::CollectUnusedStates()).
+			*/
+			void MarkReachableStates(StateMarkSet& reachableStates) const;
+
+		protected:
+
+			struct MappedFile;
+
+			std::unique_ptr<MappedFile> Mapping;
+
+			//! Number of states in the table.
+			uint32_t StateCount = 0;
+
+			//! Best actions of state i are Entries[Offsets[i]] ... Entries[Offsets[i+1]-1].
+			const uint32_t* Offsets = nullptr;
+
+			//! Best action identifiers of all the states.
+			const uint32_t* Entries = nullptr;
+
+			//! Offsets data if the table is not mapped from a file.
+			std::vector<uint32_t> OffsetData;
+
+			//! Entries data if the table is not mapped from a file.
+			std::vector<uint32_t> EntryData;
+
+			//! Key of each state of the table, computed from the state content.
+			const uint64_t* StateKeys = nullptr;
+
+			//! State keys data if the table is not mapped from a file.
+			std::vector<uint64_t> StateKeyData;
+
+			//! Actions indexed by identifier.
+			std::vector<ActionRef> Actions;
+
+			//! Actions encoded as strings (used to save the table).
+			std::vector<std::string> ActionStrings;
+
+			//! Index in the table of each state of the model.
+			std::unordered_map<StateRef, int> StateIds;
+
+			//! Map the states of the model to the states of the table, matching their keys.
+			void IndexStates(std::shared_ptr<EnvironmentModel> model);
+		};
+	}
+}
+
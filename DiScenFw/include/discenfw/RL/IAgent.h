@@ -57,6 +57,34 @@ namespace discenfw
 				) = 0;
 
 
+			/*!
+			Choose an action for each of the given states (e.g. for environments stepped together).
+
+			The default implementation calls ChooseAction() for each state,
+			implementations can override it to amortize the cost of the call and of the computation.
+			@param experience experience (state-action values) that can be used by the agent to make a choice
+			@param possibleActions list of actions that can be chosen for each state
+			@param envStates current states of the environments
+			@param updatePolicy update the policy according to the chosen actions
+			@param[out] chosenActions index of the chosen action for each state, -1 if no action was selected
+			*/
+			virtual void ChooseActions(
+				const std::shared_ptr<Experience> experience,
+				const std::vector< std::vector<ActionRef> >& possibleActions,
+				const std::vector<StateRef>& envStates,
+				bool updatePolicy,
+				std::vector<int>& chosenActions
+				)
+			{
+				chosenActions.resize(envStates.size());
+				for (size_t i = 0; i < envStates.size(); i++)
+				{
+					chosenActions[i] = i < possibleActions.size()
+						? ChooseAction(experience, possibleActions[i], envStates[i], updatePolicy) : -1;
+				}
+			}
+
+
 			/*!
 			Get the action choice count, return 0 if no choice was made.
 			*/
@@ -98,6 +126,16 @@ namespace discenfw
 			*/
 			virtual const std::shared_ptr<IAgentConfiguration> GetConfiguration() const = 0;
 
+
+			/*!
+			Add the states referenced by the agent data (e.g. its Q-table) to the given set,
+			they will be kept by the environment model (see EnvironmentModel::CollectUnusedStates()).
+			The default implementation does nothing (for agents without state data).
+			*/
+			virtual void MarkReachableStates(StateMarkSet& /*reachableStates*/) const
+			{
+			}
+
 		};
 
 	}
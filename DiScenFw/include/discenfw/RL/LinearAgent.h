@@ -0,0 +1,200 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+#include "discenfw/RL/IAgent.h"
+#include "discenfw/RL/RLConfig.h"
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace discenfw
+{
+	namespace xp
+	{
+		/*!
+		Reinforcement learning agent approximating the state-action values with a linear function
+		of sparse binary features (semi-gradient Q-learning, see Sutton&Barto 2020, p.244).
+
+		Each entity property value is encoded as a one-hot feature (using the index of the value
+		in the possible property values, if defined), numeric properties without possible values
+		are tile coded, environment features and relationships are encoded as one-hot features.
+		Features are combined with the action and hashed into a fixed size weight vector,
+		thus the memory does not grow with the number of states and values generalize to unseen states.
+		@note The configuration is shared with RLAgent (see RLConfig), SampleAverage, EpsilonReduction and planning are not supported.
+		*/
+		class DISCENFW_API LinearAgent : public IAgent
+		{
+		public:
+
+			/*!
+			Create an agent with the given number of weights.
+			@param featureCount size of the weight vector (hashed features)
+			@param tilings number of overlapping tilings for numeric properties
+			@param tileWidth width of a tile for numeric properties
+			*/
+			LinearAgent(int featureCount = 65536, int tilings = 4, float tileWidth = 1.0f);
+
+			virtual ~LinearAgent();
+
+			/*!
+			Reset the learner, clear the weights.
+			*/
+			virtual void Reset() override;
+
+			/*!
+			Choose an action with an epsilon-greedy policy.
+			@see IAgent::ChooseAction()
+			*/
+			virtual int ChooseAction(
+				const std::shared_ptr<Experience> experience,
+				const std::vector<ActionRef>& possibleActions,
+				StateRef envState,
+				bool updatePolicy
+				) override;
+
+			/*!
+			Get the overall actions count, return 0 if no choice was made.
+			*/
+			virtual int GetActionChoiceCount() const override { return TakenActionCount; }
+
+			/*!
+			Get the exploration actions count, return 0 if no choice was made.
+			*/
+			virtual int GetExplorationActionCount() const override { return RandomActionCount; }
+
+			/*!
+			Reset statistics about the agent behavior.
+			*/
+			virtual void ResetStats() override;
+
+			/*!
+			Learn from a transition triggered by a chosen action
+			(the whole sequence is backed up if the episode succeeded).
+			@see IAgent::Learn()
+			*/
+			virtual void Learn(
+				const std::shared_ptr<Experience> experience,
+				const std::vector<Transition>& transitionSequence,
+				ActionResult lastActionResult
+				) override;
+
+			/*!
+			Set and check the reinforcement learning configuration parameters (see RLConfig).
+			*/
+			virtual void SetConfiguration(const std::shared_ptr<IAgentConfiguration> config) override;
+
+			/*!
+			Get the reinforcement learning configuration parameters.
+			*/
+			virtual const std::shared_ptr<IAgentConfiguration> GetConfiguration() const override { return QLConfiguration; }
+
+			/*!
+			Get the approximated value of the given state-action.
+			*/
+			float GetStateActionValue(StateRef state, ActionRef action) const;
+
+			/*!
+			Get the size of the weight vector.
+			*/
+			int GetFeatureCount() const { return (int)Weights.size(); }
+
+			/*!
+			Compute the hashed features of the given state (before combining them with actions).
+			*/
+			void GetStateFeatures(StateRef state, std::vector<size_t>& features) const;
+
+			/*!
+			Set the maximum number of states for which the possible actions are recorded
+			(the oldest recorded states are forgotten first).
+			*/
+			void SetMaxRecordedStates(int maxRecordedStates);
+
+			/*!
+			Get the maximum number of states for which the possible actions are recorded.
+			*/
+			int GetMaxRecordedStates() const { return (int)MaxRecordedStates; }
+
+			/*!
+			Add the states for which the possible actions are recorded to the given set.
+			*/
+			virtual void MarkReachableStates(StateMarkSet& reachableStates) const override;
+
+		protected:
+
+			//! Weights of the linear function, indexed by hashed feature.
+			std::vector<float> Weights;
+
+			//! Number of overlapping tilings for numeric properties.
+			int Tilings = 4;
+
+			//! Width of a tile for numeric properties.
+			float TileWidth = 1.0f;
+
+			/*!
+			Q-Learning parameters configuration.
+			*/
+			std::shared_ptr<RLConfig> QLConfiguration;
+
+			/*!
+			Possible actions passed to ChooseAction() for each state,
+			used to estimate the value of the next state of a transition.
+			*/
+			std::unordered_map< StateRef, std::vector<ActionRef> > StatePossibleActions;
+
+			//! States in StatePossibleActions, in recording order.
+			std::deque<StateRef> RecordedStates;
+
+			//! Maximum size of StatePossibleActions.
+			size_t MaxRecordedStates = 4096;
+
+			/*!
+			Cached hashes of the encoded actions (cleared when it exceeds MaxCachedActionHashes).
+			*/
+			mutable std::unordered_map<ActionRef, size_t> ActionHashes;
+
+			//! Maximum size of ActionHashes.
+			size_t MaxCachedActionHashes = 4096;
+
+			int RandomActionCount = 0;
+			int TakenActionCount = 0;
+
+			size_t GetActionHash(const ActionRef& action) const;
+
+			/*!
+			Get the weight index of a state feature combined with an action.
+			*/
+			size_t GetWeightIndex(size_t stateFeature, size_t actionHash) const;
+
+			float ComputeValue(const std::vector<size_t>& stateFeatures, const ActionRef& action) const;
+
+			/*!
+			Compute the maximum value of the given state among its recorded possible actions
+			(the initial value is returned if the possible actions are not known).
+			*/
+			float ComputeMaxValue(StateRef state) const;
+
+			/*!
+			Record the possible actions for the given state, forgetting the oldest states if needed.
+			*/
+			void RecordPossibleActions(StateRef state, const std::vector<ActionRef>& possibleActions);
+
+			/*!
+			Semi-gradient Q-learning update for the given transition.
+			*/
+			void LearnTransition(const Transition& transition, const std::shared_ptr<Experience> experience);
+		};
+	}
+}
+
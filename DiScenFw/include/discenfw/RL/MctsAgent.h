@@ -0,0 +1,238 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+#include "discenfw/RL/IAgent.h"
+#include "discenfw/RL/MctsConfig.h"
+#include "discenfw/xp/ICyberSystem.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace discenfw
+{
+	namespace xp
+	{
+		/*!
+		Planning agent choosing actions with Monte Carlo tree search (UCT), no training is needed.
+		(See Sutton&Barto 2020, p.185)
+
+		The search runs on a simulator, a separate instance of the same cyber system.
+		Since cyber systems cannot be cloned, the simulator is restored for each simulation
+		resetting it and replaying the actions from the initial state,
+		thus the agent must be asked to choose from the beginning of each episode.
+		Other roles acting on the same system (e.g. opponents) are simulated as adversaries.
+		States are evaluated with the rewards of the agent role (see RoleInfo::GetStateInfo()).
+		@note The search tree follows action sequences, thus stochastic systems are handled approximately.
+		*/
+		class DISCENFW_API MctsAgent : public IAgent
+		{
+		public:
+
+			/*!
+			Create an agent planning on the given simulator.
+			@param simulator cyber system instance used only for simulations
+			@param otherRoles names of the other roles acting on the system, in turn order
+			*/
+			MctsAgent(
+				std::shared_ptr<ICyberSystem> simulator,
+				const std::vector<std::string>& otherRoles = std::vector<std::string>()
+				);
+
+			virtual ~MctsAgent();
+
+			/*!
+			Reset the agent, clear the search tree.
+			*/
+			virtual void Reset() override;
+
+			/*!
+			Search the best action from the given state.
+			@see IAgent::ChooseAction()
+			*/
+			virtual int ChooseAction(
+				const std::shared_ptr<Experience> experience,
+				const std::vector<ActionRef>& possibleActions,
+				StateRef envState,
+				bool updatePolicy
+				) override;
+
+			/*!
+			Get the overall actions count, return 0 if no choice was made.
+			*/
+			virtual int GetActionChoiceCount() const override { return TakenActionCount; }
+
+			/*!
+			Exploration actions are not counted, return -1.
+			*/
+			virtual int GetExplorationActionCount() const override { return -1; }
+
+			/*!
+			Reset statistics about the agent behavior.
+			*/
+			virtual void ResetStats() override { TakenActionCount = 0; }
+
+			/*!
+			Nothing is learned, the search tree is updated while choosing actions.
+			*/
+			virtual void Learn(
+				const std::shared_ptr<Experience> /*experience*/,
+				const std::vector<Transition>& /*transitionSequence*/,
+				ActionResult /*lastActionResult*/
+				) override
+			{
+			}
+
+			/*!
+			Set and check the configuration parameters (see MctsConfig).
+			*/
+			virtual void SetConfiguration(const std::shared_ptr<IAgentConfiguration> config) override;
+
+			/*!
+			Get the configuration parameters.
+			*/
+			virtual const std::shared_ptr<IAgentConfiguration> GetConfiguration() const override { return Configuration; }
+
+			/*!
+			Add the states of the search tree nodes to the given set.
+			*/
+			virtual void MarkReachableStates(StateMarkSet& reachableStates) const override;
+
+			/*!
+			Get the number of simulations run for the last choice.
+			*/
+			int GetLastIterationCount() const { return LastIterationCount; }
+
+			/*!
+			Get the number of simulations already available for the last choice (from the reused subtree).
+			*/
+			int GetLastReusedVisitCount() const { return LastReusedVisitCount; }
+
+		protected:
+
+			/*!
+			Node of the search tree.
+			*/
+			struct Node
+			{
+				Node* Parent = nullptr;
+
+				//! Action taken from the parent node.
+				ActionRef Action;
+
+				//! State reached by the action sequence from the root.
+				StateRef State;
+
+				//! Index of the acting role (0 = agent role, -1 = no role can act).
+				int RoleIndex = -1;
+
+				bool Terminal = false;
+
+				//! Actions not yet expanded.
+				std::vector<ActionRef> UntriedActions;
+
+				std::vector< std::unique_ptr<Node> > Children;
+
+				int Visits = 0;
+
+				//! Sum of the values (for the agent role) of the simulations through this node.
+				double ValueSum = 0.0;
+			};
+
+			std::shared_ptr<ICyberSystem> Simulator;
+
+			//! Other roles acting on the system.
+			std::vector<std::string> OtherRoles;
+
+			//! Agent role followed by the other roles.
+			std::vector<std::string> Roles;
+
+			std::shared_ptr<MctsConfig> Configuration;
+
+			std::shared_ptr<Experience> CurrentExperience;
+
+			std::unique_ptr<Node> Root;
+
+			//! Actions from the initial state of the simulator to the root.
+			std::vector<ActionRef> RootPath;
+
+			//! Largest absolute reward seen, used to normalize values.
+			double RewardScale = 1.0;
+
+			int TakenActionCount = 0;
+			int LastIterationCount = 0;
+			int LastReusedVisitCount = 0;
+
+			/*!
+			Move the root to the node of the given state, create a new root if not found.
+			@return false if the state cannot be reached by the simulator.
+			*/
+			bool UpdateRoot(StateRef envState, const std::vector<ActionRef>& possibleActions);
+
+			/*!
+			Reset the simulator and replay the actions leading to the root.
+			*/
+			bool RestoreRoot();
+
+			/*!
+			Get the current state of the simulator, stored in the environment model.
+			*/
+			StateRef GetSimulatorState() const;
+
+			/*!
+			Evaluate the current state of the simulator for the agent role,
+			without storing the state in the environment model (used for rollouts).
+			*/
+			EnvironmentStateInfo EvaluateSimulatorState() const;
+
+			/*!
+			Fill the node information from the current simulator state.
+			*/
+			void InitNode(Node& node, StateRef state);
+
+			/*!
+			Value of a state for the agent role.
+			*/
+			double Evaluate(StateRef state);
+
+			/*!
+			Value for the agent role of a state with the given information.
+			*/
+			double Evaluate(const EnvironmentStateInfo& stateInfo);
+
+			/*!
+			Check if the episode is completed in the given state, for the agent role.
+			*/
+			bool IsTerminalState(StateRef state) const;
+
+			/*!
+			Find the first role (in turn order) that can act in the current simulator state.
+			@param smartSelection use the cyber system heuristics
+			@param[out] actions available actions for the acting role
+			@return The index of the acting role, -1 if no role can act.
+			*/
+			int GetActingRole(bool smartSelection, std::vector<ActionRef>& actions) const;
+
+			/*!
+			Run one simulation: selection, expansion, rollout and backup.
+			Only the states of the tree nodes are stored in the environment model.
+			*/
+			void RunIteration();
+
+			Node* SelectChild(const Node& node) const;
+
+			double Rollout(const Node& node);
+		};
+	}
+}
+
@@ -0,0 +1,97 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include "discenfw/RL/IAgentConfiguration.h"
+
+namespace discenfw
+{
+	namespace xp
+	{
+		/*!
+		Parameters configuration for Monte Carlo tree search (see MctsAgent).
+		*/
+		class MctsConfig : public IAgentConfiguration
+		{
+		public:
+
+			/*!
+			Maximum number of search iterations (simulations) for each move (default=1000).
+			*/
+			int IterationBudget = 1000;
+
+			/*!
+			Maximum search time in milliseconds for each move (0 = no time limit, default).
+			*/
+			int TimeBudgetMs = 0;
+
+			/*!
+			Exploration constant of the UCB1 formula (default=1.41).
+			(See Sutton&Barto 2020, p.35, p.185)
+			*/
+			float ExplorationConstant = 1.41f;
+
+			/*!
+			Maximum number of random actions in a rollout (default=100).
+			*/
+			int MaxRolloutDepth = 100;
+
+			/*!
+			Use the cyber system heuristics to select the actions of rollouts (see ICyberSystem::GetAvailableActions()).
+			*/
+			bool SmartRollouts = false;
+
+			/*!
+			Keep the subtree of the reached state between moves (enabled by default).
+			*/
+			bool ReuseTree = true;
+
+
+
+			MctsConfig()
+			{
+			}
+
+			virtual ~MctsConfig()
+			{
+			}
+
+			/*!
+			Get the real class name.
+			*/
+			virtual const char* GetClassName() const override
+			{
+				return "MctsConfig";
+			}
+
+			/*!
+			Check if this class or one of its ancestors has the given class name.
+			*/
+			virtual bool IsA(const std::string& classType) const
+			{
+				return classType == MctsConfig::GetClassName();
+			}
+
+
+			/*!
+			Check and fix parameters.
+			*/
+			void CheckParameters()
+			{
+				if (IterationBudget < 1) IterationBudget = 1;
+				if (TimeBudgetMs < 0) TimeBudgetMs = 0;
+				if (ExplorationConstant < 0.0f) ExplorationConstant = 0.0f;
+				if (MaxRolloutDepth < 0) MaxRolloutDepth = 0;
+			}
+		};
+
+	}
+}
+
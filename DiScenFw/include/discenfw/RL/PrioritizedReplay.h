@@ -0,0 +1,113 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+#include "discenfw/xp/Transition.h"
+
+#include <map>
+#include <vector>
+
+namespace discenfw
+{
+	namespace xp
+	{
+		/*!
+		Replay buffer of transitions sampled with a probability proportional to their priority
+		(usually the absolute TD error of the last update).
+
+		Priorities are stored in a sum tree, thus sampling and updating take O(log n).
+		Each distinct transition is stored once, when the buffer is full the oldest one is replaced.
+		*/
+		class DISCENFW_API PrioritizedReplay
+		{
+		public:
+
+			/*!
+			Create a buffer with the given capacity.
+			@param capacity maximum number of transitions
+			@param priorityExponent exponent applied to priorities (0 = uniform sampling)
+			*/
+			PrioritizedReplay(int capacity = 10000, float priorityExponent = 1.0f);
+
+			~PrioritizedReplay();
+
+			/*!
+			Change capacity and priority exponent, clearing the buffer if they changed.
+			*/
+			void Configure(int capacity, float priorityExponent);
+
+			/*!
+			Get the maximum number of transitions.
+			*/
+			int GetCapacity() const { return Capacity; }
+
+			/*!
+			Get the number of stored transitions.
+			*/
+			int GetSize() const { return (int)Transitions.size(); }
+
+			/*!
+			Add a transition or update its priority if already stored.
+			@return The index of the transition in the buffer.
+			*/
+			int Add(const Transition& transition, float priority);
+
+			/*!
+			Sample a transition with probability proportional to its priority.
+			@param[out] index index of the sampled transition
+			@return false if there is no transition with a positive priority.
+			*/
+			bool Sample(int& index) const;
+
+			/*!
+			Update the priority of the transition at the given index.
+			*/
+			void UpdatePriority(int index, float priority);
+
+			/*!
+			Get the transition at the given index.
+			*/
+			const Transition& GetTransition(int index) const { return Transitions[index]; }
+
+			/*!
+			Get the sum of the (exponentiated) priorities.
+			*/
+			double GetTotalPriority() const { return Tree.empty() ? 0.0 : Tree[1]; }
+
+			/*!
+			Remove all the transitions.
+			*/
+			void Clear();
+
+		protected:
+
+			int Capacity = 0;
+			float PriorityExponent = 1.0f;
+
+			//! Number of leaves in the sum tree (power of two, at least Capacity).
+			int LeafCount = 1;
+
+			//! Sum tree: node i is the sum of nodes 2i and 2i+1, leaves start at LeafCount.
+			std::vector<double> Tree;
+
+			std::vector<Transition> Transitions;
+
+			//! Index of each stored transition.
+			std::map<Transition, int> TransitionIndex;
+
+			//! Next index to be replaced when the buffer is full.
+			int NextReplaced = 0;
+
+			void SetLeaf(int index, double value);
+		};
+	}
+}
+
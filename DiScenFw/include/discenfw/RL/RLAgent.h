@@ -12,6 +12,10 @@
 #include <DiScenFwConfig.h>
 #include "discenfw/RL/IAgent.h"
 #include "discenfw/RL/RLConfig.h"
+#include "discenfw/RL/SharedQTable.h"
+#include "discenfw/RL/PrioritizedReplay.h"
+
+#include <map>
 
 
 namespace discenfw
@@ -111,6 +115,31 @@ namespace discenfw
 			*/
 			virtual bool GetStateActionValue(StateRef state, ActionRef action, float& value) const;
 
+
+			/*!
+			Get all the learned state-action values (e.g. to build a GreedyPolicyTable).
+			*/
+			void GetStateActionValues(std::map<StateActionRef, float>& stateActionValues) const;
+
+
+			/*!
+			Add the states referenced by the Q-table, the learned model, the replay buffer and the traces to the given set.
+			*/
+			virtual void MarkReachableStates(StateMarkSet& reachableStates) const override;
+
+
+			/*!
+			Share the state-action values with other agents learning in parallel threads
+			(set a null pointer to use the local values).
+			@note Values in the shared table are not cleared by Reset().
+			*/
+			void SetSharedQTable(std::shared_ptr<SharedQTable> sharedQTable) { SharedQ = sharedQTable; }
+
+			/*!
+			Get the state-action values shared with other agents, null if not shared.
+			*/
+			std::shared_ptr<SharedQTable> GetSharedQTable() const { return SharedQ; }
+
 		protected:
 
 
@@ -137,6 +166,15 @@ namespace discenfw
 
 				//! States-updates mapping
 				std::map< StateRef, int > StateVisitCountMap;
+
+				//! Maximum value in ActionValueMap (valid if MaxValueDefined is true).
+				float MaxValue = 0.0f;
+
+				//! Action with the maximum value in ActionValueMap.
+				ActionRef MaxAction;
+
+				//! True if MaxValue and MaxAction are defined.
+				bool MaxValueDefined = false;
 			};
 
 			/*!
@@ -149,6 +187,26 @@ namespace discenfw
 			*/
 			mutable std::shared_ptr<RLConfig>  QLConfiguration;
 
+			/*!
+			State-action values shared with other agents (if defined it replaces Q).
+			*/
+			std::shared_ptr<SharedQTable> SharedQ;
+
+			/*!
+			Learned transitions sampled by TD error for planning (see RLConfig::PlanningSteps).
+			*/
+			PrioritizedReplay Replay;
+
+			/*!
+			TD error computed by the last call to QLearn().
+			*/
+			float LastTDError = 0.0f;
+
+			/*!
+			Eligibility traces of the state-actions visited in the current episode (see RLConfig::TraceDecay).
+			*/
+			std::map<StateActionRef, float> Traces;
+
 
 			/*!
 			Mapping for the number of visits to each state.
@@ -180,6 +238,42 @@ namespace discenfw
 				);
 
 
+			/*!
+			Update the shared function approximator (Q-Learning on SharedQ).
+			*/
+			void SharedQLearn(
+				const Transition& transition,
+				const std::shared_ptr<Experience> experience
+				);
+
+
+			/*!
+			Call QLearn() and store the transition for planning (if enabled).
+			*/
+			void LearnTransition(
+				const Transition& transition,
+				const std::shared_ptr<Experience> experience
+				);
+
+
+			/*!
+			Update the function approximator with transitions sampled from the replay buffer
+			(see RLConfig::PlanningSteps).
+			*/
+			void Plan(const std::shared_ptr<Experience> experience);
+
+
+			/*!
+			Learn from the last transition and propagate the TD error
+			to the state-actions with eligibility traces (see RLConfig::TraceDecay).
+			*/
+			void TraceLearn(
+				const std::shared_ptr<Experience> experience,
+				const std::vector<Transition>& transitionSequence,
+				ActionResult lastActionResult
+				);
+
+
 			/*!
 			Call QLearn() on the last transitions for back up.
 			*/
@@ -195,6 +289,12 @@ namespace discenfw
 			*/
 			float GetMaxValue(StateRef state) const;
 
+
+			/*!
+			Set a state-action value, updating the maximum value of the state.
+			*/
+			void SetActionValue(StateRef state, ActionRef action, float value);
+
 		};
 	}
 }
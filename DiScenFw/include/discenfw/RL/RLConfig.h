@@ -63,6 +63,53 @@ namespace discenfw
 			*/
 			float EpsilonReduction = 1.0f;
 
+			/*!
+			Number of planning updates for each real step (Dyna-Q, 0 = disabled, default).
+
+			Learned transitions are stored in a replay buffer and sampled with a probability
+			proportional to their last TD error, then used as a model to update the state-action values.
+			(See Sutton&Barto 2020, p.164, p.170)
+			*/
+			int PlanningSteps = 0;
+
+			/*!
+			Maximum number of transitions stored in the replay buffer used for planning (default=10000).
+			*/
+			int ReplayCapacity = 10000;
+
+			/*!
+			Exponent applied to priorities when sampling transitions for planning
+			(0 = uniform sampling, 1 = proportional to TD error, default=1).
+			*/
+			float PriorityExponent = 1.0f;
+
+			/*!
+			Minimum TD error for a transition to be sampled for planning (default=0.0001).
+			*/
+			float PriorityThreshold = 0.0001f;
+
+			/*!
+			Decay rate (lambda, 0..1) of the eligibility traces (0 = one-step learning, default).
+
+			If positive, each update is propagated to the state-actions visited in the current episode,
+			weighted by their traces, decayed by DiscountRate*TraceDecay at each step.
+			(See Sutton&Barto 2020, p.287, p.312)
+			*/
+			float TraceDecay = 0.0f;
+
+			/*!
+			Clear the eligibility traces when a non-greedy action is taken (Watkins's Q(lambda), default).
+
+			If false, traces are kept along the whole episode as in Sarsa(lambda),
+			thus exploratory actions are credited too.
+			*/
+			bool CutTracesOnExploration = true;
+
+			/*!
+			Traces below this value are discarded (default=0.01).
+			*/
+			float TraceThreshold = 0.01f;
+
 
 
 			RLConfig()
@@ -107,6 +154,12 @@ namespace discenfw
 				Clamp01(FixedStepSize);
 				Clamp01(DiscountRate);
 				Clamp01(Epsilon);
+				if (PlanningSteps < 0) PlanningSteps = 0;
+				if (ReplayCapacity < 1) ReplayCapacity = 1;
+				if (PriorityExponent < 0.0f) PriorityExponent = 0.0f;
+				if (PriorityThreshold < 0.0f) PriorityThreshold = 0.0f;
+				Clamp01(TraceDecay);
+				if (TraceThreshold < 0.0f) TraceThreshold = 0.0f;
 			}
 		};
 
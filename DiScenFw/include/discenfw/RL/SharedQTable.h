@@ -0,0 +1,130 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+#include "discenfw/xp/ref.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace discenfw
+{
+	namespace xp
+	{
+		/*!
+		State-action value table shared by learners running in parallel threads.
+
+		States are distributed among shards, each one protected by its own lock,
+		thus learners updating different states seldom wait for each other.
+		All the actions of a state are stored in the same shard,
+		so the maximum value of a state is read with a single lock.
+		*/
+		class DISCENFW_API SharedQTable
+		{
+		public:
+
+			/*!
+			Function computing the updated value of a state-action.
+			@param value current value
+			@param count number of updates (this one included, the first time it is 1)
+			@return the new value
+			*/
+			using UpdateFunction = std::function<float(float value, int count)>;
+
+			/*!
+			Create a table with the given number of shards (locks).
+			*/
+			SharedQTable(int shardCount = 64);
+
+			~SharedQTable();
+
+			/*!
+			Get the number of shards.
+			*/
+			int GetShardCount() const { return (int)Shards.size(); }
+
+			/*!
+			Get the value of the given state-action, return false if it is not defined.
+			*/
+			bool GetValue(StateRef state, ActionRef action, float& value) const;
+
+			/*!
+			Get the maximum action value for the given state, return false if the state is not defined.
+			*/
+			bool GetMaxValue(StateRef state, float& maxValue) const;
+
+			/*!
+			Update atomically the value of the given state-action.
+			@param state state
+			@param action action taken from the state
+			@param initialValue value assigned before the first update
+			@param update function computing the new value (called with the shard lock held)
+			@return the new value
+			*/
+			float UpdateValue(
+				StateRef state,
+				ActionRef action,
+				float initialValue,
+				const UpdateFunction& update
+				);
+
+			/*!
+			Get the number of stored state-action values.
+			*/
+			size_t GetSize() const;
+
+			/*!
+			Copy all the stored values, locking all the shards
+			to get a consistent snapshot (e.g. for checkpointing).
+			*/
+			void GetSnapshot(std::map<StateActionRef, float>& stateActionValues) const;
+
+			/*!
+			Add the states with stored values to the given set (see EnvironmentModel::CollectUnusedStates()).
+			*/
+			void MarkReachableStates(StateMarkSet& reachableStates) const;
+
+			/*!
+			Remove all the stored values.
+			*/
+			void Clear();
+
+		protected:
+
+			struct ValueInfo
+			{
+				float Value = 0.0f;
+				int Count = 0;
+			};
+
+			struct Row
+			{
+				std::map< ActionRef, ValueInfo > ActionValueMap;
+				float MaxValue = 0.0f;
+			};
+
+			struct Shard
+			{
+				mutable std::mutex Mutex;
+				std::unordered_map< StateRef, Row > Rows;
+			};
+
+			std::vector< std::unique_ptr<Shard> > Shards;
+
+			Shard& GetShard(const StateRef& state) const;
+		};
+	}
+}
+
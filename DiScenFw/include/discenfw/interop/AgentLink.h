@@ -62,6 +62,19 @@ namespace discenfw
 				);
 
 
+			/*!
+			Choose an action for each of the given states with a single call to the agent implementation.
+			@see IAgent::ChooseActions()
+			*/
+			virtual void ChooseActions(
+				const std::shared_ptr<Experience> experience,
+				const std::vector< std::vector<ActionRef> >& possibleActions,
+				const std::vector<StateRef>& envStates,
+				bool updatePolicy,
+				std::vector<int>& chosenActions
+				);
+
+
 			/*!
 			Get the action choice count, return 0 if no choice was made.
 			*/
@@ -0,0 +1,217 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+#include "discenfw/sim/ScenarioHistoryData.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace discenfw
+{
+	namespace sim
+	{
+		/*!
+		Binary columnar archive for simulation history data.
+
+		Each entity history is stored as a set of arrays (start time, end time, origin,
+		position, orientation, representation, parent), times are stored as milliseconds
+		elapsed since a base date/time (the earliest time in the history).
+		A keyframe index (start time of every N-th state) allows seeking a state by time
+		without scanning the whole history.
+
+		The archive is accessed through a memory mapping of the file: opening an archive
+		does not load any state, states are decoded on request (see GetState(), LoadEntityStates())
+		or the whole history can be decoded to a ScenarioHistory (see Load()).
+		Archives written by previous versions (without event entities) can be read.
+		@note Data is stored in the native byte order (little endian on supported platforms).
+		*/
+		class DISCENFW_API HistoryArchive
+		{
+		public:
+
+			HistoryArchive();
+			~HistoryArchive();
+
+			/*!
+			Write the given history to a binary archive file.
+			@param filePath Path of the archive file.
+			@param history History to be stored.
+			@param keyframeStride Number of states between two entries of the keyframe index.
+			*/
+			static bool Write(const std::string& filePath, const ScenarioHistory& history, int keyframeStride = 64);
+
+			/*!
+			Open (memory map) an archive file.
+			*/
+			bool Open(const std::string& filePath);
+
+			/*!
+			Close the archive (unmap the file).
+			*/
+			void Close();
+
+			/*!
+			Check if an archive is open.
+			*/
+			bool IsOpen() const;
+
+			/*!
+			Get the path of the open archive file (empty if not open).
+			*/
+			const std::string& GetFilePath() const { return FilePath; }
+
+			/*!
+			Get the reference date/time (all the time values are relative to this).
+			*/
+			const DateTime& GetBaseDateTime() const { return BaseDateTime; }
+
+			/*!
+			Convert a date/time to milliseconds since the base date/time.
+			*/
+			long long ToTimeMs(const DateTime& dateTime) const;
+
+			/*!
+			Convert milliseconds since the base date/time to a date/time.
+			*/
+			DateTime ToDateTime(long long timeMs) const;
+
+			/*!
+			Fill the descriptive fields and the time interval of the given history
+			(entity histories and events are not loaded).
+			*/
+			bool GetInfo(ScenarioHistory& history) const;
+
+			/*!
+			Get the start time in milliseconds since the base date/time.
+			*/
+			long long GetStartTimeMs() const;
+
+			/*!
+			Get the end time in milliseconds since the base date/time.
+			*/
+			long long GetEndTimeMs() const;
+
+			/*!
+			Get the number of entity histories stored in the archive.
+			*/
+			int GetEntityCount() const;
+
+			/*!
+			Get the identifier of the entity at the given index.
+			*/
+			std::string GetEntityId(int entityIndex) const;
+
+			/*!
+			Find the index of the entity with the given identifier (-1 if not found).
+			*/
+			int FindEntity(const std::string& entityId) const;
+
+			/*!
+			Get the start time (milliseconds since the base date/time) of the entity at the given index.
+			*/
+			long long GetEntityStartMs(int entityIndex) const;
+
+			/*!
+			Get the end time (milliseconds since the base date/time) of the entity at the given index.
+			*/
+			long long GetEntityEndMs(int entityIndex) const;
+
+			/*!
+			Get the number of states stored for the entity at the given index.
+			*/
+			int GetStateCount(int entityIndex) const;
+
+			/*!
+			Get the start time (milliseconds since the base date/time) of the given state.
+			*/
+			long long GetStateStartMs(int entityIndex, int stateIndex) const;
+
+			/*!
+			Get the end time (milliseconds since the base date/time) of the given state.
+			*/
+			long long GetStateEndMs(int entityIndex, int stateIndex) const;
+
+			/*!
+			Find the last state starting at or before the given time (milliseconds since the base date/time).
+			@return The index of the state found, -1 if all the states start after the given time.
+			*/
+			int FindStateIndex(int entityIndex, long long timeMs) const;
+
+			/*!
+			Decode the state at the given index.
+			*/
+			std::shared_ptr<TemporalState> GetState(int entityIndex, int stateIndex) const;
+
+			/*!
+			Decode a range of states, appending them to the given vector.
+			@param entityIndex Index of the entity.
+			@param firstState Index of the first state to decode.
+			@param stateCount Number of states to decode (negative = all the following states).
+			@param states Vector to which decoded states are appended.
+			*/
+			bool LoadEntityStates(
+				int entityIndex,
+				int firstState,
+				int stateCount,
+				std::vector< std::shared_ptr<TemporalState> >& states
+				) const;
+
+			/*!
+			Decode the whole history of the entity at the given index.
+			*/
+			bool LoadEntityHistory(int entityIndex, EntityHistory& history) const;
+
+			/*!
+			Get the number of events stored in the archive.
+			*/
+			int GetEventCount() const;
+
+			/*!
+			Get the time (milliseconds since the base date/time) of the given event
+			(events are sorted by time).
+			*/
+			long long GetEventTimeMs(int eventIndex) const;
+
+			/*!
+			Decode the event at the given index.
+			*/
+			std::shared_ptr<HistoryEvent> GetEvent(int eventIndex) const;
+
+			/*!
+			Decode the whole history (previous data is replaced).
+			*/
+			bool Load(ScenarioHistory& history) const;
+
+		private:
+
+			struct MappedFile;
+
+			std::unique_ptr<MappedFile> Mapping;
+			std::string FilePath;
+			DateTime BaseDateTime;
+
+			const char* Data = nullptr;
+			size_t DataSize = 0;
+
+			//! Size of the event records (depends on the archive version).
+			size_t EventRecordSize = 0;
+
+			std::string GetString(unsigned stringIndex) const;
+			const void* GetEntityRecord(int entityIndex) const;
+			const void* GetEventRecord(int eventIndex) const;
+			bool ValidEntityIndex(int entityIndex) const;
+			bool ValidStateIndex(int entityIndex, int stateIndex) const;
+		};
+	}
+}
+
@@ -0,0 +1,125 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+#include "discenfw/sim/ScenarioHistoryData.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace discenfw
+{
+	namespace sim
+	{
+		/*!
+		Time index of history events.
+
+		Events are sorted by time (milliseconds since a base date/time),
+		with a secondary index of the events of each entity (see HistoryEvent::EntityId),
+		time interval queries are answered with a binary search.
+		*/
+		class DISCENFW_API HistoryEventIndex
+		{
+		public:
+
+			HistoryEventIndex();
+			~HistoryEventIndex();
+
+			/*!
+			Build the index for the given events.
+			@param events Events to be indexed (in any order).
+			@param baseDateTime Date/time used as reference for times in milliseconds.
+			*/
+			void Build(const std::vector< std::shared_ptr<HistoryEvent> >& events, const DateTime& baseDateTime);
+
+			/*!
+			Clear the index.
+			*/
+			void Clear();
+
+			/*!
+			Get the number of indexed events.
+			*/
+			int GetEventCount() const { return (int)Events.size(); }
+
+			/*!
+			Get the event at the given position (events are sorted by time).
+			*/
+			const std::shared_ptr<HistoryEvent>& GetEvent(int position) const { return Events[position]; }
+
+			/*!
+			Get the time (milliseconds since the base date/time) of the event at the given position.
+			*/
+			long long GetEventTimeMs(int position) const { return EventTimes[position]; }
+
+			/*!
+			Get the position of the first event occurred at or after the given time (milliseconds since the base date/time).
+			*/
+			int LowerBound(long long timeMs) const;
+
+			/*!
+			Get the position of the first event occurred after the given time (milliseconds since the base date/time).
+			*/
+			int UpperBound(long long timeMs) const;
+
+			/*!
+			Find the events occurred in the given time interval (bounds included), appending them to the given vector.
+			*/
+			void FindEvents(
+				const DateTime& startDateTime,
+				const DateTime& endDateTime,
+				std::vector< std::shared_ptr<HistoryEvent> >& events
+				) const;
+
+			/*!
+			Find the events of the given entity, appending them to the given vector.
+			*/
+			void FindEntityEvents(
+				const std::string& entityId,
+				std::vector< std::shared_ptr<HistoryEvent> >& events
+				) const;
+
+			/*!
+			Find the events of the given entity occurred in the given time interval (bounds included),
+			appending them to the given vector.
+			*/
+			void FindEntityEvents(
+				const std::string& entityId,
+				const DateTime& startDateTime,
+				const DateTime& endDateTime,
+				std::vector< std::shared_ptr<HistoryEvent> >& events
+				) const;
+
+		protected:
+
+			DateTime BaseDateTime;
+
+			//! Events sorted by time.
+			std::vector< std::shared_ptr<HistoryEvent> > Events;
+
+			//! Time of each event (milliseconds since BaseDateTime).
+			std::vector<long long> EventTimes;
+
+			//! Positions of the events of each entity (sorted by time).
+			std::map< std::string, std::vector<int> > EntityEvents;
+
+			void FindEntityEvents(
+				const std::string& entityId,
+				long long startTimeMs,
+				long long endTimeMs,
+				std::vector< std::shared_ptr<HistoryEvent> >& events
+				) const;
+		};
+	}
+}
+
@@ -10,6 +10,8 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <memory>
 #include <ctime>
 
 namespace discenfw
@@ -17,6 +19,7 @@ namespace discenfw
 	namespace sim
 	{
 		struct EntityHistory;
+		struct TemporalState;
 
 		/*!
 		Parser for importing simulation history log files.
@@ -30,6 +33,8 @@ namespace discenfw
 		@code
 		2013-11-27T09:00:00	2013-11-27T09:00:02	SIMULATED	0 0 100	0.01	1 0 0  0 1 0  0 0 1	ScenarioRoot
 		@endcode
+		Files are memory mapped and tokenized in place, large logs are split on line boundaries
+		and the resulting chunks are parsed in parallel (see ThreadCount, MinChunkSize).
 		@see DateTime, CoordSys3D
 		*/
 		class HistoryLogParser
@@ -41,6 +46,16 @@ namespace discenfw
 			*/
 			float ScaleFactor = 1.0f;
 
+			/*!
+			Maximum number of threads used for parsing (0 = hardware concurrency, 1 = no parallel parsing).
+			*/
+			unsigned ThreadCount = 0;
+
+			/*!
+			Minimum size in bytes of a chunk of text parsed by a separate thread.
+			*/
+			size_t MinChunkSize = 4 * 1024 * 1024;
+
 			HistoryLogParser();
 			~HistoryLogParser();
 
@@ -53,6 +68,23 @@ namespace discenfw
 			Parse a simulation history log text.
 			*/
 			bool ParseText(const std::string& logText, EntityHistory& history);
+
+			/*!
+			Parse a simulation history log from a memory buffer (not required to be null-terminated).
+			*/
+			bool ParseBuffer(const char* textBegin, const char* textEnd, EntityHistory& history);
+
+		protected:
+
+			/*!
+			Parse the lines in the given text range, appending the parsed states to the given vector.
+			@return the number of invalid lines skipped.
+			*/
+			int ParseLines(
+				const char* textBegin,
+				const char* textEnd,
+				std::vector< std::shared_ptr<TemporalState> >& states
+				) const;
 		};
 	}
 }
@@ -0,0 +1,111 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+#include "discenfw/sim/ScenarioHistoryData.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace discenfw
+{
+	namespace sim
+	{
+		class HistoryArchive;
+
+		/*!
+		Headless replay of a simulation history at a fixed time step.
+
+		The history is stepped as fast as possible, without any virtual environment,
+		and for each step the state of each entity is passed to a frame sink.
+		Steps are computed in integer milliseconds, thus the replay is deterministic.
+		*/
+		class DISCENFW_API HistoryReplay
+		{
+		public:
+
+			/*!
+			State of an entity at a replay step.
+			*/
+			struct Frame
+			{
+				//! Identifier of the entity.
+				std::string EntityId;
+
+				//! Step index (starting from 0).
+				long long Step = 0;
+
+				//! Simulation time in seconds since the history start.
+				double Time = 0.0;
+
+				//! Simulation date/time.
+				DateTime DateTime;
+
+				/*!
+				State of the entity at this time (if NextState is defined,
+				the previous state of an interpolation).
+				*/
+				std::shared_ptr<ElementState> State;
+
+				//! Next state if the time is between two states, otherwise null.
+				std::shared_ptr<ElementState> NextState;
+
+				//! Interpolation factor (0..1) between State and NextState.
+				float Lerp = 0.0f;
+			};
+
+			//! Function receiving the entity states for each replay step.
+			using FrameSink = std::function<void(const Frame& frame)>;
+
+			//! Function receiving the history events reached at each replay step.
+			using EventSink = std::function<void(double time, const std::shared_ptr<HistoryEvent>& historyEvent)>;
+
+			/*!
+			Simulated time step in seconds (minimum 1 millisecond).
+			*/
+			double TimeStep = 0.1;
+
+			HistoryReplay();
+			~HistoryReplay();
+
+			/*!
+			Set the function receiving the entity states for each replay step.
+			*/
+			void SetFrameSink(FrameSink frameSink) { OnFrame = frameSink; }
+
+			/*!
+			Set the function receiving the history events (optional).
+			*/
+			void SetEventSink(EventSink eventSink) { OnEvent = eventSink; }
+
+			/*!
+			Replay the given history (the time interval is computed from the entity states).
+			@return The number of steps replayed.
+			*/
+			long long Run(const ScenarioHistory& history);
+
+			/*!
+			Replay the given history archive, decoding states only when needed.
+			@return The number of steps replayed.
+			*/
+			long long Run(const HistoryArchive& archive);
+
+		private:
+
+			FrameSink OnFrame;
+			EventSink OnEvent;
+
+			long long GetTimeStepMs() const;
+		};
+	}
+}
+
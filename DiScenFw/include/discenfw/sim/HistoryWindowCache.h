@@ -0,0 +1,123 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+#include "discenfw/sim/ScenarioHistoryData.h"
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace discenfw
+{
+	namespace sim
+	{
+		class HistoryArchive;
+
+		/*!
+		Cache of entity history segments loaded on demand from a HistoryArchive.
+
+		Entity states are decoded in segments of a fixed number of states:
+		the segment containing the playback cursor and its neighbours are kept resident,
+		while the least recently used segments are evicted when the estimated memory
+		used by decoded states exceeds the memory budget.
+		*/
+		class DISCENFW_API HistoryWindowCache
+		{
+		public:
+
+			/*!
+			Create a cache for the given archive.
+			@param archive Open history archive.
+			@param memoryBudget Maximum memory (bytes) used by decoded states.
+			@param segmentSize Number of states in each segment.
+			*/
+			HistoryWindowCache(
+				const std::shared_ptr<HistoryArchive>& archive,
+				size_t memoryBudget = 256 * 1024 * 1024,
+				int segmentSize = 1024
+				);
+
+			~HistoryWindowCache();
+
+			/*!
+			Get the source archive.
+			*/
+			const std::shared_ptr<HistoryArchive>& GetArchive() const { return Archive; }
+
+			/*!
+			Get the maximum memory (bytes) used by decoded states.
+			*/
+			size_t GetMemoryBudget() const { return MemoryBudget; }
+
+			/*!
+			Set the maximum memory (bytes) used by decoded states (segments in use are never evicted).
+			*/
+			void SetMemoryBudget(size_t memoryBudget);
+
+			/*!
+			Get the number of states in each segment.
+			*/
+			int GetSegmentSize() const { return SegmentSize; }
+
+			/*!
+			Get the estimated memory (bytes) used by resident segments.
+			*/
+			size_t GetResidentBytes() const { return ResidentBytes; }
+
+			/*!
+			Get the number of resident segments.
+			*/
+			int GetResidentSegmentCount() const { return (int)Segments.size(); }
+
+			/*!
+			Update the states in the given history with the window around the given time.
+			@param entityIndex Index of the entity in the archive.
+			@param timeMs Time (milliseconds since the archive base date/time).
+			@param history Entity history whose states are replaced with the window states.
+			@return true if the window changed, false if it is unchanged or the entity is not valid.
+			*/
+			bool UpdateWindow(int entityIndex, long long timeMs, EntityHistory& history);
+
+			/*!
+			Evict all the resident segments.
+			*/
+			void Clear();
+
+		protected:
+
+			struct Segment
+			{
+				std::vector< std::shared_ptr<TemporalState> > States;
+				size_t Bytes = 0;
+				unsigned long long LastAccess = 0;
+			};
+
+			std::shared_ptr<HistoryArchive> Archive;
+			size_t MemoryBudget = 0;
+			int SegmentSize = 1024;
+
+			// (entity index, segment index) -> segment
+			std::map< std::pair<int, int>, Segment > Segments;
+
+			// entity index -> segment at the center of the current window
+			std::map<int, int> WindowCenters;
+
+			size_t ResidentBytes = 0;
+			unsigned long long AccessCount = 0;
+
+			Segment& LoadSegment(int entityIndex, int segmentIndex);
+			void EvictSegments();
+		};
+	}
+}
+
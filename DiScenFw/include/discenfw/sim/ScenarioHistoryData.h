@@ -82,6 +82,11 @@ namespace discenfw
 			std::string Uri;
 			std::string Category;
 			DateTime DateTime;
+
+			/*!
+			Identifier of the entity involved in the event (optional).
+			*/
+			std::string EntityId;
 		};
 
 
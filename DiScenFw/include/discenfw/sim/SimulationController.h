@@ -12,6 +12,7 @@
 #include <DiScenFwConfig.h>
 #include "discenfw/sim/ScenarioHistoryData.h"
 #include "discenfw/sim/SimulationExecutor.h"
+#include "discenfw/sim/HistoryEventIndex.h"
 #include <discenfw/ve/VirtualEnvironmentAPI.h>
 
 #include <memory>
@@ -22,6 +23,9 @@ namespace discenfw
 {
 	namespace sim
 	{
+		class HistoryArchive;
+		class HistoryWindowCache;
+
 		/*!
 		Controller for simulation playback.
 		*/
@@ -74,6 +78,12 @@ namespace discenfw
 			*/
 			std::function<void(float)> SimulationTimeChanged;
 
+			/*!
+			Event triggered for each history event reached while the simulation time moves forward
+			(events are triggered in time order, moving backward does not trigger events).
+			*/
+			std::function<void(const std::shared_ptr<HistoryEvent>&)> HistoryEventReached;
+
 			/*!
 			Default constructor: create an empty simulation history.
 			*/
@@ -91,6 +101,11 @@ namespace discenfw
 				return SimulationHistory && !SimulationHistory->EntityHistories.empty();
 			}
 
+			/*!
+			Get the time index of the history events (times relative to the simulation start).
+			*/
+			const HistoryEventIndex& GetEventIndex() const { return EventIndex; }
+
 			/*!
 			Get the total simulation duration in seconds.
 			*/
@@ -176,6 +191,27 @@ namespace discenfw
 			*/
 			bool InitSimulation();
 
+			/*!
+			Prepare the simulation streaming entity histories from the given archive:
+			states are loaded in windows around the simulation time (see SetHistoryMemoryBudget()).
+			*/
+			bool InitSimulation(const std::shared_ptr<HistoryArchive>& archive);
+
+			/*!
+			Check if entity histories are loaded on demand from a history archive.
+			*/
+			bool IsHistoryWindowed() { return WindowCache != nullptr; }
+
+			/*!
+			Get the maximum memory (bytes) used by history states loaded on demand.
+			*/
+			size_t GetHistoryMemoryBudget() { return HistoryMemoryBudget; }
+
+			/*!
+			Set the maximum memory (bytes) used by history states loaded on demand.
+			*/
+			void SetHistoryMemoryBudget(size_t memoryBudget);
+
 			/*!
 			Prepare the simulation loading each entity history and computing the overall data.
 			*/
@@ -226,6 +262,20 @@ namespace discenfw
 			bool IsSimulationStarted = false;
 			bool IsSimulationPaused = false;
 			std::map< std::string, std::shared_ptr<SimulationExecutor> > Executors;
+
+			size_t HistoryMemoryBudget = 256 * 1024 * 1024;
+			std::shared_ptr<HistoryWindowCache> WindowCache;
+			// entity identifier -> entity index in the history archive
+			std::map<std::string, int> WindowedEntities;
+
+			HistoryEventIndex EventIndex;
+			// position in EventIndex of the first event not yet reached
+			int NextEventPosition = 0;
+
+			void InitExecutor(const std::string& entityId, const std::shared_ptr<EntityHistory>& history);
+			void UpdateHistoryWindows();
+			void InitEventIndex();
+			void TriggerHistoryEvents();
 		};
 
 	}
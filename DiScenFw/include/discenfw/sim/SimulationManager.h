@@ -71,6 +71,14 @@ namespace discenfw
 			*/
 			void SetScenarioData(std::shared_ptr<Scenario> scenario);
 
+			/*!
+			Get the history data.
+			*/
+			std::shared_ptr<ScenarioHistory> GetHistoryData()
+			{
+				return HistoryData;
+			}
+
 			/*!
 			Get the owned SimulationController.
 			*/
@@ -98,9 +106,30 @@ namespace discenfw
 
 			/*!
 			Write history data to a JSON text file.
+			@note The history cannot be saved while it is streamed from an archive (see OpenHistoryArchive()).
 			*/
 			bool SaveHistoryJson(const std::string& jsonFile);
 
+			/*!
+			Load history data from a binary history archive file.
+			@see HistoryArchive
+			*/
+			bool LoadHistoryArchive(const std::string& archiveFile);
+
+			/*!
+			Write history data to a binary history archive file.
+			@note The history cannot be saved while it is streamed from an archive (see OpenHistoryArchive()).
+			@see HistoryArchive
+			*/
+			bool SaveHistoryArchive(const std::string& archiveFile);
+
+			/*!
+			Open a binary history archive file for streaming: entity states are loaded
+			on demand around the simulation time, within the simulation memory budget.
+			@see HistoryArchive, SimulationController::SetHistoryMemoryBudget()
+			*/
+			bool OpenHistoryArchive(const std::string& archiveFile);
+
 
 			/*!
 			Update the simulation updating a VE (if connected).
@@ -119,6 +148,11 @@ namespace discenfw
 			std::string ErrorList;
 
 			void LoadHistoryLogs();
+
+			/*!
+			Check if the whole history is in memory (not streamed from an archive), log an error if not.
+			*/
+			bool CheckHistoryComplete(const std::string& filePath);
 		};
 	}
 }
@@ -64,6 +64,16 @@ namespace discenfw
 	*/
 	DISCENFW_API DateTime DateTimeAddMs(const DateTime& dateTime, long ms);
 
+	/*!
+	Add to a date time the given milliseconds (offsets exceeding a 32 bit long are supported).
+	*/
+	DISCENFW_API DateTime DateTimeAddLongMs(const DateTime& dateTime, long long ms);
+
+	/*!
+	Check if a date time is defined (month and day are set).
+	*/
+	DISCENFW_API bool DateTimeDefined(const DateTime& dateTime);
+
 }
 
 #ifdef DISCENFW_IMPORT
@@ -0,0 +1,269 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+
+#include "discenfw/xp/Episode.h"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+namespace discenfw
+{
+	namespace xp
+	{
+		class CompactEpisodeStore;
+
+		/*!
+		Lightweight read-only view of an episode,
+		either stored as an Episode object or in a CompactEpisodeStore.
+		@note The view is valid until the referenced episode or store is modified.
+		*/
+		class EpisodeView
+		{
+		public:
+
+			/*!
+			View of an episode object.
+			*/
+			EpisodeView(const Episode* episode) : EpisodeObject(episode) {}
+
+			/*!
+			View of an episode object with the given repetitions count (instead of the one of the object).
+			*/
+			EpisodeView(const Episode* episode, int repetitionsCount) : EpisodeObject(episode), RepetitionsCount(repetitionsCount) {}
+
+			/*!
+			View of an episode in a compact store.
+			*/
+			EpisodeView(const CompactEpisodeStore* store, size_t index) : Store(store), Index(index) {}
+
+			const StateRef& GetInitialState() const;
+			const StateRef& GetLastState() const;
+			int GetPerformance() const;
+			ActionResult GetResult() const;
+			int GetRepetitionsCount() const;
+
+			/*!
+			Get the length of the transition sequence.
+			*/
+			size_t GetTransitionCount() const;
+
+			const StateRef& GetStartState(size_t transitionIndex) const;
+			const ActionRef& GetActionTaken(size_t transitionIndex) const;
+			const StateRef& GetEndState(size_t transitionIndex) const;
+
+			/*!
+			Get a copy of the transition at the given position in the sequence.
+			*/
+			Transition GetTransition(size_t transitionIndex) const
+			{
+				Transition transition;
+				transition.StartState = GetStartState(transitionIndex);
+				transition.ActionTaken = GetActionTaken(transitionIndex);
+				transition.EndState = GetEndState(transitionIndex);
+				return transition;
+			}
+
+			/*!
+			Create a new episode object with a copy of the viewed episode.
+			*/
+			std::shared_ptr<Episode> ToEpisode() const;
+
+		protected:
+
+			const Episode* EpisodeObject = nullptr;
+			const CompactEpisodeStore* Store = nullptr;
+			size_t Index = 0;
+
+			//! Repetitions count overriding the one of EpisodeObject, if not negative.
+			int RepetitionsCount = -1;
+		};
+
+
+		/*!
+		Episode history stored in contiguous arrays (columns) of 32-bit state and action identifiers,
+		with the transitions of each episode delimited by per-episode offsets.
+		States and actions are referenced once in internal tables,
+		thus the memory used for each transition is fixed and no allocation is needed per episode.
+		Episodes are only appended, they can be read through an EpisodeView.
+		*/
+		class DISCENFW_API CompactEpisodeStore
+		{
+		public:
+
+			CompactEpisodeStore();
+
+			/*!
+			Append a copy of the given episode.
+			@return The index of the stored episode.
+			*/
+			size_t AddEpisode(const std::shared_ptr<Episode>& episode);
+
+			/*!
+			Get the number of stored episodes.
+			*/
+			size_t GetEpisodeCount() const { return Results.size(); }
+
+			/*!
+			Get the overall number of stored transitions.
+			*/
+			size_t GetTransitionCount() const { return StartStateIds.size(); }
+
+			/*!
+			Get a view of the episode stored at the given position.
+			*/
+			EpisodeView GetEpisode(size_t index) const { return EpisodeView(this, index); }
+
+			/*!
+			Get the fingerprint of the episode stored at the given position (see Episode::GetFingerprint()).
+			*/
+			size_t GetFingerprint(size_t index) const { return Fingerprints[index]; }
+
+			/*!
+			Increment the repetitions count of the episode stored at the given position.
+			*/
+			void IncrementRepetitionsCount(size_t index) { RepetitionsCounts[index]++; }
+
+			/*!
+			Remove all the episodes and release the referenced states and actions.
+			*/
+			void Clear();
+
+			/*!
+			Estimate the memory used by the stored data (in bytes).
+			*/
+			size_t GetMemoryUsage() const;
+
+			/*!
+			Add the states referenced by the stored episodes to the given set.
+			*/
+			void MarkReachableStates(StateMarkSet& reachableStates) const;
+
+		protected:
+
+			friend class EpisodeView;
+
+			//! Referenced states, the first element (null) is used for undefined states.
+			std::vector<StateRef> States;
+
+			//! Referenced actions, the first element (null) is used for undefined actions.
+			std::vector<ActionRef> Actions;
+
+			//! Identifiers of the referenced states.
+			std::unordered_map<const EnvironmentState*, uint32_t> StateIds;
+
+			//! Identifiers of the referenced actions.
+			std::unordered_map<const Action*, uint32_t> ActionIds;
+
+			//! Offset of the first transition of each episode, followed by the overall transition count.
+			std::vector<uint32_t> EpisodeOffsets;
+
+			std::vector<uint32_t> InitialStateIds;
+			std::vector<uint32_t> LastStateIds;
+			std::vector<int> Performances;
+			std::vector<ActionResult> Results;
+			std::vector<int> RepetitionsCounts;
+			std::vector<size_t> Fingerprints;
+
+			std::vector<uint32_t> StartStateIds;
+			std::vector<uint32_t> ActionIdSequence;
+			std::vector<uint32_t> EndStateIds;
+
+			uint32_t GetStateId(const StateRef& state);
+			uint32_t GetActionId(const ActionRef& action);
+		};
+
+
+		inline const StateRef& EpisodeView::GetInitialState() const
+		{
+			return EpisodeObject ? EpisodeObject->InitialState : Store->States[Store->InitialStateIds[Index]];
+		}
+
+
+		inline const StateRef& EpisodeView::GetLastState() const
+		{
+			return EpisodeObject ? EpisodeObject->LastState : Store->States[Store->LastStateIds[Index]];
+		}
+
+
+		inline int EpisodeView::GetPerformance() const
+		{
+			return EpisodeObject ? EpisodeObject->Performance : Store->Performances[Index];
+		}
+
+
+		inline ActionResult EpisodeView::GetResult() const
+		{
+			return EpisodeObject ? EpisodeObject->Result : Store->Results[Index];
+		}
+
+
+		inline int EpisodeView::GetRepetitionsCount() const
+		{
+			if (RepetitionsCount >= 0)
+			{
+				return RepetitionsCount;
+			}
+			return EpisodeObject ? EpisodeObject->RepetitionsCount : Store->RepetitionsCounts[Index];
+		}
+
+
+		inline size_t EpisodeView::GetTransitionCount() const
+		{
+			return EpisodeObject ? EpisodeObject->TransitionSequence.size()
+				: Store->EpisodeOffsets[Index + 1] - Store->EpisodeOffsets[Index];
+		}
+
+
+		inline const StateRef& EpisodeView::GetStartState(size_t transitionIndex) const
+		{
+			return EpisodeObject ? EpisodeObject->TransitionSequence[transitionIndex].StartState
+				: Store->States[Store->StartStateIds[Store->EpisodeOffsets[Index] + transitionIndex]];
+		}
+
+
+		inline const ActionRef& EpisodeView::GetActionTaken(size_t transitionIndex) const
+		{
+			return EpisodeObject ? EpisodeObject->TransitionSequence[transitionIndex].ActionTaken
+				: Store->Actions[Store->ActionIdSequence[Store->EpisodeOffsets[Index] + transitionIndex]];
+		}
+
+
+		inline const StateRef& EpisodeView::GetEndState(size_t transitionIndex) const
+		{
+			return EpisodeObject ? EpisodeObject->TransitionSequence[transitionIndex].EndState
+				: Store->States[Store->EndStateIds[Store->EpisodeOffsets[Index] + transitionIndex]];
+		}
+
+
+		inline std::shared_ptr<Episode> EpisodeView::ToEpisode() const
+		{
+			std::shared_ptr<Episode> episode = std::make_shared<Episode>();
+			episode->InitialState = GetInitialState();
+			const size_t transitionCount = GetTransitionCount();
+			episode->TransitionSequence.reserve(transitionCount);
+			for (size_t t = 0; t < transitionCount; t++)
+			{
+				episode->TransitionSequence.push_back(GetTransition(t));
+			}
+			episode->LastState = GetLastState();
+			episode->Performance = GetPerformance();
+			episode->Result = GetResult();
+			episode->RepetitionsCount = GetRepetitionsCount();
+			return episode;
+		}
+	}
+}
+
@@ -14,10 +14,15 @@
 #include "discenfw/xp/DigitalAssistant.h"
 #include "discenfw/xp/CyberSystemAssistant.h"
 #include "discenfw/rl/IAgent.h"
+#include "discenfw/RL/GreedyPolicyTable.h"
 #include "discenfw/xp/SharedArena.h"
 #include "discenfw/xp/AgentStats.h"
 
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <mutex>
+#include <thread>
 
 
 namespace discenfw
@@ -101,6 +106,82 @@ namespace discenfw
 			bool IsLearningEnabled() { return LearningEnabled; }
 
 
+			/*!
+			Enable or disable asynchronous learning (disabled by default).
+
+			If enabled, transitions are queued and learned in a background thread,
+			while actions are chosen with a policy that can lag behind
+			by at most the given number of learning steps (see SetMaxLearningLag()).
+			Disabling it waits for the queued learning steps.
+			@note The queue is guarded by a mutex instead of being lock-free: both threads must block anyway
+			(the acting thread when the lag limit is reached, the learning thread when the queue is empty),
+			the lock is held only to move a step, and the learner (IAgent) is locked during learning.
+			*/
+			void SetAsyncLearningEnabled(bool enabled);
+
+			/*!
+			Check if asynchronous learning is enabled (disabled by default).
+			*/
+			bool IsAsyncLearningEnabled() const { return AsyncLearningEnabled; }
+
+			/*!
+			Set the maximum number of learning steps queued for asynchronous learning (default is 8),
+			acting waits if this number is reached.
+			*/
+			void SetMaxLearningLag(int maxLearningLag);
+
+			/*!
+			Get the maximum number of learning steps queued for asynchronous learning.
+			*/
+			int GetMaxLearningLag() const { return MaxLearningLag; }
+
+			/*!
+			Wait until all the queued learning steps are completed.
+			*/
+			void FlushLearning();
+
+			/*!
+			Add the states referenced by experiences, agents, visit statistics and policy table to the given set
+			(see EnvironmentModel::CollectUnusedStates()).
+			@note Learning must be flushed before (see FlushLearning()).
+			*/
+			virtual void MarkReachableStates(StateMarkSet& reachableStates) const override;
+
+
+			/*!
+			Set a frozen greedy policy used to choose actions while learning is disabled
+			(set a null pointer to let the learner choose).
+			States not found in the table are still handled by the learner.
+			*/
+			void SetPolicyTable(std::shared_ptr<GreedyPolicyTable> policyTable) { PolicyTable = policyTable; }
+
+			/*!
+			Get the frozen greedy policy, null if not defined.
+			*/
+			std::shared_ptr<GreedyPolicyTable> GetPolicyTable() const { return PolicyTable; }
+
+
+			/*!
+			Wait for the queued learning steps, then save the experience (see DigitalAssistant::SaveExperience()).
+			*/
+			virtual bool SaveExperience(const std::string& fileName, const std::string& goalName = "", bool saveAll = true) override;
+
+			/*!
+			Wait for the queued learning steps, then save a checkpoint in background (see DigitalAssistant::SaveCheckpoint()).
+			*/
+			virtual bool SaveCheckpoint(const std::string& fileName, const std::string& goalName = "", bool saveAll = true) override;
+
+			/*!
+			Wait for the queued learning steps, then load the experience (see DigitalAssistant::LoadExperience()).
+			*/
+			virtual bool LoadExperience(const std::string& fileName, bool loadAll = true) override;
+
+			/*!
+			Wait for the queued learning steps, then merge the experiences (see DigitalAssistant::MergeExperiences()).
+			*/
+			virtual bool MergeExperiences(const std::vector<std::string>& fileNames, unsigned threadCount = 0) override;
+
+
 			/*!
 			Get the reinforcement learning configuration parameters (see RLConfig).
 			*/
@@ -137,6 +218,13 @@ namespace discenfw
 			*/
 			bool IsNewEpisode() { return NewEpisodeStarted; }
 
+			/*!
+			Start a new episode if the current one is complete
+			(this is done automatically by Train() and TakeAction()).
+			@return true if a new episode was started.
+			*/
+			bool StartNextEpisode();
+
 
 			/*!
 			Replace the default RL learner creation with a callback function uesd to create custom learners.
@@ -200,12 +288,81 @@ namespace discenfw
 			*/
 			std::map< StateRef, std::vector<ActionRef> > DeadlockActions;
 
+			/*!
+			Frozen greedy policy used while learning is disabled.
+			*/
+			std::shared_ptr<GreedyPolicyTable> PolicyTable;
+
 			/*!
 			Statistics computed while learning.
 			*/
 			AgentStats Statistics;
 
 
+			/*!
+			Learning step queued for asynchronous learning.
+
+			Only the transitions added since the previous step are queued while an episode grows,
+			the learning thread appends them to its own copy of the sequence (LearnerSequence).
+			*/
+			struct LearningStep
+			{
+				std::shared_ptr<IAgent> Agent;
+				std::shared_ptr<Experience> AgentExperience;
+				//! New transitions, or the whole sequence if AppendTransitions is false.
+				std::vector<Transition> Transitions;
+				//! Append the transitions to the sequence of the previous step instead of replacing it.
+				bool AppendTransitions = false;
+				ActionResult Result = ActionResult::IN_PROGRESS;
+			};
+
+			bool AsyncLearningEnabled = false;
+			int MaxLearningLag = 8;
+
+			//! Lock for the learners (IAgent), used by the acting and the learning thread.
+			std::mutex AgentMutex;
+
+			//! Queued learning steps, guarded by LearningMutex (see SetAsyncLearningEnabled()).
+			std::deque<LearningStep> LearningQueue;
+			std::mutex LearningMutex;
+			std::condition_variable LearningCondition;
+			std::thread LearnerThread;
+			bool LearnerStopping = false;
+
+			//! Number of queued and running learning steps.
+			int PendingLearningSteps = 0;
+
+			//! Transition sequence last queued by the acting thread, used to queue only new transitions.
+			const std::vector<Transition>* QueuedSequence = nullptr;
+			size_t QueuedSequenceLength = 0;
+			Transition QueuedLastTransition;
+			std::shared_ptr<IAgent> QueuedAgent;
+			std::shared_ptr<Experience> QueuedExperience;
+
+			//! Transition sequence rebuilt by the learning thread from the queued steps.
+			std::vector<Transition> LearnerSequence;
+
+
+			/*!
+			Let the current learner learn from the given transitions (asynchronously if enabled).
+			*/
+			void Learn(
+				const std::shared_ptr<Experience> experience,
+				const std::vector<Transition>& transitionSequence,
+				ActionResult result
+				);
+
+			/*!
+			Learning thread loop.
+			*/
+			void RunLearner();
+
+			/*!
+			Wait for the queued learning steps and stop the learning thread.
+			*/
+			void StopLearner();
+
+
 			/*!
 			Create a agent and return the agent shared pointer.
 			*/
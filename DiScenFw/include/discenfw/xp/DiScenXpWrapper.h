@@ -123,8 +123,10 @@ namespace discenfw
 			// Persistent cache for exported data
 
 			std::vector<ActionRef> AvailableActionsCache;
-			std::vector<Action> ForbiddenActionsCache;
-			std::vector<Action> SuggestedActionsCache;
+			// Forbidden and suggested actions exported from the agent data (see UpdateActionsCache())
+			const std::vector<Action>* ForbiddenActionsSource = nullptr;
+			const std::vector<Action>* SuggestedActionsSource = nullptr;
+			unsigned ActionHintsVersion = 0;
 			std::vector<ActionData> AvailableActionsData;
 			std::vector<ActionData> ForbiddenActionsData;
 			std::vector<ActionData> SuggestedActionsData;
@@ -141,6 +143,7 @@ namespace discenfw
 
 			const std::string& GetAgentName();
 			void ExportAction(const Action& action, ActionData& actionData);
+			void ExportActions(const std::vector<Action>& actions, std::vector<ActionData>& actionsData);
 		};
 	}
 
@@ -12,6 +12,7 @@
 #include <DiScenFwConfig.h>
 #include "discenfw/xp/ref.h"
 #include "discenfw/xp/Experience.h"
+#include "discenfw/xp/ExperienceJournal.h"
 #include "discenfw/xp/Condition.h"
 #include "discenfw/xp/RoleInfo.h"
 #include "discenfw/xp/ICyberSystem.h"
@@ -19,6 +20,8 @@
 #include <map>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <thread>
 
 
 namespace discenfw
@@ -239,6 +242,36 @@ namespace discenfw
 			const std::vector<Action>& GetForbiddenActions() const;
 
 
+			/*!
+			Get a counter incremented each time the lists returned by GetSuggestedActions()
+			and GetForbiddenActions() change (e.g. to avoid copying them again if unchanged).
+			@note The lists are updated when they are requested, call this after getting them.
+			*/
+			unsigned GetActionHintsVersion() const { return ActionHintsVersion; }
+
+
+			/*!
+			Enable or disable the inverted index of the states in the episodes of the current experience
+			(see Experience::SetStateIndexEnabled()), needed by GetEpisodesThroughState().
+			*/
+			void SetStateIndexEnabled(bool enabled);
+
+
+			/*!
+			Get the indices of the episodes of the current experience passing through the given state.
+			@return false if the state index is not enabled (see SetStateIndexEnabled()).
+			*/
+			bool GetEpisodesThroughState(const StateRef& state, std::vector<size_t>& episodeIndices) const;
+
+
+			/*!
+			Get the indices of the episodes of the current experience passing through the given state
+			and ended with the given result (e.g. failed from that state).
+			@return false if the state index is not enabled (see SetStateIndexEnabled()).
+			*/
+			bool GetEpisodesThroughState(const StateRef& state, ActionResult result, std::vector<size_t>& episodeIndices) const;
+
+
 			/*!
 			Get the last stored scenario state for the current episode.
 			*/
@@ -312,6 +345,10 @@ namespace discenfw
 			*/
 			const std::shared_ptr<Experience> GetCurrentExperience() const
 			{
+				if (!PendingExperienceFiles.empty())
+				{
+					LoadPendingExperience(CurrentGoal);
+				}
 				return WealthOfExperiences.at(CurrentGoal);
 			}
 
@@ -337,7 +374,7 @@ namespace discenfw
 			/*!
 			Serialize and save the experience to a JSON text file.
 			*/
-			bool SaveExperience(const std::string& fileName, const std::string& goalName = "", bool saveAll = true);
+			virtual bool SaveExperience(const std::string& fileName, const std::string& goalName = "", bool saveAll = true);
 
 
 			/*!
@@ -346,10 +383,97 @@ namespace discenfw
 			bool SerializeExperience(std::string& jsonText, const std::string& goalName = "");
 
 
+			/*!
+			Enable or disable the experience journal (disabled by default).
+			When enabled SaveExperience() (with saveAll) appends the data added since the last save to a journal
+			next to the experience file (see ExperienceJournal), thus its cost is proportional to the new data.
+			The whole experience is saved again (compacting the journal) when the journal grows larger
+			than the given ratio of the experience file or when stored data was removed or replaced.
+			LoadExperience() (with loadAll) replays the journal found next to the experience file.
+			*/
+			void SetExperienceJournalEnabled(bool enabled, float compactionRatio = 1.0f);
+
+
+			/*!
+			Check if the experience journal is enabled (see SetExperienceJournalEnabled()).
+			*/
+			bool IsExperienceJournalEnabled() const
+			{
+				return ExperienceJournalEnabled;
+			}
+
+
+			/*!
+			Save a checkpoint of the experience (like SaveExperience()) without blocking the caller.
+			A snapshot of the experience and of the model states is taken (stored states are never modified),
+			then it is serialized and saved in a background thread: each file is written to a temporary file
+			and renamed, thus a crash never leaves a partially written file.
+			@return false if the snapshot cannot be taken or the previous checkpoint is still in progress (it is skipped).
+			@see WaitForCheckpoint()
+			*/
+			virtual bool SaveCheckpoint(const std::string& fileName, const std::string& goalName = "", bool saveAll = true);
+
+
+			/*!
+			Check if a checkpoint is being saved in background (see SaveCheckpoint()).
+			*/
+			bool IsCheckpointInProgress() const
+			{
+				return CheckpointRunning;
+			}
+
+
+			/*!
+			Wait for the checkpoint being saved (if any) to be completed.
+			@return false if the last checkpoint failed.
+			*/
+			bool WaitForCheckpoint();
+
+
 			/*!
 			Load and deserialize the experience from a JSON text file (previous experience is lost).
 			*/
-			bool LoadExperience(const std::string& fileName, bool loadAll = true);
+			virtual bool LoadExperience(const std::string& fileName, bool loadAll = true);
+
+
+			/*!
+			Enable or disable lazy loading (disabled by default).
+			When enabled LoadExperience() (with loadAll) reads only the attributes at the beginning of the experience file
+			(goal, model, role, level) and the model definition, while the experience data, the model knowledge
+			and the experience journal are loaded on first access to the experience of that goal.
+			Useful when experiences for many goals are loaded but only some of them are used (e.g. for guidance).
+			*/
+			void SetLazyLoadingEnabled(bool enabled)
+			{
+				LazyLoadingEnabled = enabled;
+			}
+
+
+			/*!
+			Check if lazy loading is enabled (see SetLazyLoadingEnabled()).
+			*/
+			bool IsLazyLoadingEnabled() const
+			{
+				return LazyLoadingEnabled;
+			}
+
+
+			/*!
+			Check if the data of the experience for the given goal (or the current goal if empty)
+			was loaded (see SetLazyLoadingEnabled()), false if loading failed.
+			*/
+			bool IsExperienceLoaded(const std::string& goalName = "") const;
+
+
+			/*!
+			Load experiences of the current goal from JSON text files (e.g. saved by different training processes)
+			and merge them into the current experience (see Experience::MergeExperiences()).
+			Files are read in parallel, the states of each model knowledge file are stored in the current model.
+			@param fileNames experience files, the related model knowledge files must be in the same path
+			@param threadCount number of threads used to read the files (0 = hardware concurrency)
+			@return false if any of the files was not merged.
+			*/
+			virtual bool MergeExperiences(const std::vector<std::string>& fileNames, unsigned threadCount = 0);
 
 
 			/*!
@@ -376,6 +500,13 @@ namespace discenfw
 			bool OptimizeForAssistance();
 
 
+			/*!
+			Add the states referenced by the stored experiences and by the current episode to the given set
+			(see EnvironmentModel::CollectUnusedStates()).
+			*/
+			virtual void MarkReachableStates(StateMarkSet& reachableStates) const;
+
+
 			/*!
 			Print a summary of suggested and forbidden actions to standard output (for testing).
 			*/
@@ -477,15 +608,95 @@ namespace discenfw
 			void LogMsg(
 				int severity,
 				const std::string& message,
-				const std::string& msgRef = "");
+				const std::string& msgRef = "") const;
 
 
 		private:
+
+			/*!
+			List of actions memoized for the current state, updated scanning only the items
+			(best episodes, failed transitions or episode transitions) added since the last update.
+			*/
+			struct ActionListCache
+			{
+				//! Experience (or episode) the list was computed from.
+				std::weak_ptr<const void> Source;
+
+				//! State the list was computed for.
+				StateRef State;
+
+				//! Number of items already scanned.
+				size_t ScannedCount = 0;
+
+				//! Last scanned episode, used to detect replaced best episodes.
+				std::weak_ptr<const Episode> LastScannedEpisode;
+
+				//! Last scanned transition, used to detect replaced failed transitions.
+				Transition LastScannedTransition;
+
+				std::vector<Action> Actions;
+			};
+
 			mutable std::vector<std::string> CachedGoalNames;
-			mutable std::vector<xp::Action> CachedSuggestedActions;
-			mutable std::vector<xp::Action> CachedForbiddenActions;
-			mutable std::vector<xp::Action> CachedActionsSequence;
-			mutable bool ActionsSequenceChanged = false;
+			mutable ActionListCache SuggestedActionsCache;
+			mutable ActionListCache ForbiddenActionsCache;
+			mutable ActionListCache ActionsSequenceCache;
+			mutable unsigned ActionHintsVersion = 0;
+
+			bool LazyLoadingEnabled = false;
+
+			//! Experience files of the goals whose experience data was not yet loaded (see SetLazyLoadingEnabled()).
+			mutable std::map<std::string, std::string> PendingExperienceFiles;
+
+			//! Experience files of the goals whose experience data failed to load, these experiences are not saved.
+			mutable std::map<std::string, std::string> FailedExperienceFiles;
+
+			/*!
+			Load the data of the experience for the given goal, if pending (see SetLazyLoadingEnabled()).
+			@return false if the data failed to load (now or before), the experience must not be saved
+				(it would replace the file with incomplete data).
+			*/
+			bool LoadPendingExperience(const std::string& goal) const;
+
+			bool ExperienceJournalEnabled = false;
+
+			//! Maximum size of the experience journal, relative to the size of the experience file.
+			float JournalCompactionRatio = 1.0f;
+
+			//! Experience journals mapped by goal (see SetExperienceJournalEnabled()).
+			std::map< std::string, std::shared_ptr<ExperienceJournal> > ExperienceJournals;
+
+			/*!
+			Append the data added to the experience for the given goal to its journal, if enabled and not to be compacted.
+			@return false if the whole experience must be saved.
+			*/
+			bool AppendExperienceJournal(const std::string& goal, const std::string& journalFilePath);
+
+			//! Thread saving the last checkpoint (see SaveCheckpoint()).
+			std::thread CheckpointThread;
+
+			std::atomic<bool> CheckpointRunning{ false };
+
+			//! Error message of the last checkpoint, set by CheckpointThread.
+			std::string CheckpointError;
+
+			/*!
+			Get the paths of the model files saved together with the given experience file.
+			*/
+			void GetModelFilePaths(
+				const std::string& xpFileName,
+				std::string& modelFilePath,
+				std::string& knowlFilePath
+				) const;
+
+			void UpdateSuggestedActionsCache() const;
+			void UpdateForbiddenActionsCache() const;
+			void UpdateActionsSequenceCache() const;
+
+			/*!
+			Clear the given cache of suggested or forbidden actions.
+			*/
+			void ResetActionHintsCache(ActionListCache& cache) const;
 		};
 	}
 }
@@ -19,6 +19,8 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 
 namespace discenfw
@@ -154,9 +156,15 @@ namespace discenfw
 
 
 			/*!
-			Get the stored environment states.
+			Get a copy of the list of the stored environment states (read-only, the states are shared).
 			*/
-			const std::vector< std::shared_ptr<const EnvironmentState> >& GetAllStates();
+			std::vector< std::shared_ptr<const EnvironmentState> > GetAllStates() const;
+
+
+			/*!
+			Copy the list of the stored environment states (a consistent snapshot, the states are shared).
+			*/
+			void CopyStoredStates(std::vector< std::shared_ptr<EnvironmentState> >& states) const;
 
 
 			/*!
@@ -165,6 +173,19 @@ namespace discenfw
 			void ClearStoredStates();
 
 
+			/*!
+			Remove the stored states that are not marked as reachable (mark-and-sweep garbage collection).
+			The current state is always kept, the remaining states are compacted preserving their order,
+			thus their indices change (data referring to states by index must be saved again,
+			policy tables find their states by content, see GreedyPolicyTable).
+			The cached information of the removed states is released in each role.
+			@param reachableStates states reachable from experiences, agents and assistants (roots),
+				removed states are no more found in the model even if still referenced elsewhere.
+			@return The number of removed states.
+			*/
+			int CollectUnusedStates(const StateMarkSet& reachableStates);
+
+
 			/*!
 			Create a new entity state type, inheriting from the given entity state type,
 			with the given name, the given default property values, the given possible property values
@@ -281,6 +302,11 @@ namespace discenfw
 
 			static std::string LastModelName;
 
+			/*!
+			Lock for EnvironmentModelMap and LastModelName.
+			*/
+			static std::mutex ModelMapMutex;
+
 			/*!
 			Name of the environment model.
 			*/
@@ -315,9 +341,20 @@ namespace discenfw
 
 			/*!
 			Stored environment states.
+			@note Stored states must not be modified (they are indexed by their hash).
 			*/
 			std::vector< std::shared_ptr<EnvironmentState> > EnvironmentStates;
 
+			/*!
+			Positions in EnvironmentStates of the stored states, mapped from their address.
+			*/
+			std::unordered_map< const EnvironmentState*, int > StatePositions;
+
+			/*!
+			Positions in EnvironmentStates of the stored states, mapped from their hash (see EnvironmentState::GetHash()).
+			*/
+			std::unordered_multimap< size_t, int > StateHashIndex;
+
 
 			/*!
 			Current environment state.
@@ -329,6 +366,28 @@ namespace discenfw
 			*/
 			mutable std::map< std::string, std::shared_ptr<Action> > EncodedActions;
 
+			/*!
+			Lock for EnvironmentStates (and their indices) and EncodedActions,
+			used by agents learning in parallel threads.
+			*/
+			mutable std::recursive_mutex StoreMutex;
+
+
+			/*!
+			Find a stored state equal to the given one, given its hash (StoreMutex must be locked).
+			*/
+			std::shared_ptr<EnvironmentState> FindStoredState(const EnvironmentState& environmentState, size_t hash) const;
+
+			/*!
+			Add a new state to the stored states and to their indices (StoreMutex must be locked).
+			*/
+			void AddStoredState(const std::shared_ptr<EnvironmentState>& environmentState, size_t hash);
+
+			/*!
+			Rebuild the indices of the stored states (StoreMutex must be locked).
+			*/
+			void IndexStoredStates();
+
 
 			/*!
 			Construct an environment model with the given name.
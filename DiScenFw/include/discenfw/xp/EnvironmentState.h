@@ -144,6 +144,11 @@ namespace discenfw
 			*/
 			std::shared_ptr<EnvironmentState> Clone() const;
 
+			/*!
+			Compute a hash of the entity states and features (equal states have the same hash).
+			*/
+			size_t GetHash() const;
+
 			EnvironmentState& operator = (const EnvironmentState& state);
 
 			bool operator == (const EnvironmentState& state) const;
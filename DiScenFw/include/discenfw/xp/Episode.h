@@ -13,6 +13,7 @@
 #include "discenfw/xp/Action.h"
 #include "discenfw/xp/Transition.h"
 
+#include <functional>
 #include <vector>
 
 
@@ -31,6 +32,8 @@ namespace discenfw
 			int Performance = 0; //!< Episode performance measure, used to choose the best episode.
 			ActionResult Result = ActionResult::IN_PROGRESS; //!< Episode result.
 			int RepetitionsCount = 0; //!< Number of times this episode was repeated.
+			size_t SequenceFingerprint = 0; //!< Rolling hash of the initial state and of the transitions hashed so far.
+			size_t FingerprintLength = 0; //!< Number of transitions included in SequenceFingerprint.
 
 
 			/*!
@@ -57,6 +60,44 @@ namespace discenfw
 			Check if the episode was started but not completed.
 			*/
 			bool Empty() { return TransitionSequence.empty(); }
+
+			/*!
+			Get a hash of the initial state, the transition sequence, the last state and the result.
+			Only the transitions added since the last call are hashed (transitions must be only appended).
+			Equal episodes have the same fingerprint, different episodes can share the same fingerprint.
+			*/
+			size_t GetFingerprint()
+			{
+				if (FingerprintLength == 0 || FingerprintLength > TransitionSequence.size())
+				{
+					SequenceFingerprint = std::hash<EnvironmentState*>()(InitialState.get());
+					FingerprintLength = 0;
+				}
+				for (; FingerprintLength < TransitionSequence.size(); FingerprintLength++)
+				{
+					const Transition& transition = TransitionSequence[FingerprintLength];
+					SequenceFingerprint = CombineHash(SequenceFingerprint, std::hash<EnvironmentState*>()(transition.StartState.get()));
+					SequenceFingerprint = CombineHash(SequenceFingerprint, std::hash<EnvironmentState*>()(transition.EndState.get()));
+					if (transition.ActionTaken)
+					{
+						// actions are compared by value (see Action::operator==())
+						SequenceFingerprint = CombineHash(SequenceFingerprint, std::hash<std::string>()(transition.ActionTaken->TypeId));
+						for (const std::string& param : transition.ActionTaken->Params)
+						{
+							SequenceFingerprint = CombineHash(SequenceFingerprint, std::hash<std::string>()(param));
+						}
+					}
+				}
+				size_t fingerprint = CombineHash(SequenceFingerprint, std::hash<EnvironmentState*>()(LastState.get()));
+				return CombineHash(fingerprint, (size_t)Result);
+			}
+
+		private:
+
+			static size_t CombineHash(size_t seed, size_t value)
+			{
+				return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+			}
 		};
 
 	}
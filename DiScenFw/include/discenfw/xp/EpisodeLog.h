@@ -0,0 +1,180 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+
+#include "discenfw/xp/CompactEpisodeStore.h"
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace discenfw
+{
+	namespace xp
+	{
+		/*!
+		Append-only log of episodes stored in a binary file, used to move old episodes out of memory.
+		Each record holds the episode data followed by its transitions as 32-bit state and action ids.
+		States and actions are referenced by internal tables (they are stored anyway in the environment model),
+		thus the log can be read only while it is open and the file is overwritten when opened again.
+		The file can be shared with read-only snapshots (see OpenSnapshot()), it is deleted when released by all of them,
+		meanwhile the log continues on a new file (with a numeric suffix) if it is cleared or opened again.
+		*/
+		class DISCENFW_API EpisodeLog
+		{
+		public:
+
+			EpisodeLog();
+
+			~EpisodeLog();
+
+			/*!
+			Create (or overwrite) the log file at the given path.
+			@return false if the file cannot be created.
+			*/
+			bool Open(const std::string& filePath);
+
+			/*!
+			Open a read-only view of the episodes currently in the given log, sharing its file
+			(records are only appended, thus they are not copied, the in-memory tables are copied).
+			@return false if the given log is not open or its file cannot be read.
+			*/
+			bool OpenSnapshot(const EpisodeLog& sourceLog);
+
+			/*!
+			Close and delete the log file, clear the log.
+			*/
+			void Close();
+
+			/*!
+			Check if the log file is open.
+			*/
+			bool IsOpen() const { return File.is_open(); }
+
+			/*!
+			Get the path of the log file (as given to Open()).
+			*/
+			const std::string& GetFilePath() const { return FilePath; }
+
+			/*!
+			Append an episode to the log file.
+			@param episode view of the episode to append
+			@param fingerprint fingerprint of the episode (see Episode::GetFingerprint())
+			@return false if the log is not open or writing failed.
+			*/
+			bool AppendEpisode(const EpisodeView& episode, size_t fingerprint);
+
+			/*!
+			Get the number of episodes in the log.
+			*/
+			size_t GetEpisodeCount() const { return RecordOffsets.size(); }
+
+			/*!
+			Get the fingerprint of the episode at the given position (see Episode::GetFingerprint()).
+			*/
+			size_t GetFingerprint(size_t index) const { return Fingerprints[index]; }
+
+			/*!
+			Read the episode at the given position from the log file.
+			@return A new episode object or null if reading failed.
+			*/
+			std::shared_ptr<Episode> ReadEpisode(size_t index) const;
+
+			/*!
+			Increment the repetitions count of the episode at the given position
+			(counts are kept in memory, the file holds the count of each episode when it was appended).
+			*/
+			bool IncrementRepetitionsCount(size_t index);
+
+			/*!
+			Read sequentially all the episodes in the log, calling the given function for each one.
+			@return false if reading failed.
+			*/
+			bool ForEachEpisode(const std::function<void(const EpisodeView&)>& episodeFunction) const;
+
+			/*!
+			Remove the episodes following the given number of episodes (the log file is truncated).
+			*/
+			void Truncate(size_t episodeCount);
+
+			/*!
+			Remove all the episodes (the log file is truncated).
+			*/
+			void Clear();
+
+			/*!
+			Add the states referenced by the logged episodes to the given set (the log file is not read).
+			*/
+			void MarkReachableStates(StateMarkSet& reachableStates) const;
+
+		protected:
+
+			struct LogFile;
+
+			std::string FilePath;
+
+			//! File shared with the snapshots, deleted when released by all of them.
+			std::shared_ptr<LogFile> SharedFile;
+
+			mutable std::fstream File;
+
+			//! Size of the data written to the file.
+			uint64_t FileSize = 0;
+
+			//! Size of the data read by the snapshots, not overwritten (see Truncate()).
+			mutable uint64_t SharedFileSize = 0;
+
+			//! The log is a snapshot of another log (see OpenSnapshot()).
+			bool ReadOnly = false;
+
+			//! Position of each episode record in the file.
+			std::vector<uint64_t> RecordOffsets;
+
+			//! Fingerprint of each episode (see Episode::GetFingerprint()).
+			std::vector<size_t> Fingerprints;
+
+			//! Repetitions count of each episode (see IncrementRepetitionsCount()).
+			std::vector<int> RepetitionsCounts;
+
+			//! Referenced states, the first element (null) is used for undefined states.
+			std::vector<StateRef> States;
+
+			//! Referenced actions, the first element (null) is used for undefined actions.
+			std::vector<ActionRef> Actions;
+
+			std::unordered_map<const EnvironmentState*, uint32_t> StateIds;
+			std::unordered_map<const Action*, uint32_t> ActionIds;
+
+			//! Buffer for encoding and decoding records.
+			mutable std::vector<uint32_t> RecordBuffer;
+
+			uint32_t GetStateId(const StateRef& state);
+			uint32_t GetActionId(const ActionRef& action);
+
+			/*!
+			Clear the episodes and the internal tables, the file is not changed.
+			*/
+			void ClearIndex();
+
+			/*!
+			Read the record of the episode at the given position and decode it into the given episode.
+			*/
+			bool ReadRecord(size_t index, Episode& episode) const;
+		};
+	}
+}
+
@@ -12,6 +12,8 @@
 #include <DiScenFwConfig.h>
 
 #include "discenfw/xp/Episode.h"
+#include "discenfw/xp/CompactEpisodeStore.h"
+#include "discenfw/xp/EpisodeLog.h"
 #include "discenfw/xp/Condition.h"
 #include "discenfw/xp/EnvironmentState.h"
 #include "discenfw/xp/EnvironmentStateInfo.h"
@@ -20,11 +22,31 @@
 #include "discenfw/xp/RoleInfo.h"
 #include "discenfw/xp/EnvironmentModel.h"
 
+#include <functional>
+#include <set>
+#include <unordered_map>
+
 namespace discenfw
 {
 	namespace xp
 	{
 
+		/*!
+		Position of a state in a stored episode (see Experience::GetStatePositions()).
+		*/
+		struct EpisodeStatePosition
+		{
+			//! Index of the episode (see Experience::GetEpisode()).
+			size_t EpisodeIndex = 0;
+
+			/*!
+			Position in the sequence of states of the episode: the index of the transition starting from the state,
+			or the number of transitions for the last state.
+			*/
+			size_t Position = 0;
+		};
+
+
 		/*!
 		Data structure for storing experience.
 		*/
@@ -67,9 +89,38 @@ namespace discenfw
 			*/
 			float DiscountingConstant = -1.0f;
 
-			//! History of completed episodes.
+			/*!
+			History of completed episodes (following the ones in SpilledEpisodes and CompactEpisodes).
+			@note Use GetEpisodeCount() and ForEachEpisode() to access the whole history.
+			*/
 			std::vector< std::shared_ptr<Episode> > Episodes;
 
+			/*!
+			History of completed episodes stored in compact form, if CompactStorage is enabled.
+			*/
+			CompactEpisodeStore CompactEpisodes;
+
+			/*!
+			Store completed episodes in CompactEpisodes instead of Episodes (disabled by default).
+			*/
+			bool CompactStorage = false;
+
+			/*!
+			Oldest episodes moved from memory to a log file (see SetEpisodeSpill()).
+			*/
+			EpisodeLog SpilledEpisodes;
+
+			/*!
+			Maximum number of episodes kept in memory (in Episodes or CompactEpisodes), 0 means no limit.
+			*/
+			size_t MaxResidentEpisodes = 0;
+
+			/*!
+			Repetitions counts of the episodes in Episodes, if this is a snapshot (see CreateSnapshot()),
+			since the episodes are shared with the original experience.
+			*/
+			std::vector<int> SnapshotRepetitionsCounts;
+
 			//! Successful episodes with the best performance.
 			std::vector< std::shared_ptr<Episode> > BestEpisodes;
 
@@ -84,6 +135,45 @@ namespace discenfw
 			*/
 			std::map<StateActionRef, float> StateActionValues;
 
+			/*!
+			Indices of the episodes (see GetEpisode()) grouped by fingerprint (see Episode::GetFingerprint()),
+			used to find duplicate episodes.
+			*/
+			std::unordered_map< size_t, std::vector<size_t> > EpisodeFingerprints;
+
+			//! Number of episodes already indexed in EpisodeFingerprints.
+			size_t IndexedEpisodeCount = 0;
+
+			//! Last episode indexed in EpisodeFingerprints, used to detect changes to Episodes.
+			Episode* LastIndexedEpisode = nullptr;
+
+			/*!
+			Build the inverted index of the states in the stored episodes (disabled by default).
+			*/
+			bool StateIndexEnabled = false;
+
+			/*!
+			Positions of each state in the indexed episodes, sorted by episode index (see SetStateIndexEnabled()).
+			*/
+			std::unordered_map< const EnvironmentState*, std::vector<EpisodeStatePosition> > StatePositions;
+
+			//! Result of each indexed episode, if StateIndexEnabled is true.
+			std::vector<ActionResult> IndexedEpisodeResults;
+
+			/*!
+			Record the state-actions changed by SetStateActionValue() in ChangedStateActions (disabled by default).
+			*/
+			bool StateActionChangesTracked = false;
+
+			//! State-actions changed since the last call to TakeChangedStateActions().
+			std::set<StateActionRef> ChangedStateActions;
+
+			/*!
+			Number of times stored data was removed or replaced (not only added),
+			used to detect that the data added since a given moment cannot be saved incrementally (see ExperienceJournal).
+			*/
+			unsigned RewriteCount = 0;
+
 		public:
 
 			/*!
@@ -158,7 +248,9 @@ namespace discenfw
 
 
 			/*!
-			Check if an episode equal to the current one was already stored in experience.
+			Check if an episode equal to the current one was already stored in experience,
+			if found its repetitions count is incremented.
+			Only the episodes with the same fingerprint are compared (see Episode::GetFingerprint()).
 			*/
 			bool CheckDuplicateEpisode(std::shared_ptr<Episode> episode);
 
@@ -170,6 +262,134 @@ namespace discenfw
 			*/
 			bool StoreEpisode(std::shared_ptr<Episode> episode, bool checkDuplicate = true);
 
+			/*!
+			Get the number of stored episodes.
+			*/
+			size_t GetEpisodeCount() const
+			{
+				return SpilledEpisodes.GetEpisodeCount() + CompactEpisodes.GetEpisodeCount() + Episodes.size();
+			}
+
+			/*!
+			Get the number of stored episodes moved to the log file (see SetEpisodeSpill()).
+			*/
+			size_t GetSpilledEpisodeCount() const
+			{
+				return SpilledEpisodes.GetEpisodeCount();
+			}
+
+			/*!
+			Get a view of the stored episode at the given position
+			(spilled episodes are followed by the ones in compact form and then by the ones in Episodes).
+			@note The episode must be in memory (index not less than GetSpilledEpisodeCount()), see LoadEpisode(),
+			otherwise a view of an empty episode (without transitions and states) is returned.
+			*/
+			EpisodeView GetEpisode(size_t index) const;
+
+			/*!
+			Get a copy of the stored episode at the given position, reading it from the log file if spilled.
+			@return A new episode object or null if not available.
+			*/
+			std::shared_ptr<Episode> LoadEpisode(size_t index) const;
+
+			/*!
+			Call the given function for each stored episode in order, spilled episodes are read from the log file.
+			@return false if the log file cannot be read.
+			*/
+			bool ForEachEpisode(const std::function<void(const EpisodeView&)>& episodeFunction) const;
+
+			/*!
+			Set a limit to the number of episodes kept in memory.
+			When the limit is exceeded all the stored episodes are appended to the given log file,
+			best episodes, failed transitions and state-action values are always kept in memory.
+			@param logFilePath path of the log file (overwritten), if empty spilled episodes are loaded back in memory
+			@param maxResidentEpisodes maximum number of episodes kept in memory (0 = no limit)
+			@return false if the log file cannot be created.
+			*/
+			bool SetEpisodeSpill(const std::string& logFilePath, size_t maxResidentEpisodes);
+
+			/*!
+			Enable or disable the compact storage of the episodes history (see CompactEpisodeStore).
+			The episodes already stored are converted.
+			*/
+			void SetCompactStorage(bool enabled);
+
+			/*!
+			Check if the episodes history is stored in compact form.
+			*/
+			bool IsCompactStorage() const
+			{
+				return CompactStorage;
+			}
+
+			/*!
+			Clear the episodes history (best episodes and failed transitions are kept).
+			*/
+			void ClearEpisodes();
+
+			/*!
+			Enable or disable the inverted index from states to their positions in the stored episodes.
+			The index is built when enabled (spilled episodes are read from the log file),
+			then it is updated as new episodes are stored, thus queries take time proportional to the matches.
+			*/
+			void SetStateIndexEnabled(bool enabled);
+
+			/*!
+			Check if the inverted index of the states is enabled.
+			*/
+			bool IsStateIndexEnabled() const
+			{
+				return StateIndexEnabled;
+			}
+
+			/*!
+			Get the positions of the given state in the stored episodes, sorted by episode index.
+			@return false if the state index is not enabled.
+			*/
+			bool GetStatePositions(const StateRef& state, std::vector<EpisodeStatePosition>& positions);
+
+			/*!
+			Get the indices of the stored episodes passing through the given state (see GetEpisode()).
+			@note Spilled episodes (index less than GetSpilledEpisodeCount()) must be read with LoadEpisode().
+			@return false if the state index is not enabled.
+			*/
+			bool GetEpisodesThroughState(const StateRef& state, std::vector<size_t>& episodeIndices);
+
+			/*!
+			Get the indices of the stored episodes passing through the given state and ended with the given result
+			(e.g. the episodes failed after reaching the state).
+			@return false if the state index is not enabled.
+			*/
+			bool GetEpisodesThroughState(const StateRef& state, ActionResult result, std::vector<size_t>& episodeIndices);
+
+			/*!
+			Merge the given experiences into this one.
+			Episodes are stored skipping duplicates, best episodes are updated
+			with the stored episodes and the best episodes of the given experiences
+			(also if their episodes were cleared, see DigitalAssistant::OptimizeForAssistance()),
+			failed transitions are added if not already present,
+			state-action values are averaged, weighted by the number of times
+			each state-action was taken in the episodes of each experience (at least 1).
+			@note States of the given experiences must be already stored in the model of this experience.
+			*/
+			void MergeExperiences(const std::vector< std::shared_ptr<Experience> >& experiences);
+
+			/*!
+			Add the states referenced by this experience (episodes, best episodes,
+			failed transitions and state-action values) to the given set.
+			@see EnvironmentModel::CollectUnusedStates()
+			*/
+			void MarkReachableStates(StateMarkSet& reachableStates) const;
+
+			/*!
+			Create a read-only copy of this experience that can be serialized while this one is updated (e.g. in another thread).
+			Episodes, states and actions are shared (they are never modified once stored,
+			except the repetitions count of episodes, copied), episodes in compact form are copied.
+			The log file of the spilled episodes is shared, the copy reads only the episodes already logged.
+			@return The copy of the experience or null if the log file of the spilled episodes cannot be read.
+			*/
+			std::shared_ptr<Experience> CreateSnapshot() const;
+
 
 
 			/*!
@@ -202,6 +422,28 @@ namespace discenfw
 			void ClearStateActionValues();
 
 
+			/*!
+			Enable or disable the tracking of the state-actions changed by SetStateActionValue().
+			*/
+			void SetStateActionChangesTracked(bool tracked);
+
+
+			/*!
+			Get the state-actions changed since the last call (if tracking is enabled) and clear the list.
+			*/
+			void TakeChangedStateActions(std::vector<StateActionRef>& stateActions);
+
+
+			/*!
+			Get the number of times stored data was removed or replaced (episodes cleared, experiences merged, values cleared),
+			if not changed the stored data was only added.
+			*/
+			unsigned GetRewriteCount() const
+			{
+				return RewriteCount;
+			}
+
+
 
 
 
@@ -215,12 +457,55 @@ namespace discenfw
 			Clear all episodes and reset experience.
 			*/
 			void Clear();
+
+		protected:
+
+			/*!
+			Add the episodes not yet indexed to EpisodeFingerprints (and to StatePositions if enabled),
+			rebuild the index if Episodes was modified elsewhere (e.g. cleared and reloaded).
+			*/
+			void UpdateEpisodeIndex();
+
+			/*!
+			Add the states of the given episode to StatePositions.
+			*/
+			void IndexEpisodeStates(size_t episodeIndex, const EpisodeView& episode);
+
+			/*!
+			Find the episodes passing through the given state, optionally filtered by result.
+			*/
+			bool FindEpisodesThroughState(
+				const StateRef& state,
+				bool filterResult,
+				ActionResult result,
+				std::vector<size_t>& episodeIndices
+				);
+
+			/*!
+			Move the episodes in Episodes to CompactEpisodes.
+			*/
+			void CompactStoredEpisodes();
+
+			/*!
+			Move the episodes in memory to SpilledEpisodes.
+			*/
+			void SpillStoredEpisodes();
+
+			/*!
+			Update LastIndexedEpisode after moving episodes.
+			*/
+			void UpdateLastIndexedEpisode();
+
+			/*!
+			Update BestEpisode and BestEpisodes with the given successful episode.
+			*/
+			void UpdateBestEpisodes(std::shared_ptr<Episode> episode);
 		};
 
 
 		inline bool Experience::Valid()
 		{
-			return !Episodes.empty();
+			return GetEpisodeCount() > 0;
 		}
 
 
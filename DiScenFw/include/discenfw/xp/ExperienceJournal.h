@@ -0,0 +1,162 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+
+#include "discenfw/xp/Experience.h"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace discenfw
+{
+	namespace xp
+	{
+		/*!
+		Append-only journal of the data added to an experience after it was completely saved,
+		used to save the experience incrementally.
+		Each record holds the new states (in the same format of the model knowledge file)
+		and the new episodes, failed transitions and changed state-action values (in the same format of the experience file).
+		States are referenced by their position in the model knowledge file saved with the experience,
+		followed by the states of the previous records.
+		Changes to the repetitions count of already saved episodes are not recorded.
+		The journal begins with the size and the hash of the experience file it was started for,
+		thus it is never applied to a different file (e.g. if a crash occurred after replacing the file, before removing the journal).
+		@note An incomplete record at the end of the file (e.g. after a crash) is ignored.
+		*/
+		class DISCENFW_API ExperienceJournal
+		{
+		public:
+
+			ExperienceJournal();
+
+			~ExperienceJournal();
+
+			/*!
+			Start a new journal after the experience was completely saved (the journal file is overwritten).
+			@param filePath path of the journal file
+			@param experience experience saved, the changes of its state-action values are tracked from now on
+			@param savedStates states saved in the model knowledge file, in the same order
+			@param snapshotText text of the saved experience file, the journal is bound to it (see GetSnapshotSize())
+			@return false if the file cannot be created.
+			*/
+			bool Start(
+				const std::string& filePath,
+				const std::shared_ptr<Experience>& experience,
+				const std::vector<StateRef>& savedStates,
+				const std::string& snapshotText
+				);
+
+			/*!
+			Stop recording (the journal file is kept).
+			*/
+			void Close();
+
+			/*!
+			Check if the journal was started.
+			*/
+			bool IsStarted() const { return File.is_open(); }
+
+			/*!
+			Get the path of the journal file.
+			*/
+			const std::string& GetFilePath() const { return FilePath; }
+
+			/*!
+			Get the size of the experience file saved when the journal was started.
+			*/
+			uint64_t GetSnapshotSize() const { return SnapshotSize; }
+
+			/*!
+			Get the size of the journal file.
+			*/
+			uint64_t GetFileSize() const { return FileSize; }
+
+			/*!
+			Get the number of records written.
+			*/
+			size_t GetRecordCount() const { return RecordCount; }
+
+			/*!
+			Check if the data changed since the journal was started can be appended:
+			the journal must be started for the same experience
+			and the stored data must not be removed or replaced (see Experience::GetRewriteCount()).
+			*/
+			bool CanAppend(const std::shared_ptr<Experience>& experience) const;
+
+			/*!
+			Append a record with the data added to the experience since the last record (nothing is written if no data was added).
+			@return false if the data cannot be appended (see CanAppend()) or writing failed.
+			*/
+			bool Append(const std::shared_ptr<Experience>& experience);
+
+			/*!
+			Read the journal file and add its data to the experience, new states are stored in the model of the experience.
+			A journal started for a different experience file is ignored (nothing is added).
+			@param filePath path of the journal file
+			@param snapshotText text of the experience file
+			@param experience experience loaded from the experience file saved with the journal
+			@param stateTable states of the model knowledge file saved with the experience, journaled states are appended
+			@return false if the file cannot be read or parsed (the data of the previous records is added anyway).
+			*/
+			static bool Replay(
+				const std::string& filePath,
+				const std::string& snapshotText,
+				const std::shared_ptr<Experience>& experience,
+				std::vector<StateRef>& stateTable
+				);
+
+		protected:
+
+			std::string FilePath;
+
+			std::ofstream File;
+
+			uint64_t FileSize = 0;
+
+			uint64_t SnapshotSize = 0;
+
+			//! Hash of the experience file saved when the journal was started.
+			uint64_t SnapshotHash = 0;
+
+			size_t RecordCount = 0;
+
+			//! Experience being recorded.
+			std::weak_ptr<Experience> JournaledExperience;
+
+			//! Rewrite count of the experience when the journal was started (see Experience::GetRewriteCount()).
+			unsigned RewriteCount = 0;
+
+			//! Number of episodes already saved.
+			size_t EpisodeCount = 0;
+
+			//! Number of failed transitions already saved.
+			size_t FailedTransitionCount = 0;
+
+			//! States already saved, in the order they are referenced in the journal.
+			std::vector<StateRef> States;
+
+			//! Index of each state in States.
+			std::unordered_map<const EnvironmentState*, int> StateIndices;
+
+			/*!
+			Add the given state to States if not already saved.
+			*/
+			void AddState(const StateRef& state, std::vector<StateRef>& newStates);
+		};
+	}
+}
+
@@ -20,6 +20,7 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <mutex>
 
 
 namespace discenfw
@@ -129,6 +130,18 @@ namespace discenfw
 			EnvironmentStateInfo GetStateInfo(std::shared_ptr<EnvironmentState> environmentState) const;
 
 
+			/*!
+			Compute the information about the given state without storing it
+			(e.g. for temporary states not stored in the environment model).
+			@param environmentState state to be evaluated
+			@param systemFailed the cyber system failure condition is satisfied (the result is a failure)
+			*/
+			EnvironmentStateInfo EvaluateStateInfo(
+				std::shared_ptr<EnvironmentState> environmentState,
+				bool systemFailed = false
+				) const;
+
+
 			/*!
 			Override the state information for the given state.
 			*/
@@ -167,10 +180,21 @@ namespace discenfw
 			*/
 			void Clear() const;
 
+
+			/*!
+			Release the computed state information of the states not included in the given set.
+			*/
+			void ReleaseStateInfo(const StateMarkSet& keptStates) const;
+
 		protected:
 
 			mutable std::map< std::shared_ptr<EnvironmentState>, EnvironmentStateInfo > StateInfo;
 
+			/*!
+			Lock for StateInfo, used by agents learning in parallel threads (shared by copies of this role).
+			*/
+			std::shared_ptr<std::recursive_mutex> StateInfoMutex;
+
 			/*!
 			Evaluate a state, aacording to the success, deadlock and failure conditions defined.
 			*/
@@ -0,0 +1,197 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <DiScenFwConfig.h>
+#include "discenfw/xp/ref.h"
+#include "discenfw/xp/ActionResult.h"
+#include "discenfw/xp/ICyberSystem.h"
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace discenfw
+{
+	namespace xp
+	{
+		class CyberSystemAgent;
+		class IAgent;
+
+
+		/*!
+		Batched results of a step of a VectorEnvironment (one element for each environment).
+		*/
+		struct VectorStepResult
+		{
+			//! Current states (initial state of the new episode if the previous one was completed).
+			std::vector<StateRef> States;
+
+			//! Last state of the completed episodes (null if the episode is in progress).
+			std::vector<StateRef> FinalStates;
+
+			//! Rewards for the states reached by the step.
+			std::vector<int> Rewards;
+
+			//! Results of the step.
+			std::vector<ActionResult> Results;
+
+			//! Episode completed flags (not bool to allow concurrent writes).
+			std::vector<char> Done;
+		};
+
+
+		/*!
+		Set of independent cyber system instances stepped together.
+
+		Each environment has its own cyber system and CyberSystemAgent (with its own episode),
+		all the environments share the same environment model.
+		Environments can be stepped in parallel by a pool of worker threads (created with the environments),
+		completed episodes are automatically reset.
+		*/
+		class DISCENFW_API VectorEnvironment
+		{
+		public:
+
+			/*!
+			Function creating a new cyber system instance.
+			*/
+			using CyberSystemMaker = std::function<std::shared_ptr<ICyberSystem>()>;
+
+			/*!
+			Number of threads used to step the environments (0 = hardware concurrency, 1 = no threads),
+			applied when the environments are created (see Create()).
+			*/
+			unsigned ThreadCount = 0;
+
+			/*!
+			Start a new episode when an episode is completed (enabled by default).
+			*/
+			bool AutoReset = true;
+
+			VectorEnvironment();
+
+			~VectorEnvironment();
+
+			/*!
+			Create the given number of environments (previous environments are destroyed)
+			and the worker threads used to step them (see ThreadCount).
+			@param count number of environments
+			@param makeCyberSystem function creating a new cyber system instance
+			@param roleName role of the agents
+			@param goalName goal of the agents (optional)
+			@return false if a cyber system could not be created.
+			*/
+			bool Create(
+				int count,
+				CyberSystemMaker makeCyberSystem,
+				const std::string& roleName,
+				const std::string& goalName = ""
+				);
+
+			/*!
+			Get the number of environments.
+			*/
+			int GetSize() const { return (int)Agents.size(); }
+
+			/*!
+			Get the agent acting on the given environment.
+			*/
+			const std::shared_ptr<CyberSystemAgent>& GetAgent(int envIndex) const { return Agents[envIndex]; }
+
+			/*!
+			Get the actions available in the given environment.
+			*/
+			const std::vector<ActionRef>& GetAvailableActions(int envIndex) const;
+
+			/*!
+			Start a new episode in all the environments.
+			*/
+			void Reset(VectorStepResult& stepResult);
+
+			/*!
+			Take a batch of actions, one for each environment.
+			@param actions actions to be taken (for null actions the agent chooses its own action)
+			@param updateXp update the agents experience
+			@param[out] stepResult batched results
+			*/
+			void Step(
+				const std::vector<ActionRef>& actions,
+				bool updateXp,
+				VectorStepResult& stepResult
+				);
+
+			/*!
+			Execute a training step in all the environments (each agent chooses its own action).
+			@param updateXp update the agents experience
+			@param[out] stepResult batched results
+			*/
+			void Train(bool updateXp, VectorStepResult& stepResult);
+
+			/*!
+			Let the given agent choose an action for each environment with a single batched call
+			(see IAgent::ChooseActions()), the experience of the first environment is passed to the agent.
+			@param agent agent choosing the actions
+			@param stepResult results of the previous step (or reset), the current states are used
+			@param updatePolicy update the agent policy according to the chosen actions
+			@param[out] actions chosen actions, to be passed to Step() (null if no action was chosen)
+			*/
+			void ChooseActions(
+				const std::shared_ptr<IAgent>& agent,
+				const VectorStepResult& stepResult,
+				bool updatePolicy,
+				std::vector<ActionRef>& actions
+				) const;
+
+			/*!
+			Flush the learning of the agents and add the states referenced by them to the given set
+			(these agents are not known to DigitalScenarioFramework, see EnvironmentModel::CollectUnusedStates()).
+			*/
+			void MarkReachableStates(StateMarkSet& reachableStates);
+
+		protected:
+
+			std::vector< std::shared_ptr<CyberSystemAgent> > Agents;
+
+			void StepEnvironment(int envIndex, const ActionRef& action, bool updateXp, VectorStepResult& stepResult);
+
+			void ForEachEnvironment(const std::function<void(int)>& envFunction);
+
+		private:
+
+			//! Worker threads, the calling thread is used as first worker.
+			std::vector<std::thread> Workers;
+			std::mutex WorkersMutex;
+			std::condition_variable WorkCondition;
+			std::condition_variable WorkDoneCondition;
+
+			//! Function executed by the workers for each environment (valid while running).
+			const std::function<void(int)>* WorkFunction = nullptr;
+
+			//! Incremented each time work is assigned to the workers.
+			unsigned WorkGeneration = 0;
+
+			//! Number of workers still running the current work.
+			int PendingWorkers = 0;
+
+			bool WorkersStopping = false;
+
+			void StartWorkers();
+			void StopWorkers();
+			void RunWorker(int workerIndex);
+			void RunWorkRange(int workerIndex, const std::function<void(int)>& envFunction);
+		};
+	}
+}
+
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <memory>
+#include <unordered_set>
 
 
 namespace discenfw
@@ -32,6 +33,13 @@ namespace discenfw
 		*/
 		using ActionRef = std::shared_ptr<Action>;
 
+
+		/*!
+		Set of states identified by address, used to mark the states reachable from the stored knowledge
+		(see EnvironmentModel::CollectUnusedStates()).
+		*/
+		using StateMarkSet = std::unordered_set<const EnvironmentState*>;
+
 		/*!
 		Structure to hold references to a state and an action taken from that state.
 		*/
@@ -1019,6 +1019,16 @@ namespace discenfw
 	}
 
 
+	unsigned DigitalScenarioFramework::GetActionHintsVersion(const std::string& agentName) const
+	{
+		if (CheckAgent(agentName))
+		{
+			return CyberSystemAgents.at(agentName)->GetActionHintsVersion();
+		}
+		return 0;
+	}
+
+
 	const std::vector<ActionRef>& DigitalScenarioFramework::GetAvailableActions(
 		const std::string& roleId,
 		bool smartSelection) const
@@ -1289,6 +1299,28 @@ namespace discenfw
 	}
 
 
+	bool DigitalScenarioFramework::SaveCheckpoint(const std::string& agentName, const std::string& filePath, const std::string& goalName)
+	{
+		if (!CheckAgent(agentName))
+		{
+			return false;
+		}
+
+		return CyberSystemAgents[agentName]->SaveCheckpoint(filePath, goalName, true);
+	}
+
+
+	bool DigitalScenarioFramework::WaitForCheckpoint(const std::string& agentName)
+	{
+		if (!CheckAgent(agentName))
+		{
+			return false;
+		}
+
+		return CyberSystemAgents[agentName]->WaitForCheckpoint();
+	}
+
+
 	bool DigitalScenarioFramework::OptimizeExperienceForAssistance(const std::string& agentName)
 	{
 		ClearCache();
@@ -1296,6 +1328,7 @@ namespace discenfw
 		{
 			return false;
 		}
+		CyberSystemAgents[agentName]->FlushLearning();
 		return CyberSystemAgents[agentName]->OptimizeForAssistance();
 	}
 
@@ -1324,6 +1357,30 @@ namespace discenfw
 	}
 
 
+	int DigitalScenarioFramework::CollectUnusedStates()
+	{
+		if (!CheckCyberSystem())
+		{
+			return 0;
+		}
+		ClearCache();
+		xp::StateMarkSet reachableStates;
+		for (const auto& agentPair : CyberSystemAgents)
+		{
+			agentPair.second->FlushLearning();
+			agentPair.second->MarkReachableStates(reachableStates);
+		}
+		for (const auto& arenaPair : SharedArenas)
+		{
+			if (arenaPair.second)
+			{
+				reachableStates.insert(arenaPair.second->Environment.get());
+			}
+		}
+		return CyberSystem->GetModel()->CollectUnusedStates(reachableStates);
+	}
+
+
 	bool DigitalScenarioFramework::SetLogEnabled(const std::string& agentName, bool enabled)
 	{
 		if (!CheckAgent(agentName))
@@ -42,15 +42,32 @@ namespace discenfw
 		}
 
 
+		std::shared_ptr<EnvironmentState> JsonCommonParser::GetIndexedState(
+			std::shared_ptr<EnvironmentModel> model,
+			int stateIndex
+			) const
+		{
+			if (stateIndex < 0)
+			{
+				return nullptr;
+			}
+			if (StateTable)
+			{
+				return stateIndex < (int)StateTable->size() ? (*StateTable)[stateIndex] : nullptr;
+			}
+			return model->GetStoredState(stateIndex);
+		}
+
+
 		void JsonCommonParser::ParseTransition(std::shared_ptr<EnvironmentModel> model, const rapidjson::Value& transitionValue, xp::Transition& transition)
 		{
 			int prevStateIdx = GetAsInt(transitionValue, "StartState", false, -1);
-			transition.StartState = prevStateIdx >= 0 ? model->GetStoredState(prevStateIdx) : nullptr;
+			transition.StartState = GetIndexedState(model, prevStateIdx);
 			StartContext("ActionTaken");
 			transition.ActionTaken = model->DecodeAction(GetAsString(transitionValue,"ActionTaken"));
 			EndContext();
 			int nextStateIdx = GetAsInt(transitionValue, "EndState", false, -1);
-			transition.EndState = nextStateIdx >= 0 ? model->GetStoredState(nextStateIdx) : nullptr;
+			transition.EndState = GetIndexedState(model, nextStateIdx);
 		}
 
 
@@ -62,7 +79,7 @@ namespace discenfw
 			)
 		{
 			int prevStateIdx = GetAsInt(stateActionValue, "State", false, -1);
-			stateAction.State = prevStateIdx >= 0 ? model->GetStoredState(prevStateIdx) : nullptr;
+			stateAction.State = GetIndexedState(model, prevStateIdx);
 			StartContext("Action");
 			stateAction.Action = model->DecodeAction(GetAsString(stateActionValue,"Action"));
 			EndContext();
@@ -24,8 +24,24 @@ namespace discenfw
 
 			JsonCommonParser();
 
+			/*!
+			Resolve the state indices with the given states instead of the states stored in the model
+			(null to use the model).
+			*/
+			void SetStateTable(const std::vector< std::shared_ptr<xp::EnvironmentState> >* stateTable)
+			{
+				StateTable = stateTable;
+			}
+
 		protected:
 
+			const std::vector< std::shared_ptr<xp::EnvironmentState> >* StateTable = nullptr;
+
+			std::shared_ptr<xp::EnvironmentState> GetIndexedState(
+				std::shared_ptr<xp::EnvironmentModel> model,
+				int stateIndex
+				) const;
+
 			xp::Action ParseAction(const rapidjson::Value& actionValue);
 
 			void ParseTransition(
@@ -25,6 +25,36 @@ namespace discenfw
 		}
 
 
+		void JsonCommonWriter::SetStateTable(const std::vector< std::shared_ptr<EnvironmentState> >* stateTable)
+		{
+			StateIndices = nullptr;
+			StateTableIndices.clear();
+			if (stateTable)
+			{
+				StateTableIndices.reserve(stateTable->size());
+				for (int i = 0; i < (int)stateTable->size(); i++)
+				{
+					StateTableIndices[(*stateTable)[i].get()] = i;
+				}
+				StateIndices = &StateTableIndices;
+			}
+		}
+
+
+		int JsonCommonWriter::GetStateIndex(
+			std::shared_ptr<EnvironmentModel> model,
+			const std::shared_ptr<EnvironmentState>& state
+			) const
+		{
+			if (!StateIndices)
+			{
+				return model->IndexOfState(state);
+			}
+			const auto& indexIt = StateIndices->find(state.get());
+			return indexIt != StateIndices->cend() ? indexIt->second : -1;
+		}
+
+
 		void JsonCommonWriter::WriteAction(const char* memberName, const Action& action)
 		{
 			StartObject(memberName);
@@ -47,9 +77,9 @@ namespace discenfw
 			)
 		{
 			StartObject(name);
-			WriteInt("StartState", model->IndexOfState(transition.StartState));
+			WriteInt("StartState", GetStateIndex(model, transition.StartState));
 			WriteString("ActionTaken", transition.ActionTaken->ToString());
-			WriteInt("EndState", model->IndexOfState(transition.EndState));
+			WriteInt("EndState", GetStateIndex(model, transition.EndState));
 			EndObject();
 		}
 
@@ -61,7 +91,7 @@ namespace discenfw
 			)
 		{
 			StartObject(name);
-			WriteInt("State", model->IndexOfState(stateAction.State));
+			WriteInt("State", GetStateIndex(model, stateAction.State));
 			WriteString("Action", stateAction.Action->ToString());
 			WriteFloat("Value", value);
 			EndObject();
@@ -15,6 +15,7 @@
 #include <discenfw/xp/EnvironmentModel.h>
 
 #include <memory>
+#include <unordered_map>
 
 namespace discenfw
 {
@@ -26,8 +27,33 @@ namespace discenfw
 		public:
 			JsonCommonWriter();
 
+			/*!
+			Write the state indices referring to the given states instead of the states stored in the model
+			(null to use the model).
+			*/
+			void SetStateTable(const std::vector< std::shared_ptr<xp::EnvironmentState> >* stateTable);
+
+			/*!
+			Write the state indices found in the given map instead of the indices of the states stored in the model
+			(null to use the model).
+			*/
+			void SetStateIndices(const std::unordered_map<const xp::EnvironmentState*, int>* stateIndices)
+			{
+				StateIndices = stateIndices;
+			}
+
 		protected:
 
+			const std::unordered_map<const xp::EnvironmentState*, int>* StateIndices = nullptr;
+
+			//! Index of each state in the state table (see SetStateTable()).
+			std::unordered_map<const xp::EnvironmentState*, int> StateTableIndices;
+
+			int GetStateIndex(
+				std::shared_ptr<xp::EnvironmentModel> model,
+				const std::shared_ptr<xp::EnvironmentState>& state
+				) const;
+
 			void WriteAction(const char* memberName, const xp::Action& action);
 
 			void WriteTransition(
@@ -31,6 +31,16 @@ namespace discenfw
 			return environmentModel;
 		}
 
+		void EnvironmentStatesFromJson(
+			const std::string& knowlJsonText,
+			std::vector< std::shared_ptr<EnvironmentState> >& states
+			)
+		{
+			JsonEnvironmentModelParser parser;
+			parser.ParseEnvironmentStates(knowlJsonText, states);
+			parser.CheckJsonErrors();
+		}
+
 		void EnvironmentModelToJson(
 			const std::shared_ptr<EnvironmentModel>& environmentModel,
 			std::string& jsonText,
@@ -49,6 +59,16 @@ namespace discenfw
 			JsonEnvironmentModelWriter writer;
 			writer.WriteEnvironmentModelDefinition(environmentModel, jsonText);
 		}
+
+		void EnvironmentModelKnowledgeToJson(
+			const std::shared_ptr<EnvironmentModel>& environmentModel,
+			std::string& knowlJsonText,
+			const std::vector< std::shared_ptr<EnvironmentState> >* stateTable
+			)
+		{
+			JsonEnvironmentModelWriter writer;
+			writer.WriteEnvironmentModelKnowledge(environmentModel, knowlJsonText, stateTable);
+		}
 	}
 }
 
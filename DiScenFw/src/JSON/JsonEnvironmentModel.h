@@ -13,6 +13,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 
 namespace discenfw
@@ -29,6 +30,15 @@ namespace discenfw
 		);
 
 
+		/*!
+		Parse the states of an EnvironmentModel knowledge from a JSON text, without storing them in the model.
+		*/
+		void EnvironmentStatesFromJson(
+			const std::string& knowlJsonText,
+			std::vector< std::shared_ptr<EnvironmentState> >& states
+		);
+
+
 		/*!
 		Serialize an EnvironmentModel to a JSON text.
 		*/
@@ -45,5 +55,16 @@ namespace discenfw
 			const std::shared_ptr<EnvironmentModel>& environmentModel,
 			std::string& jsonText
 		);
+
+
+		/*!
+		Serialize the knowledge (stored states) of an EnvironmentModel to a JSON text.
+		@param stateTable if not null these states are written instead of the states stored in the model.
+		*/
+		void EnvironmentModelKnowledgeToJson(
+			const std::shared_ptr<EnvironmentModel>& environmentModel,
+			std::string& knowlJsonText,
+			const std::vector< std::shared_ptr<EnvironmentState> >* stateTable = nullptr
+		);
 	}
 }
@@ -124,6 +124,36 @@ namespace discenfw
 		}
 
 
+		void JsonEnvironmentModelParser::ParseEnvironmentStates(
+			const std::string& knowlJsonText,
+			std::vector< std::shared_ptr<xp::EnvironmentState> >& states
+			)
+		{
+			StartContext("EnvironmentModelKnowledge");
+
+			Parse(knowlJsonText);
+
+			// states are not stored in the model, their positions are kept
+			const Value& environmentModelValue = GetRootElement("EnvironmentModelKnowledge");
+			states.clear();
+			if (CheckHasArray(environmentModelValue, "States", true))
+			{
+				StartContext("States");
+				const Value& statesValue = environmentModelValue["States"];
+				states.reserve(statesValue.Size());
+				for (SizeType i = 0; i < statesValue.Size(); i++)
+				{
+					StartContext(i);
+					states.push_back(ParseEnvironmentState(statesValue[i]));
+					EndContext();
+				}
+				EndContext();
+			}
+
+			EndContext();
+		}
+
+
 		std::shared_ptr<xp::EntityStateType> JsonEnvironmentModelParser::ParseEntityStateType(const rapidjson::Value& entityStateTypeValue)
 		{
 			std::string modelName = GetAsString(entityStateTypeValue, "ModelName");
@@ -26,6 +26,7 @@ namespace discenfw
 			std::shared_ptr<xp::EnvironmentModel> ParseEnvironmentModel(const std::string& jsonText, const std::string& knowlJsonText = "");
 			std::shared_ptr<xp::EnvironmentModel> ParseEnvironmentModelDefinition(const std::string& jsonText);
 			std::shared_ptr<xp::EnvironmentModel> ParseEnvironmentModelKnowledge(const std::string& jsonText, std::shared_ptr<xp::EnvironmentModel>);
+			void ParseEnvironmentStates(const std::string& knowlJsonText, std::vector< std::shared_ptr<xp::EnvironmentState> >& states);
 
 		protected:
 
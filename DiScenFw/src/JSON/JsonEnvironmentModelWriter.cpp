@@ -77,13 +77,23 @@ namespace discenfw
 		}
 
 
-		void JsonEnvironmentModelWriter::WriteEnvironmentModelKnowledge(const std::shared_ptr<xp::EnvironmentModel> environmentModel, std::string& jsonText)
+		void JsonEnvironmentModelWriter::WriteEnvironmentModelKnowledge(
+			const std::shared_ptr<xp::EnvironmentModel> environmentModel,
+			std::string& jsonText,
+			const std::vector< std::shared_ptr<xp::EnvironmentState> >* stateTable
+			)
 		{
 			StartDocument();
 			StartObject("EnvironmentModelKnowledge");
 			WriteString("Name", environmentModel->GetName(), true);
 
-			const std::vector< std::shared_ptr<const EnvironmentState> >& states = environmentModel->GetAllStates();
+			std::vector< std::shared_ptr<EnvironmentState> > storedStates;
+			if (!stateTable)
+			{
+				environmentModel->CopyStoredStates(storedStates);
+				stateTable = &storedStates;
+			}
+			const std::vector< std::shared_ptr<EnvironmentState> >& states = *stateTable;
 			if (!states.empty())
 			{
 				StartArray("States");
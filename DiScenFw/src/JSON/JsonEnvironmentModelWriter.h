@@ -30,7 +30,11 @@ namespace discenfw
 				std::string& knowlJsonText
 				);
 			void WriteEnvironmentModelDefinition(const std::shared_ptr<xp::EnvironmentModel> environmentModel, std::string& jsonText);
-			void WriteEnvironmentModelKnowledge(const std::shared_ptr<xp::EnvironmentModel> environmentModel, std::string& jsonText);
+			void WriteEnvironmentModelKnowledge(
+				const std::shared_ptr<xp::EnvironmentModel> environmentModel,
+				std::string& jsonText,
+				const std::vector< std::shared_ptr<xp::EnvironmentState> >* stateTable = nullptr
+				);
 			void WriteEntityStateTypes(const std::shared_ptr<xp::EnvironmentModel> environmentModel, std::string& jsonText);
 		protected:
 
@@ -11,10 +11,95 @@
 #include "JsonExperienceWriter.h"
 #include "JsonExperience.h"
 
+#include <rapidjson/reader.h>
+
 using namespace discenfw::json;
 using namespace discenfw::xp;
 
 
+namespace
+{
+	// SAX handler reading the attributes of an experience, stopped at the first array (the experience data)
+	// or at the end of the experience object
+	class ExperienceAttributesHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, ExperienceAttributesHandler>
+	{
+	public:
+
+		ExperienceAttributesHandler(Experience& experience) : ScannedExperience(experience) {}
+
+		//! Set when all the attributes were read.
+		bool Complete = false;
+
+		bool StartObject()
+		{
+			Depth++;
+			return true;
+		}
+
+		bool EndObject(rapidjson::SizeType)
+		{
+			Depth--;
+			Complete = (Depth == 1);
+			return !Complete;
+		}
+
+		bool StartArray()
+		{
+			Complete = (Depth == 2);
+			return false;
+		}
+
+		bool Key(const char* str, rapidjson::SizeType length, bool)
+		{
+			CurrentKey.assign(str, length);
+			return true;
+		}
+
+		bool String(const char* str, rapidjson::SizeType length, bool)
+		{
+			if (Depth != 2)
+			{
+				return true;
+			}
+			const std::string value(str, length);
+			if (CurrentKey == "Model") ScannedExperience.Model = value;
+			else if (CurrentKey == "Goal") ScannedExperience.Goal = value;
+			else if (CurrentKey == "Role") ScannedExperience.Role = value;
+			else if (CurrentKey == "Agent") ScannedExperience.Agent = value;
+			else if (CurrentKey == "Level") ScannedExperience.Level = ExperienceLevelFromString(value);
+			return true;
+		}
+
+		bool Bool(bool value)
+		{
+			if (Depth == 2 && CurrentKey == "SystemFailureIgnored")
+			{
+				ScannedExperience.SystemFailureIgnored = value;
+			}
+			return true;
+		}
+
+		bool Double(double value)
+		{
+			if (Depth == 2 && CurrentKey == "DiscountingConstant")
+			{
+				ScannedExperience.DiscountingConstant = (float)value;
+			}
+			return true;
+		}
+
+		bool Int(int value) { return Double((double)value); }
+		bool Uint(unsigned value) { return Double((double)value); }
+
+	protected:
+
+		Experience& ScannedExperience;
+		std::string CurrentKey;
+		int Depth = 0;
+	};
+}
+
+
 namespace discenfw
 {
 	namespace xp
@@ -28,19 +113,82 @@ namespace discenfw
 		}
 
 
-		std::shared_ptr<Experience> ExperienceFromJson(const std::string& jsonText, std::shared_ptr<xp::Experience> experience)
+		std::shared_ptr<Experience> ScanExperienceAttributes(const std::string& jsonText)
+		{
+			std::shared_ptr<Experience> experience = std::make_shared<Experience>();
+			ExperienceAttributesHandler handler(*experience);
+			rapidjson::Reader reader;
+			rapidjson::StringStream stream(jsonText.c_str());
+			// parsing is stopped by the handler
+			reader.Parse(stream, handler);
+			return handler.Complete ? experience : nullptr;
+		}
+
+
+		void ExperienceContentFromJson(
+			const std::string& jsonText,
+			std::shared_ptr<xp::Experience> experience,
+			const std::vector< std::shared_ptr<EnvironmentState> >* stateTable
+			)
+		{
+			JsonExperienceParser parser;
+			parser.SetStateTable(stateTable);
+			parser.ParseExperienceContent(jsonText, experience);
+			parser.CheckJsonErrors();
+		}
+
+
+		std::shared_ptr<Experience> ExperienceFromJson(
+			const std::string& jsonText,
+			std::shared_ptr<xp::Experience> experience,
+			const std::vector< std::shared_ptr<EnvironmentState> >* stateTable
+			)
 		{
 			JsonExperienceParser parser;
+			parser.SetStateTable(stateTable);
 			experience = parser.ParseExperience(jsonText, experience);
 			parser.CheckJsonErrors();
 			return experience;
 		}
 
 
-		void ExperienceToJson(const std::shared_ptr<Experience>& experience, std::string& jsonText)
+		bool ExperienceToJson(
+			const std::shared_ptr<Experience>& experience,
+			std::string& jsonText,
+			const std::vector< std::shared_ptr<EnvironmentState> >* stateTable
+			)
+		{
+			JsonExperienceWriter writer;
+			writer.SetStateTable(stateTable);
+			return writer.WriteExperience(experience, jsonText);
+		}
+
+
+		void ExperienceUpdateFromJson(
+			const std::string& jsonText,
+			std::shared_ptr<xp::Experience> experience,
+			const std::vector< std::shared_ptr<EnvironmentState> >* stateTable
+			)
+		{
+			JsonExperienceParser parser;
+			parser.SetStateTable(stateTable);
+			parser.ParseExperienceUpdate(jsonText, experience);
+			parser.CheckJsonErrors();
+		}
+
+
+		void ExperienceUpdateToJson(
+			const std::shared_ptr<Experience>& experience,
+			const std::vector<EpisodeView>& episodes,
+			const std::vector<Transition>& failedTransitions,
+			const std::vector<StateActionRef>& stateActions,
+			std::string& jsonText,
+			const std::unordered_map<const EnvironmentState*, int>* stateIndices
+			)
 		{
 			JsonExperienceWriter writer;
-			writer.WriteExperience(experience, jsonText);
+			writer.SetStateIndices(stateIndices);
+			writer.WriteExperienceUpdate(experience, episodes, failedTransitions, stateActions, jsonText);
 		}
 	}
 }
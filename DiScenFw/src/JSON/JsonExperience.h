@@ -13,6 +13,7 @@
 
 #include <string>
 #include <memory>
+#include <unordered_map>
 
 
 namespace discenfw
@@ -25,16 +26,70 @@ namespace discenfw
 		*/
 		std::shared_ptr<Experience> ExperienceAttributesFromJson(const std::string& jsonText);
 
+		/*!
+		Read the basic attributes of an Experience from the beginning of a JSON text written by ExperienceToJson(),
+		without parsing the experience data (the text can be truncated after the attributes).
+		@return The experience with the attributes or null if the text does not begin with all the attributes.
+		*/
+		std::shared_ptr<Experience> ScanExperienceAttributes(const std::string& jsonText);
+
+		/*!
+		Parse the data of an Experience (failed transitions, episodes and state-action values)
+		from a JSON text into the given experience (its attributes are not changed).
+		@param stateTable if not null state indices refer to these states instead of the states stored in the model.
+		*/
+		void ExperienceContentFromJson(
+			const std::string& jsonText,
+			std::shared_ptr<xp::Experience> experience,
+			const std::vector< std::shared_ptr<EnvironmentState> >* stateTable = nullptr
+			);
+
 		/*!
 		Parse an Experience from a JSON text.
+		@param stateTable if not null state indices refer to these states instead of the states stored in the model.
 		*/
-		std::shared_ptr<Experience> ExperienceFromJson(const std::string& jsonText, std::shared_ptr<xp::Experience> experience = nullptr);
+		std::shared_ptr<Experience> ExperienceFromJson(
+			const std::string& jsonText,
+			std::shared_ptr<xp::Experience> experience = nullptr,
+			const std::vector< std::shared_ptr<EnvironmentState> >* stateTable = nullptr
+			);
 
 
 		/*!
 		Serialize an Experience to a JSON text.
+		@param stateTable if not null state indices refer to these states instead of the states stored in the model.
+		@return false if the episodes cannot be read (see Experience::ForEachEpisode()), in this case jsonText is empty.
+		*/
+		bool ExperienceToJson(
+			const std::shared_ptr<Experience>& experience,
+			std::string& jsonText,
+			const std::vector< std::shared_ptr<EnvironmentState> >* stateTable = nullptr
+			);
+
+
+		/*!
+		Parse the data added to an Experience (see ExperienceJournal) from a JSON text and add it to the given experience.
+		@param stateTable if not null state indices refer to these states instead of the states stored in the model.
+		*/
+		void ExperienceUpdateFromJson(
+			const std::string& jsonText,
+			std::shared_ptr<xp::Experience> experience,
+			const std::vector< std::shared_ptr<EnvironmentState> >* stateTable = nullptr
+			);
+
+
+		/*!
+		Serialize the given data added to an Experience (see ExperienceJournal) to a JSON text.
+		@param stateIndices if not null state indices are taken from this map instead of the states stored in the model.
 		*/
-		void ExperienceToJson(const std::shared_ptr<Experience>& experience, std::string& jsonText);
+		void ExperienceUpdateToJson(
+			const std::shared_ptr<Experience>& experience,
+			const std::vector<EpisodeView>& episodes,
+			const std::vector<Transition>& failedTransitions,
+			const std::vector<StateActionRef>& stateActions,
+			std::string& jsonText,
+			const std::unordered_map<const EnvironmentState*, int>* stateIndices = nullptr
+			);
 
 	}
 }
@@ -9,6 +9,8 @@
 
 #include "JsonExperienceParser.h"
 
+#include <algorithm>
+
 using namespace rapidjson;
 using namespace discenfw::xp;
 
@@ -89,7 +91,7 @@ namespace discenfw
 				experience->BestEpisode = nullptr;
 				experience->BestEpisodes.clear();
 				experience->FailedTransitions.clear();
-				experience->Episodes.clear();
+				experience->ClearEpisodes();
 				for (SizeType i = 0; i < episodes.Size(); i++)
 				{
 					StartContext(i);
@@ -126,6 +128,75 @@ namespace discenfw
 		}
 
 
+		void JsonExperienceParser::ParseExperienceUpdate(
+			const std::string& jsonText,
+			std::shared_ptr<xp::Experience> experience
+			)
+		{
+			StartContext("ExperienceUpdate");
+
+			Parse(jsonText);
+
+			// unlike ParseExperienceDefinition() data is added to the experience
+			const Value& updateValue = GetRootElement("ExperienceUpdate");
+
+			if (CheckHasArray(updateValue, "FailedTransitions", true))
+			{
+				StartContext("FailedTransitions");
+				const Value& failedTransitions = updateValue["FailedTransitions"];
+				for (SizeType i = 0; i < failedTransitions.Size(); i++)
+				{
+					StartContext(i);
+					Transition transition;
+					ParseTransition(experience->GetModel(), failedTransitions[i], transition);
+					if (std::find(experience->FailedTransitions.cbegin(), experience->FailedTransitions.cend(), transition)
+						== experience->FailedTransitions.cend())
+					{
+						experience->FailedTransitions.push_back(transition);
+					}
+					EndContext();
+				}
+				EndContext();
+			}
+
+			if (CheckHasArray(updateValue, "Episodes", true))
+			{
+				StartContext("Episodes");
+				const Value& episodes = updateValue["Episodes"];
+				for (SizeType i = 0; i < episodes.Size(); i++)
+				{
+					StartContext(i);
+					experience->StoreEpisode(ParseEpisode(*experience, episodes[i]), false);
+					EndContext();
+				}
+				EndContext();
+			}
+
+			if (CheckHasArray(updateValue, "StateActionValues", true))
+			{
+				StartContext("StateActionValues");
+				const Value& stateActionValues = updateValue["StateActionValues"];
+				for (SizeType i = 0; i < stateActionValues.Size(); i++)
+				{
+					StartContext(i);
+					StateActionRef stateAction;
+					float value = 0.0f;
+					ParseStateActionValue(
+						experience->GetModel(),
+						stateActionValues[i],
+						stateAction,
+						value
+						);
+					experience->StateActionValues[stateAction] = value;
+					EndContext();
+				}
+				EndContext();
+			}
+
+			EndContext();
+		}
+
+
 		Action JsonExperienceParser::ParseAction(const rapidjson::Value& actionValue)
 		{
 			Action action;
@@ -150,7 +221,7 @@ namespace discenfw
 		{
 			std::shared_ptr<Episode> episode = std::make_shared<Episode>();
 			int initStateIdx = GetAsInt(episodeValue, "InitialState", false, -1);
-			episode->InitialState = initStateIdx >= 0 ? experience.GetStoredState(initStateIdx) : nullptr;
+			episode->InitialState = GetIndexedState(experience.GetModel(), initStateIdx);
 			if (CheckHasArray(episodeValue, "TransitionSequence", true))
 			{
 				const Value& actionsValue = episodeValue["TransitionSequence"];
@@ -165,7 +236,7 @@ namespace discenfw
 				}
 			}
 			int finalStateIdx = GetAsInt(episodeValue, "LastState", false, -1);
-			episode->LastState = finalStateIdx >= 0 ? experience.GetStoredState(finalStateIdx) : nullptr;
+			episode->LastState = GetIndexedState(experience.GetModel(), finalStateIdx);
 			episode->Performance = GetAsInt(episodeValue, "Performance", true);
 			episode->Result = ActionResultFromString(GetAsString(episodeValue, "Result", true));
 			episode->RepetitionsCount = GetAsInt(episodeValue, "RepetitionsCount", true);
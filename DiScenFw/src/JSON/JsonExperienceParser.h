@@ -26,6 +26,20 @@ namespace discenfw
 			std::shared_ptr<xp::Experience> ParseExperienceAttributes(const std::string& jsonText);
 			std::shared_ptr<xp::Experience> ParseExperience(const std::string& jsonText, std::shared_ptr<xp::Experience> experience = nullptr);
 
+			/*!
+			Parse the data of an experience (failed transitions, episodes and state-action values) into the given experience,
+			without changing its attributes.
+			*/
+			void ParseExperienceContent(const std::string& jsonText, std::shared_ptr<xp::Experience> experience)
+			{
+				ParseExperienceDefinition(jsonText, experience);
+			}
+
+			/*!
+			Parse the data added to an experience (see xp::ExperienceJournal) and add it to the given experience.
+			*/
+			void ParseExperienceUpdate(const std::string& jsonText, std::shared_ptr<xp::Experience> experience);
+
 		protected:
 
 			std::shared_ptr<xp::Experience> ParseExperienceDefinition(const std::string& jsonText, std::shared_ptr<xp::Experience> experience);
@@ -23,7 +23,7 @@ namespace discenfw
 		{
 		}
 
-		void JsonExperienceWriter::WriteExperience(const std::shared_ptr<Experience> experience, std::string& jsonText)
+		bool JsonExperienceWriter::WriteExperience(const std::shared_ptr<Experience> experience, std::string& jsonText)
 		{
 			StartDocument();
 			StartObject("Experience");
@@ -53,13 +53,19 @@ namespace discenfw
 				EndArray();
 			}
 
-			if (!experience->Episodes.empty())
+			if (experience->GetEpisodeCount() > 0)
 			{
 				StartArray("Episodes");
-				for (unsigned i = 0; i < experience->Episodes.size(); i++)
+				const std::shared_ptr<EnvironmentModel> model = experience->GetModel();
+				bool episodesRead = experience->ForEachEpisode([this, &model](const EpisodeView& episode)
 				{
-					std::shared_ptr<Episode> episode = experience->Episodes[i];
-					WriteEpisode(experience->GetModel(), episode);
+					WriteEpisode(model, episode);
+				});
+				if (!episodesRead)
+				{
+					// do not return an incomplete document
+					jsonText.clear();
+					return false;
 				}
 				EndArray();
 			}
@@ -80,9 +86,57 @@ namespace discenfw
 
 			EndObject();
 			EndDocument(jsonText);
+			return true;
 		}
 
 
+		void JsonExperienceWriter::WriteExperienceUpdate(
+			const std::shared_ptr<Experience> experience,
+			const std::vector<EpisodeView>& episodes,
+			const std::vector<Transition>& failedTransitions,
+			const std::vector<StateActionRef>& stateActions,
+			std::string& jsonText
+			)
+		{
+			const std::shared_ptr<EnvironmentModel> model = experience->GetModel();
+			StartDocument();
+			StartObject("ExperienceUpdate");
+			WriteString("Goal", experience->Goal);
+
+			if (!failedTransitions.empty())
+			{
+				StartArray("FailedTransitions");
+				for (const Transition& transition : failedTransitions)
+				{
+					WriteTransition(model, transition);
+				}
+				EndArray();
+			}
+
+			if (!episodes.empty())
+			{
+				StartArray("Episodes");
+				for (const EpisodeView& episode : episodes)
+				{
+					WriteEpisode(model, episode);
+				}
+				EndArray();
+			}
+
+			if (!stateActions.empty())
+			{
+				StartArray("StateActionValues");
+				for (const StateActionRef& stateAction : stateActions)
+				{
+					WriteStateActionValue(model, stateAction, experience->GetStateActionValue(stateAction));
+				}
+				EndArray();
+			}
+
+			EndObject();
+			EndDocument(jsonText);
+		}
+
 
 		void JsonExperienceWriter::WriteEntityState(const char* memberName, const std::shared_ptr<const EntityState> entState)
 		{
@@ -132,20 +186,20 @@ namespace discenfw
 		}
 
 
-		void JsonExperienceWriter::WriteEpisode(const std::shared_ptr<EnvironmentModel> model, const std::shared_ptr<const Episode> episode)
+		void JsonExperienceWriter::WriteEpisode(const std::shared_ptr<EnvironmentModel> model, const EpisodeView& episode)
 		{
 			StartObject();
-			WriteInt("InitialState", model->IndexOfState(episode->InitialState));
+			WriteInt("InitialState", GetStateIndex(model, episode.GetInitialState()));
 			StartArray("TransitionSequence");
-			for (unsigned i = 0; i < episode->TransitionSequence.size(); i++)
+			for (size_t i = 0; i < episode.GetTransitionCount(); i++)
 			{
-				WriteTransition(model, episode->TransitionSequence[i]);
+				WriteTransition(model, episode.GetTransition(i));
 			}
 			EndArray();
-			WriteInt("LastState", model->IndexOfState(episode->LastState));
-			WriteInt("Performance", episode->Performance);
-			WriteString("Result", ActionResultToString(episode->Result));
-			WriteInt("RepetitionsCount", episode->RepetitionsCount);
+			WriteInt("LastState", GetStateIndex(model, episode.GetLastState()));
+			WriteInt("Performance", episode.GetPerformance());
+			WriteString("Result", ActionResultToString(episode.GetResult()));
+			WriteInt("RepetitionsCount", episode.GetRepetitionsCount());
 			EndObject();
 		}
 
@@ -25,12 +25,28 @@ namespace discenfw
 		public:
 			JsonExperienceWriter();
 
-			void WriteExperience(const std::shared_ptr<xp::Experience> experience, std::string& jsonText);
+			/*!
+			Write the given experience.
+			@return false if the episodes cannot be read (see xp::Experience::ForEachEpisode()).
+			*/
+			bool WriteExperience(const std::shared_ptr<xp::Experience> experience, std::string& jsonText);
+
+			/*!
+			Write the given data added to an experience (see xp::ExperienceJournal),
+			the values of the given state-actions are taken from the experience.
+			*/
+			void WriteExperienceUpdate(
+				const std::shared_ptr<xp::Experience> experience,
+				const std::vector<xp::EpisodeView>& episodes,
+				const std::vector<xp::Transition>& failedTransitions,
+				const std::vector<xp::StateActionRef>& stateActions,
+				std::string& jsonText
+				);
 		protected:
 
 			void WriteEntityState(const char* memberName, const std::shared_ptr<const xp::EntityState> entState);
 			void WriteEnvironmentState(int stateIndex, const std::shared_ptr<const xp::EnvironmentState> state);
-			void WriteEpisode(const std::shared_ptr<xp::EnvironmentModel> model, const std::shared_ptr<const xp::Episode> episode);
+			void WriteEpisode(const std::shared_ptr<xp::EnvironmentModel> model, const xp::EpisodeView& episode);
 		};
 
 	}
@@ -132,6 +132,7 @@ namespace discenfw
 			historyEventData->Uri = GetAsString(historyEventValue, "Uri");
 			historyEventData->Category = GetAsString(historyEventValue, "Category");
 			historyEventData->DateTime = gpvulc::StringToDateTime(GetAsString(historyEventValue, "DateTime"));
+			historyEventData->EntityId = GetAsString(historyEventValue, "EntityId", true);
 			return historyEventData;
 		}
 
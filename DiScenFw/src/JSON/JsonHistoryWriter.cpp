@@ -112,6 +112,10 @@ namespace discenfw
 			WriteString("Uri", historyEvent->Uri);
 			WriteString("Category", historyEvent->Category);
 			WriteString("DateTime", gpvulc::DateTimeToString(historyEvent->DateTime));
+			if (!historyEvent->EntityId.empty())
+			{
+				WriteString("EntityId", historyEvent->EntityId);
+			}
 		}
 
 	}
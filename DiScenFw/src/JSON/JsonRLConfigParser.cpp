@@ -36,6 +36,13 @@ namespace discenfw
 			rlConfig.FixedStepSize = GetAsFloat(qlConfigValue, "FixedStepSize", true, rlConfig.SampleAverage);
 			rlConfig.DiscountRate = GetAsFloat(qlConfigValue, "DiscountRate");
 			rlConfig.Epsilon = GetAsFloat(qlConfigValue, "Epsilon");
+			rlConfig.PlanningSteps = GetAsInt(qlConfigValue, "PlanningSteps", true, 0);
+			rlConfig.ReplayCapacity = GetAsInt(qlConfigValue, "ReplayCapacity", true, 10000);
+			rlConfig.PriorityExponent = GetAsFloat(qlConfigValue, "PriorityExponent", true, 1.0f);
+			rlConfig.PriorityThreshold = GetAsFloat(qlConfigValue, "PriorityThreshold", true, 0.0001f);
+			rlConfig.TraceDecay = GetAsFloat(qlConfigValue, "TraceDecay", true, 0.0f);
+			rlConfig.CutTracesOnExploration = GetAsBool(qlConfigValue, "CutTracesOnExploration", true, true);
+			rlConfig.TraceThreshold = GetAsFloat(qlConfigValue, "TraceThreshold", true, 0.01f);
 
 			EndContext();
 			return rlConfig;
@@ -44,6 +44,19 @@ namespace discenfw
 			}
 			WriteFloat("DiscountRate", rlConfig.DiscountRate);
 			WriteFloat("Epsilon", rlConfig.Epsilon);
+			if (rlConfig.PlanningSteps > 0)
+			{
+				WriteInt("PlanningSteps", rlConfig.PlanningSteps);
+				WriteInt("ReplayCapacity", rlConfig.ReplayCapacity);
+				WriteFloat("PriorityExponent", rlConfig.PriorityExponent);
+				WriteFloat("PriorityThreshold", rlConfig.PriorityThreshold);
+			}
+			if (rlConfig.TraceDecay > 0.0f)
+			{
+				WriteFloat("TraceDecay", rlConfig.TraceDecay);
+				WriteBool("CutTracesOnExploration", rlConfig.CutTracesOnExploration);
+				WriteFloat("TraceThreshold", rlConfig.TraceThreshold);
+			}
 
 			EndObject();
 			EndDocument(jsonText);
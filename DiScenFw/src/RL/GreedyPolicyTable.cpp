@@ -0,0 +1,477 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/RL/GreedyPolicyTable.h>
+#include <discenfw/xp/EnvironmentModel.h>
+#include <discenfw/xp/EnvironmentState.h>
+#include <discenfw/xp/EntityState.h>
+#include <discenfw/xp/Action.h>
+#include <discenfw/util/MessageLog.h>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	const char POLICY_MAGIC[8] = { 'D','S','F','P','O','L','C','Y' };
+	const uint32_t POLICY_VERSION = 2;
+
+	/*
+	File layout (all the offsets are absolute and 8-byte aligned):
+	PolicyHeader
+	state offsets (uint32 x (StateCount+1))
+	best action identifiers (uint32 x EntryCount)
+	state keys (uint64 x StateCount)
+	action string end offsets (uint64 x ActionCount), action string data
+	*/
+	struct PolicyHeader
+	{
+		char Magic[8];
+		uint32_t Version;
+		uint32_t StateCount;
+		uint32_t ActionCount;
+		uint32_t EntryCount;
+		uint64_t OffsetsOffset;
+		uint64_t EntriesOffset;
+		uint64_t StringTableOffset;
+		uint64_t StringDataOffset;
+		uint64_t KeysOffset;
+	};
+
+	static_assert(sizeof(PolicyHeader) == 64, "Unexpected PolicyHeader layout");
+
+
+	uint64_t AlignedSize(uint64_t size)
+	{
+		return (size + 7) & ~(uint64_t)7;
+	}
+
+
+	// FNV-1a hash, stable across platforms and builds (unlike std::hash)
+	void HashString(uint64_t& hash, const std::string& str)
+	{
+		const uint64_t size = str.size();
+		for (int i = 0; i < 8; i++)
+		{
+			hash = (hash ^ ((size >> (i * 8)) & 0xff)) * 1099511628211ULL;
+		}
+		for (const char c : str)
+		{
+			hash = (hash ^ (unsigned char)c) * 1099511628211ULL;
+		}
+	}
+
+
+	// Key used to match the states saved in a table with the states of the model
+	uint64_t GetStateKey(const discenfw::xp::EnvironmentState& state)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		for (const auto& entStateEntry : state.GetEntityStates())
+		{
+			HashString(hash, entStateEntry.first);
+			if (!entStateEntry.second)
+			{
+				continue;
+			}
+			for (const auto& propValue : entStateEntry.second->GetPropertyValues())
+			{
+				HashString(hash, propValue.first);
+				HashString(hash, propValue.second);
+			}
+			for (const auto& relationship : entStateEntry.second->GetRelationships())
+			{
+				HashString(hash, relationship.first);
+				HashString(hash, relationship.second.EntityId);
+				HashString(hash, relationship.second.LinkId);
+			}
+		}
+		for (const auto& feature : state.GetFeatures())
+		{
+			HashString(hash, feature.first);
+			HashString(hash, feature.second);
+		}
+		return hash;
+	}
+}
+
+
+namespace discenfw
+{
+	namespace xp
+	{
+		struct GreedyPolicyTable::MappedFile
+		{
+			boost::interprocess::file_mapping Mapping;
+			boost::interprocess::mapped_region Region;
+		};
+
+
+		GreedyPolicyTable::GreedyPolicyTable()
+		{
+		}
+
+
+		GreedyPolicyTable::~GreedyPolicyTable()
+		{
+		}
+
+
+		bool GreedyPolicyTable::Build(
+			const std::map<StateActionRef, float>& stateActionValues,
+			std::shared_ptr<EnvironmentModel> model
+			)
+		{
+			Clear();
+			if (!model)
+			{
+				LogMessage(LOG_ERROR, "Environment model not defined, cannot build the policy table", "DiScenFw");
+				return false;
+			}
+			StateCount = (uint32_t)model->GetNumStates();
+			StateKeyData.reserve(StateCount);
+			for (uint32_t i = 0; i < StateCount; i++)
+			{
+				StateKeyData.push_back(GetStateKey(*model->GetStoredState(i)));
+			}
+			StateKeys = StateKeyData.data();
+			IndexStates(model);
+
+			// collect the best actions of each state (values are sorted by state)
+			std::vector< std::vector<ActionRef> > bestActions(StateCount);
+			std::map<std::string, ActionRef> actionMap;
+			auto it = stateActionValues.cbegin();
+			while (it != stateActionValues.cend())
+			{
+				const StateRef state = it->first.State;
+				float maxValue = it->second;
+				auto stateEnd = it;
+				for (; stateEnd != stateActionValues.cend() && stateEnd->first.State == state; ++stateEnd)
+				{
+					maxValue = std::max(maxValue, stateEnd->second);
+				}
+				const int stateId = GetStateId(state);
+				for (; it != stateEnd; ++it)
+				{
+					if (stateId >= 0 && it->first.Action && it->second >= maxValue)
+					{
+						bestActions[stateId].push_back(it->first.Action);
+						actionMap[it->first.Action->ToString()] = it->first.Action;
+					}
+				}
+			}
+
+			// sort actions by their encoding to get the same table for the same values
+			std::map<ActionRef, uint32_t> actionIds;
+			for (const auto& actionPair : actionMap)
+			{
+				actionIds[actionPair.second] = (uint32_t)Actions.size();
+				Actions.push_back(actionPair.second);
+				ActionStrings.push_back(actionPair.first);
+			}
+
+			OffsetData.reserve(StateCount + 1);
+			OffsetData.push_back(0);
+			for (const auto& stateActions : bestActions)
+			{
+				const size_t first = EntryData.size();
+				for (const ActionRef& action : stateActions)
+				{
+					EntryData.push_back(actionIds[action]);
+				}
+				std::sort(EntryData.begin() + first, EntryData.end());
+				OffsetData.push_back((uint32_t)EntryData.size());
+			}
+			Offsets = OffsetData.data();
+			Entries = EntryData.data();
+			return true;
+		}
+
+
+		bool GreedyPolicyTable::Save(const std::string& filePath) const
+		{
+			if (!IsDefined())
+			{
+				LogMessage(LOG_ERROR, "Policy table not defined, cannot save " + filePath, "DiScenFw");
+				return false;
+			}
+
+			std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+			if (!out.good())
+			{
+				LogMessage(LOG_ERROR, "Failed to create " + filePath, "DiScenFw");
+				return false;
+			}
+
+			const uint32_t entryCount = Offsets[StateCount];
+			PolicyHeader header;
+			memcpy(header.Magic, POLICY_MAGIC, sizeof(header.Magic));
+			header.Version = POLICY_VERSION;
+			header.StateCount = StateCount;
+			header.ActionCount = (uint32_t)ActionStrings.size();
+			header.EntryCount = entryCount;
+			header.OffsetsOffset = sizeof(PolicyHeader);
+			header.EntriesOffset = header.OffsetsOffset + AlignedSize((uint64_t)(StateCount + 1) * sizeof(uint32_t));
+			header.KeysOffset = header.EntriesOffset + AlignedSize((uint64_t)entryCount * sizeof(uint32_t));
+			header.StringTableOffset = header.KeysOffset + (uint64_t)StateCount * sizeof(uint64_t);
+			header.StringDataOffset = header.StringTableOffset + (uint64_t)header.ActionCount * sizeof(uint64_t);
+
+			std::vector<uint64_t> stringEnds;
+			uint64_t stringEnd = 0;
+			for (const std::string& actionString : ActionStrings)
+			{
+				stringEnd += actionString.size();
+				stringEnds.push_back(stringEnd);
+			}
+
+			const char padding[8] = { 0 };
+			auto writePadded = [&out, &padding](const void* data, uint64_t size)
+			{
+				out.write(static_cast<const char*>(data), size);
+				out.write(padding, AlignedSize(size) - size);
+			};
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			writePadded(Offsets, (uint64_t)(StateCount + 1) * sizeof(uint32_t));
+			writePadded(Entries, (uint64_t)entryCount * sizeof(uint32_t));
+			out.write(reinterpret_cast<const char*>(StateKeys), (uint64_t)StateCount * sizeof(uint64_t));
+			out.write(reinterpret_cast<const char*>(stringEnds.data()), stringEnds.size() * sizeof(uint64_t));
+			for (const std::string& actionString : ActionStrings)
+			{
+				out.write(actionString.data(), actionString.size());
+			}
+
+			if (!out.good())
+			{
+				LogMessage(LOG_ERROR, "Failed to write " + filePath, "DiScenFw");
+				return false;
+			}
+			return true;
+		}
+
+
+		bool GreedyPolicyTable::Open(const std::string& filePath, std::shared_ptr<EnvironmentModel> model)
+		{
+			Clear();
+			if (!model)
+			{
+				LogMessage(LOG_ERROR, "Environment model not defined, cannot open " + filePath, "DiScenFw");
+				return false;
+			}
+
+			using namespace boost::interprocess;
+			std::unique_ptr<MappedFile> mapping(new MappedFile);
+			try
+			{
+				mapping->Mapping = file_mapping(filePath.c_str(), read_only);
+				mapping->Region = mapped_region(mapping->Mapping, read_only);
+			}
+			catch (const interprocess_exception& e)
+			{
+				LogMessage(LOG_ERROR, "Failed to open " + filePath + ": " + e.what(), "DiScenFw");
+				return false;
+			}
+
+			const char* data = static_cast<const char*>(mapping->Region.get_address());
+			const size_t dataSize = mapping->Region.get_size();
+
+			auto inRange = [dataSize](uint64_t offset, uint64_t size)
+			{
+				return offset % 8 == 0 && offset <= dataSize && size <= dataSize - offset;
+			};
+
+			const PolicyHeader* header = reinterpret_cast<const PolicyHeader*>(data);
+			bool valid = dataSize >= sizeof(PolicyHeader)
+				&& memcmp(header->Magic, POLICY_MAGIC, sizeof(header->Magic)) == 0
+				&& header->Version == POLICY_VERSION
+				&& inRange(header->OffsetsOffset, ((uint64_t)header->StateCount + 1) * sizeof(uint32_t))
+				&& inRange(header->EntriesOffset, (uint64_t)header->EntryCount * sizeof(uint32_t))
+				&& inRange(header->KeysOffset, (uint64_t)header->StateCount * sizeof(uint64_t))
+				&& inRange(header->StringTableOffset, (uint64_t)header->ActionCount * sizeof(uint64_t))
+				&& header->StringDataOffset <= dataSize;
+			const uint32_t* offsets = nullptr;
+			const uint32_t* entries = nullptr;
+			if (valid)
+			{
+				offsets = reinterpret_cast<const uint32_t*>(data + header->OffsetsOffset);
+				entries = reinterpret_cast<const uint32_t*>(data + header->EntriesOffset);
+				valid = offsets[0] == 0 && offsets[header->StateCount] == header->EntryCount;
+				for (uint32_t i = 0; valid && i < header->StateCount; i++)
+				{
+					valid = offsets[i] <= offsets[i + 1];
+				}
+				for (uint32_t i = 0; valid && i < header->EntryCount; i++)
+				{
+					valid = entries[i] < header->ActionCount;
+				}
+			}
+			if (valid && header->ActionCount > 0)
+			{
+				const uint64_t* stringEnds = reinterpret_cast<const uint64_t*>(data + header->StringTableOffset);
+				valid = stringEnds[header->ActionCount - 1] <= dataSize - header->StringDataOffset;
+				uint64_t stringStart = 0;
+				for (uint32_t i = 0; valid && i < header->ActionCount; i++)
+				{
+					valid = stringStart <= stringEnds[i];
+					if (valid)
+					{
+						ActionStrings.push_back(std::string(
+							data + header->StringDataOffset + stringStart,
+							(size_t)(stringEnds[i] - stringStart)));
+						stringStart = stringEnds[i];
+					}
+				}
+			}
+			if (!valid)
+			{
+				LogMessage(LOG_ERROR, "Invalid policy table " + filePath, "DiScenFw");
+				Clear();
+				return false;
+			}
+			for (const std::string& actionString : ActionStrings)
+			{
+				Actions.push_back(model->DecodeAction(actionString));
+			}
+			Mapping = std::move(mapping);
+			StateCount = header->StateCount;
+			Offsets = offsets;
+			Entries = entries;
+			StateKeys = reinterpret_cast<const uint64_t*>(data + header->KeysOffset);
+			IndexStates(model);
+			if (StateIds.size() < StateCount)
+			{
+				LogMessage(LOG_WARNING, "Policy table " + filePath + ": "
+					+ std::to_string(StateCount - StateIds.size()) + " of "
+					+ std::to_string(StateCount) + " states not found in the environment model", "DiScenFw");
+			}
+			return true;
+		}
+
+
+		void GreedyPolicyTable::Clear()
+		{
+			Offsets = nullptr;
+			Entries = nullptr;
+			StateKeys = nullptr;
+			Mapping.reset();
+			StateCount = 0;
+			OffsetData.clear();
+			EntryData.clear();
+			StateKeyData.clear();
+			Actions.clear();
+			ActionStrings.clear();
+			StateIds.clear();
+		}
+
+
+		int GreedyPolicyTable::GetStateId(const StateRef& state) const
+		{
+			const auto& stateIt = StateIds.find(state);
+			return stateIt != StateIds.cend() ? stateIt->second : -1;
+		}
+
+
+		void GreedyPolicyTable::MarkReachableStates(StateMarkSet& reachableStates) const
+		{
+			for (const auto& stateId : StateIds)
+			{
+				if (GetBestActionCount(stateId.second) > 0)
+				{
+					reachableStates.insert(stateId.first.get());
+				}
+			}
+		}
+
+
+		int GreedyPolicyTable::GetBestActionCount(int stateId) const
+		{
+			if (stateId < 0 || stateId >= (int)StateCount)
+			{
+				return 0;
+			}
+			return (int)(Offsets[stateId + 1] - Offsets[stateId]);
+		}
+
+
+		const uint32_t* GreedyPolicyTable::GetBestActionIds(int stateId) const
+		{
+			if (stateId < 0 || stateId >= (int)StateCount)
+			{
+				return nullptr;
+			}
+			return Entries + Offsets[stateId];
+		}
+
+
+		ActionRef GreedyPolicyTable::GetBestAction(const StateRef& state) const
+		{
+			const int stateId = GetStateId(state);
+			if (GetBestActionCount(stateId) == 0)
+			{
+				return nullptr;
+			}
+			return Actions[Entries[Offsets[stateId]]];
+		}
+
+
+		int GreedyPolicyTable::ChooseAction(const std::vector<ActionRef>& possibleActions, const StateRef& state) const
+		{
+			const int stateId = GetStateId(state);
+			const int count = GetBestActionCount(stateId);
+			const uint32_t* actionIds = GetBestActionIds(stateId);
+			for (int i = 0; i < count; i++)
+			{
+				const ActionRef& bestAction = Actions[actionIds[i]];
+				for (size_t j = 0; j < possibleActions.size(); j++)
+				{
+					if (possibleActions[j] == bestAction)
+					{
+						return (int)j;
+					}
+				}
+			}
+			return -1;
+		}
+
+
+		void GreedyPolicyTable::IndexStates(std::shared_ptr<EnvironmentModel> model)
+		{
+			// states are matched by key, not by position, because the model could have been
+			// changed (e.g. unused states collected) since the table was built;
+			// states with colliding keys are ambiguous and left out
+			const int ambiguous = -1;
+			std::unordered_map<uint64_t, int> keyIds;
+			keyIds.reserve(StateCount);
+			for (uint32_t i = 0; i < StateCount; i++)
+			{
+				auto inserted = keyIds.insert({ StateKeys[i], (int)i });
+				if (!inserted.second)
+				{
+					inserted.first->second = ambiguous;
+				}
+			}
+
+			const int modelStateCount = model->GetNumStates();
+			StateIds.clear();
+			StateIds.reserve(std::min((int)StateCount, modelStateCount));
+			for (int i = 0; i < modelStateCount; i++)
+			{
+				const StateRef state = model->GetStoredState(i);
+				const auto keyIt = keyIds.find(GetStateKey(*state));
+				if (keyIt != keyIds.cend() && keyIt->second != ambiguous)
+				{
+					StateIds[state] = keyIt->second;
+				}
+			}
+		}
+
+	} // namespace xp
+}
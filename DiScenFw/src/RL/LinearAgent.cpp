@@ -0,0 +1,378 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/RL/LinearAgent.h>
+
+#include <discenfw/xp/Experience.h>
+#include <discenfw/xp/EntityState.h>
+#include <discenfw/xp/EntityStateType.h>
+
+#include <discenfw/util/Rand.h>
+#include <discenfw/util/MessageLog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+
+namespace
+{
+	bool ParseNumber(const std::string& text, double& number)
+	{
+		if (text.empty())
+		{
+			return false;
+		}
+		char* end = nullptr;
+		number = strtod(text.c_str(), &end);
+		return end != nullptr && *end == '\0';
+	}
+}
+
+
+namespace discenfw
+{
+	namespace xp
+	{
+
+		LinearAgent::LinearAgent(int featureCount, int tilings, float tileWidth)
+		{
+			Weights.assign(std::max(1, featureCount), 0.0f);
+			Tilings = std::max(1, tilings);
+			TileWidth = tileWidth > 0.0f ? tileWidth : 1.0f;
+			QLConfiguration = std::make_shared<RLConfig>();
+		}
+
+
+		LinearAgent::~LinearAgent()
+		{
+		}
+
+
+		void LinearAgent::Reset()
+		{
+			std::fill(Weights.begin(), Weights.end(), 0.0f);
+			StatePossibleActions.clear();
+			RecordedStates.clear();
+			ActionHashes.clear();
+			RandomActionCount = 0;
+			TakenActionCount = 0;
+		}
+
+
+		int LinearAgent::ChooseAction(
+			const std::shared_ptr<Experience> /*experience*/,
+			const std::vector<ActionRef>& possibleActions,
+			StateRef envState,
+			bool updatePolicy
+			)
+		{
+			if (possibleActions.empty())
+			{
+				return -1;
+			}
+			RecordPossibleActions(envState, possibleActions);
+
+			int chosenAction = -1;
+			if (updatePolicy && RandFloat(0.0f, 1.0f) <= QLConfiguration->Epsilon)
+			{
+				RandomActionCount++;
+				chosenAction = RandIndex((int)possibleActions.size());
+			}
+			else
+			{
+				// choose randomly among the actions with the maximum value
+				std::vector<size_t> stateFeatures;
+				GetStateFeatures(envState, stateFeatures);
+				std::vector<int> maxValueActions;
+				float maxValue = 0.0f;
+				for (int i = 0; i < (int)possibleActions.size(); i++)
+				{
+					const float value = ComputeValue(stateFeatures, possibleActions[i]);
+					if (maxValueActions.empty() || value > maxValue)
+					{
+						maxValue = value;
+						maxValueActions.clear();
+					}
+					if (value >= maxValue)
+					{
+						maxValueActions.push_back(i);
+					}
+				}
+				chosenAction = maxValueActions.size() == 1 ? maxValueActions[0]
+					: maxValueActions[RandIndex((int)maxValueActions.size())];
+			}
+			TakenActionCount++;
+			return chosenAction;
+		}
+
+
+		void LinearAgent::ResetStats()
+		{
+			TakenActionCount = 0;
+			RandomActionCount = 0;
+		}
+
+
+		void LinearAgent::Learn(
+			const std::shared_ptr<Experience> experience,
+			const std::vector<Transition>& transitionSequence,
+			ActionResult lastActionResult
+			)
+		{
+			if (transitionSequence.empty())
+			{
+				return;
+			}
+			if (lastActionResult == ActionResult::SUCCEEDED)
+			{
+				// backup until the initial state (see RLAgent::BackUp())
+				for (auto it = transitionSequence.crbegin(); it != transitionSequence.crend(); ++it)
+				{
+					LearnTransition(*it, experience);
+				}
+			}
+			else
+			{
+				LearnTransition(transitionSequence.back(), experience);
+			}
+		}
+
+
+		void LinearAgent::SetConfiguration(const std::shared_ptr<IAgentConfiguration> config)
+		{
+			if (!config)
+			{
+				LogMessage(LOG_ERROR, "Null agent configuration.", "DiScenFw");
+				return;
+			}
+
+			if (!config->IsA("RLConfig"))
+			{
+				LogMessage(LOG_ERROR, "Invalid agent configuration.", "DiScenFw");
+				return;
+			}
+
+			QLConfiguration = std::static_pointer_cast<RLConfig>(config);
+			QLConfiguration->CheckParameters();
+		}
+
+
+		float LinearAgent::GetStateActionValue(StateRef state, ActionRef action) const
+		{
+			std::vector<size_t> stateFeatures;
+			GetStateFeatures(state, stateFeatures);
+			return ComputeValue(stateFeatures, action);
+		}
+
+
+		void LinearAgent::GetStateFeatures(StateRef state, std::vector<size_t>& features) const
+		{
+			features.clear();
+			std::hash<std::string> hashString;
+
+			// bias feature (one for each action)
+			features.push_back(hashString("#"));
+			if (!state)
+			{
+				return;
+			}
+
+			for (const auto& entityItem : state->GetEntityStates())
+			{
+				const std::string& entityId = entityItem.first;
+				const std::shared_ptr<EntityState>& entityState = entityItem.second;
+				if (!entityState)
+				{
+					continue;
+				}
+				const std::shared_ptr<EntityStateType> entityType = entityState->GetType();
+				for (const auto& propertyItem : entityState->GetPropertyValues())
+				{
+					const std::string propertyKey = entityId + "." + propertyItem.first;
+					const std::string& value = propertyItem.second;
+
+					// one-hot encoding of the index among the possible values
+					if (entityType)
+					{
+						const auto& possibleValues = entityType->GetPossiblePropertyValues();
+						const auto& possibleIt = possibleValues.find(propertyItem.first);
+						if (possibleIt != possibleValues.cend())
+						{
+							const auto& valueIt = std::find(possibleIt->second.cbegin(), possibleIt->second.cend(), value);
+							if (valueIt != possibleIt->second.cend())
+							{
+								features.push_back(hashString(propertyKey + "#" + std::to_string(valueIt - possibleIt->second.cbegin())));
+								continue;
+							}
+						}
+					}
+
+					// tile coding of numeric values: overlapping tilings, each shifted by a fraction of a tile
+					// (See Sutton&Barto 2020, p.217)
+					double number = 0.0;
+					if (ParseNumber(value, number))
+					{
+						const double scaled = number / (double)TileWidth;
+						for (int t = 0; t < Tilings; t++)
+						{
+							const long long tile = (long long)std::floor(scaled + (double)t / (double)Tilings);
+							features.push_back(hashString(propertyKey + "~" + std::to_string(t) + ":" + std::to_string(tile)));
+						}
+						continue;
+					}
+
+					features.push_back(hashString(propertyKey + "=" + value));
+				}
+				for (const auto& relationshipItem : entityState->GetRelationships())
+				{
+					features.push_back(hashString(entityId + "." + relationshipItem.first + ">"
+						+ relationshipItem.second.EntityId + "." + relationshipItem.second.LinkId));
+				}
+			}
+			for (const auto& featureItem : state->GetFeatures())
+			{
+				features.push_back(hashString("$" + featureItem.first + "=" + featureItem.second));
+			}
+		}
+
+
+		void LinearAgent::SetMaxRecordedStates(int maxRecordedStates)
+		{
+			MaxRecordedStates = (size_t)std::max(1, maxRecordedStates);
+			while (RecordedStates.size() > MaxRecordedStates)
+			{
+				StatePossibleActions.erase(RecordedStates.front());
+				RecordedStates.pop_front();
+			}
+		}
+
+
+		void LinearAgent::MarkReachableStates(StateMarkSet& reachableStates) const
+		{
+			for (const auto& recordPair : StatePossibleActions)
+			{
+				reachableStates.insert(recordPair.first.get());
+			}
+		}
+
+
+		void LinearAgent::RecordPossibleActions(StateRef state, const std::vector<ActionRef>& possibleActions)
+		{
+			auto recordIt = StatePossibleActions.find(state);
+			if (recordIt != StatePossibleActions.end())
+			{
+				recordIt->second = possibleActions;
+				return;
+			}
+			if (RecordedStates.size() >= MaxRecordedStates)
+			{
+				StatePossibleActions.erase(RecordedStates.front());
+				RecordedStates.pop_front();
+			}
+			StatePossibleActions[state] = possibleActions;
+			RecordedStates.push_back(state);
+		}
+
+
+		size_t LinearAgent::GetActionHash(const ActionRef& action) const
+		{
+			// actions are stored once in the environment model
+			auto hashIt = ActionHashes.find(action);
+			if (hashIt == ActionHashes.end())
+			{
+				if (ActionHashes.size() >= MaxCachedActionHashes)
+				{
+					ActionHashes.clear();
+				}
+				hashIt = ActionHashes.insert(std::make_pair(action,
+					std::hash<std::string>()(action ? action->ToString() : std::string()))).first;
+			}
+			return hashIt->second;
+		}
+
+
+		size_t LinearAgent::GetWeightIndex(size_t stateFeature, size_t actionHash) const
+		{
+			size_t hash = stateFeature;
+			hash ^= actionHash + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+			return hash % Weights.size();
+		}
+
+
+		float LinearAgent::ComputeValue(const std::vector<size_t>& stateFeatures, const ActionRef& action) const
+		{
+			const size_t actionHash = GetActionHash(action);
+			float value = QLConfiguration->InitialValue;
+			for (size_t feature : stateFeatures)
+			{
+				value += Weights[GetWeightIndex(feature, actionHash)];
+			}
+			return value;
+		}
+
+
+		float LinearAgent::ComputeMaxValue(StateRef state) const
+		{
+			const auto& recordIt = StatePossibleActions.find(state);
+			if (recordIt == StatePossibleActions.cend() || recordIt->second.empty())
+			{
+				return QLConfiguration->InitialValue;
+			}
+			std::vector<size_t> stateFeatures;
+			GetStateFeatures(state, stateFeatures);
+			float maxValue = 0.0f;
+			bool found = false;
+			for (const ActionRef& action : recordIt->second)
+			{
+				const float value = ComputeValue(stateFeatures, action);
+				if (!found || value > maxValue)
+				{
+					maxValue = value;
+					found = true;
+				}
+			}
+			return maxValue;
+		}
+
+
+		void LinearAgent::LearnTransition(
+			const Transition& transition,
+			const std::shared_ptr<Experience> experience
+			)
+		{
+			// Semi-gradient Q-learning with binary features: the gradient is 1 for the active features
+			// (See Sutton&Barto 2020, p.244)
+
+			EnvironmentStateInfo stateInfo = experience->GetRole()->GetStateInfo(transition.EndState);
+			const float R = (float)stateInfo.Reward;
+
+			std::vector<size_t> features;
+			GetStateFeatures(transition.StartState, features);
+			const float qVal1 = ComputeValue(features, transition.ActionTaken);
+
+			float target = R;
+			if (!stateInfo.IsTerminal())
+			{
+				// the next state is evaluated with the actions that were possible in it
+				target += QLConfiguration->DiscountRate * ComputeMaxValue(transition.EndState);
+			}
+
+			// the step size is divided among the active features
+			const float alpha = QLConfiguration->FixedStepSize / (float)features.size();
+			const float delta = alpha * (target - qVal1);
+			const size_t actionHash = GetActionHash(transition.ActionTaken);
+			for (size_t feature : features)
+			{
+				Weights[GetWeightIndex(feature, actionHash)] += delta;
+			}
+		}
+
+	} // namespace xp
+}
@@ -0,0 +1,440 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/RL/MctsAgent.h>
+
+#include <discenfw/xp/Experience.h>
+#include <discenfw/xp/Condition.h>
+
+#include <discenfw/util/Rand.h>
+#include <discenfw/util/MessageLog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+
+namespace discenfw
+{
+	namespace xp
+	{
+
+		MctsAgent::MctsAgent(
+			std::shared_ptr<ICyberSystem> simulator,
+			const std::vector<std::string>& otherRoles
+			)
+			: Simulator(simulator)
+			, OtherRoles(otherRoles)
+		{
+			Configuration = std::make_shared<MctsConfig>();
+		}
+
+
+		MctsAgent::~MctsAgent()
+		{
+		}
+
+
+		void MctsAgent::Reset()
+		{
+			Root.reset();
+			RootPath.clear();
+			RewardScale = 1.0;
+			TakenActionCount = 0;
+			LastIterationCount = 0;
+			LastReusedVisitCount = 0;
+		}
+
+
+		int MctsAgent::ChooseAction(
+			const std::shared_ptr<Experience> experience,
+			const std::vector<ActionRef>& possibleActions,
+			StateRef envState,
+			bool /*updatePolicy*/
+			)
+		{
+			if (possibleActions.empty())
+			{
+				return -1;
+			}
+			if (!Simulator)
+			{
+				LogMessage(LOG_ERROR, "Simulator not defined, cannot plan.", "DiScenFw");
+				return RandIndex((int)possibleActions.size());
+			}
+
+			CurrentExperience = experience;
+			Roles.assign(1, experience->GetRoleName());
+			Roles.insert(Roles.end(), OtherRoles.cbegin(), OtherRoles.cend());
+
+			if (!UpdateRoot(envState, possibleActions))
+			{
+				LogMessage(LOG_WARNING, "Current state not reached by the simulator, choosing a random action.", "DiScenFw");
+				Root.reset();
+				RootPath.clear();
+				return RandIndex((int)possibleActions.size());
+			}
+
+			// run simulations within the budget
+			const auto deadline = std::chrono::steady_clock::now()
+				+ std::chrono::milliseconds(Configuration->TimeBudgetMs);
+			LastIterationCount = 0;
+			while (LastIterationCount < Configuration->IterationBudget)
+			{
+				RunIteration();
+				LastIterationCount++;
+				if (Configuration->TimeBudgetMs > 0 && std::chrono::steady_clock::now() >= deadline)
+				{
+					break;
+				}
+			}
+
+			// choose the most visited action
+			const Node* bestChild = nullptr;
+			for (const auto& child : Root->Children)
+			{
+				if (!bestChild || child->Visits > bestChild->Visits)
+				{
+					bestChild = child.get();
+				}
+			}
+			TakenActionCount++;
+			if (!bestChild)
+			{
+				return RandIndex((int)possibleActions.size());
+			}
+			const auto& actionIt = std::find(possibleActions.cbegin(), possibleActions.cend(), bestChild->Action);
+			return (int)(actionIt - possibleActions.cbegin());
+		}
+
+
+		void MctsAgent::SetConfiguration(const std::shared_ptr<IAgentConfiguration> config)
+		{
+			if (!config)
+			{
+				LogMessage(LOG_ERROR, "Null agent configuration.", "DiScenFw");
+				return;
+			}
+
+			if (!config->IsA("MctsConfig"))
+			{
+				LogMessage(LOG_WARNING, std::string("Configuration ") + config->GetClassName() + " ignored by MctsAgent.", "DiScenFw");
+				return;
+			}
+
+			Configuration = std::static_pointer_cast<MctsConfig>(config);
+			Configuration->CheckParameters();
+		}
+
+
+		void MctsAgent::MarkReachableStates(StateMarkSet& reachableStates) const
+		{
+			std::vector<const Node*> nodes;
+			if (Root)
+			{
+				nodes.push_back(Root.get());
+			}
+			while (!nodes.empty())
+			{
+				const Node* node = nodes.back();
+				nodes.pop_back();
+				reachableStates.insert(node->State.get());
+				for (const auto& child : node->Children)
+				{
+					nodes.push_back(child.get());
+				}
+			}
+		}
+
+
+		bool MctsAgent::UpdateRoot(StateRef envState, const std::vector<ActionRef>& possibleActions)
+		{
+			// look for the current state among the nodes reachable by one move of each role
+			Node* found = nullptr;
+			if (Root && Configuration->ReuseTree)
+			{
+				std::deque< std::pair<Node*, int> > queue;
+				queue.push_back(std::make_pair(Root.get(), 0));
+				while (!queue.empty() && !found)
+				{
+					Node* node = queue.front().first;
+					const int depth = queue.front().second;
+					queue.pop_front();
+					if (node->State == envState)
+					{
+						found = node;
+					}
+					else if (depth < (int)Roles.size())
+					{
+						for (const auto& child : node->Children)
+						{
+							queue.push_back(std::make_pair(child.get(), depth + 1));
+						}
+					}
+				}
+			}
+
+			if (found)
+			{
+				std::vector<ActionRef> path;
+				for (const Node* node = found; node != Root.get(); node = node->Parent)
+				{
+					path.push_back(node->Action);
+				}
+				RootPath.insert(RootPath.end(), path.crbegin(), path.crend());
+				if (found != Root.get())
+				{
+					// detach the subtree, the rest of the tree is released
+					auto& siblings = found->Parent->Children;
+					auto foundIt = std::find_if(siblings.begin(), siblings.end(),
+						[found](const std::unique_ptr<Node>& child) { return child.get() == found; });
+					std::unique_ptr<Node> newRoot = std::move(*foundIt);
+					Root = std::move(newRoot);
+					Root->Parent = nullptr;
+					Root->Action = nullptr;
+				}
+			}
+			else
+			{
+				Root.reset();
+				RootPath.clear();
+				if (!RestoreRoot())
+				{
+					return false;
+				}
+				StateRef state = GetSimulatorState();
+				if (state != envState)
+				{
+					return false;
+				}
+				Root.reset(new Node);
+				InitNode(*Root, state);
+			}
+
+			// only the given actions can be chosen from the root
+			Root->Terminal = false;
+			Root->RoleIndex = 0;
+			auto isPossible = [&possibleActions](const ActionRef& action)
+			{
+				return std::find(possibleActions.cbegin(), possibleActions.cend(), action) != possibleActions.cend();
+			};
+			auto& children = Root->Children;
+			children.erase(std::remove_if(children.begin(), children.end(),
+				[&isPossible](const std::unique_ptr<Node>& child) { return !isPossible(child->Action); }),
+				children.end());
+			Root->UntriedActions.clear();
+			for (const ActionRef& action : possibleActions)
+			{
+				const bool expanded = std::find_if(children.cbegin(), children.cend(),
+					[&action](const std::unique_ptr<Node>& child) { return child->Action == action; }) != children.cend();
+				if (!expanded)
+				{
+					Root->UntriedActions.push_back(action);
+				}
+			}
+			LastReusedVisitCount = Root->Visits;
+			return true;
+		}
+
+
+		bool MctsAgent::RestoreRoot()
+		{
+			if (!Simulator->IsInitialized())
+			{
+				Simulator->Initialize(true);
+				Simulator->InitRoles();
+			}
+			Simulator->ResetSystem();
+			Simulator->Initialize();
+			for (const ActionRef& action : RootPath)
+			{
+				if (!Simulator->ExecuteAction(*action))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+
+		StateRef MctsAgent::GetSimulatorState() const
+		{
+			return CurrentExperience->GetStoredState(Simulator->InterpretSystemState());
+		}
+
+
+		void MctsAgent::InitNode(Node& node, StateRef state)
+		{
+			node.State = state;
+			node.Terminal = IsTerminalState(state);
+			if (!node.Terminal)
+			{
+				node.RoleIndex = GetActingRole(false, node.UntriedActions);
+				node.Terminal = node.RoleIndex < 0;
+			}
+		}
+
+
+		EnvironmentStateInfo MctsAgent::EvaluateSimulatorState() const
+		{
+			// a private copy is evaluated, thus rollouts neither lock nor grow the environment model
+			StateRef state = Simulator->InterpretSystemState().Clone();
+			bool systemFailed = false;
+			if (!CurrentExperience->SystemFailureIgnored)
+			{
+				const Condition& failureCondition = Simulator->GetFailureCondition();
+				systemFailed = failureCondition.Defined() && failureCondition.Evaluate(state);
+			}
+			return CurrentExperience->GetRole()->EvaluateStateInfo(state, systemFailed);
+		}
+
+
+		double MctsAgent::Evaluate(StateRef state)
+		{
+			return Evaluate(CurrentExperience->GetRole()->GetStateInfo(state));
+		}
+
+
+		double MctsAgent::Evaluate(const EnvironmentStateInfo& stateInfo)
+		{
+			const double reward = (double)stateInfo.Reward;
+			RewardScale = std::max(RewardScale, std::fabs(reward));
+			return reward;
+		}
+
+
+		bool MctsAgent::IsTerminalState(StateRef state) const
+		{
+			// same as CyberSystemAssistant::GetStateInfo()
+			const std::shared_ptr<RoleInfo> role = CurrentExperience->GetRole();
+			if (!CurrentExperience->SystemFailureIgnored)
+			{
+				const Condition& failureCondition = Simulator->GetFailureCondition();
+				if (failureCondition.Defined() && failureCondition.Evaluate(state))
+				{
+					role->OverrideStateResult(state, ActionResult::FAILED);
+				}
+			}
+			return role->GetStateInfo(state).IsCompleted();
+		}
+
+
+		int MctsAgent::GetActingRole(bool smartSelection, std::vector<ActionRef>& actions) const
+		{
+			for (int i = 0; i < (int)Roles.size(); i++)
+			{
+				actions = Simulator->GetAvailableActions(Roles[i], smartSelection);
+				if (!actions.empty())
+				{
+					return i;
+				}
+			}
+			return -1;
+		}
+
+
+		void MctsAgent::RunIteration()
+		{
+			if (!RestoreRoot())
+			{
+				return;
+			}
+
+			// selection
+			Node* node = Root.get();
+			while (!node->Terminal && node->UntriedActions.empty() && !node->Children.empty())
+			{
+				node = SelectChild(*node);
+				if (!Simulator->ExecuteAction(*node->Action))
+				{
+					return;
+				}
+			}
+
+			// expansion
+			if (!node->Terminal && !node->UntriedActions.empty())
+			{
+				const int actionIndex = RandIndex((int)node->UntriedActions.size());
+				const ActionRef action = node->UntriedActions[actionIndex];
+				node->UntriedActions.erase(node->UntriedActions.begin() + actionIndex);
+				if (!Simulator->ExecuteAction(*action))
+				{
+					// the action was denied, it will not be tried again
+					return;
+				}
+				std::unique_ptr<Node> child(new Node);
+				child->Parent = node;
+				child->Action = action;
+				InitNode(*child, GetSimulatorState());
+				node->Children.push_back(std::move(child));
+				node = node->Children.back().get();
+			}
+
+			// rollout and backup
+			const double value = node->Terminal ? Evaluate(node->State) : Rollout(*node);
+			for (; node != nullptr; node = node->Parent)
+			{
+				node->Visits++;
+				node->ValueSum += value;
+			}
+		}
+
+
+		MctsAgent::Node* MctsAgent::SelectChild(const Node& node) const
+		{
+			// UCB1 applied to trees (UCT), other roles minimize the agent value
+			const double sign = node.RoleIndex == 0 ? 1.0 : -1.0;
+			const double logVisits = std::log((double)std::max(1, node.Visits));
+			Node* bestChild = nullptr;
+			double bestScore = 0.0;
+			for (const auto& child : node.Children)
+			{
+				if (child->Visits == 0)
+				{
+					return child.get();
+				}
+				const double meanValue = child->ValueSum / (double)child->Visits / RewardScale;
+				const double score = sign * meanValue
+					+ Configuration->ExplorationConstant * std::sqrt(logVisits / (double)child->Visits);
+				if (!bestChild || score > bestScore)
+				{
+					bestChild = child.get();
+					bestScore = score;
+				}
+			}
+			return bestChild;
+		}
+
+
+		double MctsAgent::Rollout(const Node& node)
+		{
+			// random actions until the episode ends, the last state is evaluated
+			EnvironmentStateInfo stateInfo = CurrentExperience->GetRole()->GetStateInfo(node.State);
+			std::vector<ActionRef> actions;
+			for (int depth = 0; depth < Configuration->MaxRolloutDepth; depth++)
+			{
+				if (GetActingRole(Configuration->SmartRollouts, actions) < 0)
+				{
+					break;
+				}
+				if (!Simulator->ExecuteAction(*actions[RandIndex((int)actions.size())]))
+				{
+					break;
+				}
+				stateInfo = EvaluateSimulatorState();
+				if (stateInfo.IsCompleted())
+				{
+					break;
+				}
+			}
+			return Evaluate(stateInfo);
+		}
+
+	} // namespace xp
+}
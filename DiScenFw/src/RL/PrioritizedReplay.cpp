@@ -0,0 +1,141 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/RL/PrioritizedReplay.h>
+
+#include <discenfw/util/Rand.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace discenfw
+{
+	namespace xp
+	{
+
+		PrioritizedReplay::PrioritizedReplay(int capacity, float priorityExponent)
+		{
+			Configure(capacity, priorityExponent);
+		}
+
+
+		PrioritizedReplay::~PrioritizedReplay()
+		{
+		}
+
+
+		void PrioritizedReplay::Configure(int capacity, float priorityExponent)
+		{
+			capacity = std::max(1, capacity);
+			priorityExponent = std::max(0.0f, priorityExponent);
+			if (capacity == Capacity && priorityExponent == PriorityExponent)
+			{
+				return;
+			}
+			Capacity = capacity;
+			PriorityExponent = priorityExponent;
+			LeafCount = 1;
+			while (LeafCount < Capacity)
+			{
+				LeafCount *= 2;
+			}
+			Clear();
+		}
+
+
+		int PrioritizedReplay::Add(const Transition& transition, float priority)
+		{
+			auto indexIt = TransitionIndex.find(transition);
+			if (indexIt != TransitionIndex.end())
+			{
+				UpdatePriority(indexIt->second, priority);
+				return indexIt->second;
+			}
+
+			int index = (int)Transitions.size();
+			if (index < Capacity)
+			{
+				Transitions.push_back(transition);
+			}
+			else
+			{
+				// replace the oldest transition
+				index = NextReplaced;
+				NextReplaced = (NextReplaced + 1) % Capacity;
+				TransitionIndex.erase(Transitions[index]);
+				Transitions[index] = transition;
+			}
+			TransitionIndex[transition] = index;
+			UpdatePriority(index, priority);
+			return index;
+		}
+
+
+		bool PrioritizedReplay::Sample(int& index) const
+		{
+			const double total = GetTotalPriority();
+			if (total <= 0.0)
+			{
+				return false;
+			}
+
+			// descend the sum tree from the root to the leaf containing the random value
+			double value = (double)RandFloat(0.0f, 1.0f) * total;
+			int node = 1;
+			while (node < LeafCount)
+			{
+				const int left = 2 * node;
+				if (value < Tree[left] || Tree[left + 1] <= 0.0)
+				{
+					node = left;
+				}
+				else
+				{
+					value -= Tree[left];
+					node = left + 1;
+				}
+			}
+			index = node - LeafCount;
+			return index < (int)Transitions.size() && Tree[node] > 0.0;
+		}
+
+
+		void PrioritizedReplay::UpdatePriority(int index, float priority)
+		{
+			if (index < 0 || index >= (int)Transitions.size())
+			{
+				return;
+			}
+			const double p = std::fabs((double)priority);
+			SetLeaf(index, PriorityExponent == 1.0f ? p : std::pow(p, (double)PriorityExponent));
+		}
+
+
+		void PrioritizedReplay::Clear()
+		{
+			Tree.assign(2 * LeafCount, 0.0);
+			Transitions.clear();
+			TransitionIndex.clear();
+			NextReplaced = 0;
+		}
+
+
+		void PrioritizedReplay::SetLeaf(int index, double value)
+		{
+			// recompute the sums (instead of adding the difference) to avoid accumulating errors
+			int node = index + LeafCount;
+			Tree[node] = value;
+			for (node /= 2; node > 0; node /= 2)
+			{
+				Tree[node] = Tree[2 * node] + Tree[2 * node + 1];
+			}
+		}
+
+	} // namespace xp
+}
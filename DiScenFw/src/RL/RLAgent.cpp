@@ -38,6 +38,8 @@ namespace discenfw
 		{
 			Q.clear();
 			StateVisitCount.clear();
+			Replay.Clear();
+			Traces.clear();
 			RandomActionCount = 0;
 			TakenActionCount = 0;
 		}
@@ -189,7 +191,12 @@ namespace discenfw
 
 			const Transition& lastTransition = transitionSequence.back();
 
-			if (lastActionResult == ActionResult::SUCCEEDED)
+			if (GetRLConfig()->TraceDecay > 0.0f && !SharedQ)
+			{
+				// Eligibility traces propagate the updates of both successes and failures
+				TraceLearn(experience, transitionSequence, lastActionResult);
+			}
+			else if (lastActionResult == ActionResult::SUCCEEDED)
 			{
 				// A successful action sequence was found,
 				// backup until the initial state (all the action sequence led to the success)
@@ -202,8 +209,10 @@ namespace discenfw
 				// (the previous action that led to the current state)
 
 				// Learn from the last transition
-				QLearn(lastTransition, experience);
+				LearnTransition(lastTransition, experience);
 			}
+
+			Plan(experience);
 		}
 
 
@@ -240,6 +249,10 @@ namespace discenfw
 
 		bool RLAgent::GetStateActionValue(StateRef state, ActionRef action, float& value) const
 		{
+			if (SharedQ)
+			{
+				return SharedQ->GetValue(state, action, value);
+			}
 			const auto& Qs = Q.find(state);
 			if (Qs == Q.cend())
 			{
@@ -258,6 +271,53 @@ namespace discenfw
 		}
 
 
+		void RLAgent::GetStateActionValues(std::map<StateActionRef, float>& stateActionValues) const
+		{
+			if (SharedQ)
+			{
+				SharedQ->GetSnapshot(stateActionValues);
+				return;
+			}
+			for (const auto& stateElem : Q)
+			{
+				for (const auto& actionValue : stateElem.second.ActionValueMap)
+				{
+					stateActionValues[StateActionRef(stateElem.first, actionValue.first)] = actionValue.second.Value;
+				}
+			}
+		}
+
+
+		void RLAgent::MarkReachableStates(StateMarkSet& reachableStates) const
+		{
+			if (SharedQ)
+			{
+				SharedQ->MarkReachableStates(reachableStates);
+			}
+			for (const auto& stateElem : Q)
+			{
+				reachableStates.insert(stateElem.first.get());
+				for (const auto& visitCount : stateElem.second.StateVisitCountMap)
+				{
+					reachableStates.insert(visitCount.first.get());
+				}
+			}
+			for (int i = 0; i < Replay.GetSize(); i++)
+			{
+				const Transition& transition = Replay.GetTransition(i);
+				reachableStates.insert(transition.StartState.get());
+				reachableStates.insert(transition.EndState.get());
+			}
+			for (const auto& trace : Traces)
+			{
+				reachableStates.insert(trace.first.State.get());
+			}
+			for (const auto& visitCount : StateVisitCount)
+			{
+				reachableStates.insert(visitCount.first.get());
+			}
+		}
+
 
 		void RLAgent::QLearn(
 			const Transition& transition,
@@ -267,6 +327,12 @@ namespace discenfw
 			// Using Q-Learning reinforcement learning algorithm(see RLAgent).
 			// (See Sutton&Barto 2020, p.131)
 
+			if (SharedQ)
+			{
+				SharedQLearn(transition, experience);
+				return;
+			}
+
 			const StateRef prevState = transition.StartState;
 			const ActionRef action = transition.ActionTaken;
 			const StateRef newEnvState = transition.EndState;
@@ -281,9 +347,6 @@ namespace discenfw
 			// (state-action value,number of selections)
 			auto& Q1 = Q[prevState].ActionValueMap[action];
 
-			// state-action value for the given state-action
-			float& qVal1 = Q1.Value;
-
 			// number of selections of the given action from the given state
 			int& updateCount = Q1.Count;
 
@@ -291,7 +354,8 @@ namespace discenfw
 
 			if (stateInfo.IsTerminal())
 			{
-				qVal1 = R;
+				LastTDError = R - Q1.Value;
+				SetActionValue(prevState, action, R);
 			}
 			else
 			{
@@ -299,63 +363,27 @@ namespace discenfw
 				// (See Sutton&Barto 2020, p.34, p.131)
 				if (updateCount == 1)
 				{
-					qVal1 = GetRLConfig()->InitialValue;
+					float initialValue = GetRLConfig()->InitialValue;
 					if (experience->StateActionValueDefined(stateAction))
 					{
-						qVal1 = experience->GetStateActionValue(stateAction);
+						initialValue = experience->GetStateActionValue(stateAction);
 					}
+					SetActionValue(prevState, action, initialValue);
 				}
 
+				// state-action value for the given state-action
+				float qVal1 = Q1.Value;
+
 				// find the maximum state-action value
 
 				// estimate for the following state-action value
 				float qVal2 = GetRLConfig()->InitialValue;
 
-				if (Q.find(newEnvState) != Q.end())
+				// get the maximum state-action value (cached, see SetActionValue())
+				const auto& Q2It = Q.find(newEnvState);
+				if (Q2It != Q.end() && Q2It->second.MaxValueDefined)
 				{
-					// Q for (state,{action,(value,n_selections)})
-					const auto& Q2 = Q.at(newEnvState);
-					if (!Q2.StateVisitCountMap.empty())
-					{
-						// Estimate the probability to go into a state from the current one for external causes.
-						// TODO: implement a MCTS algorithm (Sutton&Barto 2020, p.185)
-
-						// total number of transitions
-						int totCount = 0;
-						for (auto& countPair : Q2.StateVisitCountMap)
-						{
-							totCount += countPair.second;
-						}
-
-						// Compute the value according to the observed transitions from the new state
-						// to get an approximated distribution model.
-
-						qVal2 = 0; // initialize accumulation (at least one value will be accumulated)
-						for (auto& countPair : Q2.StateVisitCountMap)
-						{
-							EnvironmentStateInfo stateInfo = role->GetStateInfo(countPair.first);
-
-							// estimate reward for the new state
-							float r2 = 0;
-							if(stateInfo.IsTerminal())
-							{
-								r2 = (float)stateInfo.Reward;
-							}
-							else
-							{
-								// get the maximum state-action value (initial value for new states)
-								r2 = GetMaxValue(countPair.first);
-							}
-							float prob = (float)countPair.second / (float)totCount;
-							qVal2 += r2 * prob;
-						}
-					}
-					else if (!Q2.ActionValueMap.empty())
-					{
-						// get the maximum state-action value (initial value for new states)
-						qVal2 = GetMaxValue(newEnvState);
-					}
-
+					qVal2 = Q2It->second.MaxValue;
 				}
 
 				// Step-size parameter (learning rate) decreased at each update: sample-average method
@@ -378,12 +406,185 @@ namespace discenfw
 
 				// Approximation of Bellman equation using Q-learning
 				// (See Sutton&Barto 2020, p.131)
+				LastTDError = R + gamma * qVal2 - qVal1;
 				qVal1 = (1.0f - alpha) * qVal1 + alpha * (R + gamma * qVal2);
+				SetActionValue(prevState, action, qVal1);
+				experience->SetStateActionValue(stateAction, qVal1);
+			}
+		}
+
+
+		void RLAgent::SharedQLearn(
+			const Transition& transition,
+			const std::shared_ptr<Experience> experience
+			)
+		{
+			// Same as QLearn(), but the update is done atomically on the shared table
+			// and the next state value is estimated with the maximum state-action value.
+
+			const StateRef prevState = transition.StartState;
+			const ActionRef action = transition.ActionTaken;
+			const StateRef newEnvState = transition.EndState;
+
+			EnvironmentStateInfo stateInfo = experience->GetRole()->GetStateInfo(newEnvState);
+			StateActionRef stateAction(prevState, action);
+
+			const float R = (float)stateInfo.Reward;
+			const bool terminal = stateInfo.IsTerminal();
+
+			float initialValue = GetRLConfig()->InitialValue;
+			if (experience->StateActionValueDefined(stateAction))
+			{
+				initialValue = experience->GetStateActionValue(stateAction);
+			}
+
+			float qVal2 = GetRLConfig()->InitialValue;
+			if (!terminal)
+			{
+				SharedQ->GetMaxValue(newEnvState, qVal2);
+			}
+
+			const bool sampleAverage = GetRLConfig()->SampleAverage;
+			const float fixedStepSize = GetRLConfig()->FixedStepSize;
+			const float gamma = GetRLConfig()->DiscountRate;
+
+			float tdError = 0.0f;
+			float qVal1 = SharedQ->UpdateValue(prevState, action, initialValue,
+				[=, &tdError](float value, int updateCount)
+				{
+					if (terminal)
+					{
+						tdError = R - value;
+						return R;
+					}
+					tdError = R + gamma * qVal2 - value;
+					const float alpha = sampleAverage ? 1.0f / (float)updateCount : fixedStepSize;
+					return (1.0f - alpha) * value + alpha * (R + gamma * qVal2);
+				});
+			LastTDError = tdError;
+			if (!terminal)
+			{
 				experience->SetStateActionValue(stateAction, qVal1);
 			}
 		}
 
 
+		void RLAgent::LearnTransition(
+			const Transition& transition,
+			const std::shared_ptr<Experience> experience
+			)
+		{
+			QLearn(transition, experience);
+			const std::shared_ptr<RLConfig> config = GetRLConfig();
+			if (config->PlanningSteps > 0)
+			{
+				Replay.Configure(config->ReplayCapacity, config->PriorityExponent);
+				float priority = fabs(LastTDError);
+				Replay.Add(transition, priority < config->PriorityThreshold ? 0.0f : priority);
+			}
+		}
+
+
+		void RLAgent::Plan(const std::shared_ptr<Experience> experience)
+		{
+			// Dyna-Q: replay stored transitions as a model of the environment,
+			// transitions with greater TD error are sampled more frequently
+			// (See Sutton&Barto 2020, p.164, p.170)
+			const std::shared_ptr<RLConfig> config = GetRLConfig();
+			for (int i = 0; i < config->PlanningSteps; i++)
+			{
+				int index = -1;
+				if (!Replay.Sample(index))
+				{
+					break;
+				}
+				const Transition transition = Replay.GetTransition(index);
+				QLearn(transition, experience);
+				float priority = fabs(LastTDError);
+				Replay.UpdatePriority(index, priority < config->PriorityThreshold ? 0.0f : priority);
+			}
+		}
+
+
+		void RLAgent::TraceLearn(
+			const std::shared_ptr<Experience> experience,
+			const std::vector<Transition>& transitionSequence,
+			ActionResult lastActionResult
+			)
+		{
+			// Watkins's Q(lambda) with replacing traces (traces are kept if CutTracesOnExploration is false)
+			// (See Sutton&Barto 2020, p.312)
+
+			const std::shared_ptr<RLConfig> config = GetRLConfig();
+			const Transition& transition = transitionSequence.back();
+			const StateActionRef stateAction(transition.StartState, transition.ActionTaken);
+
+			if (transitionSequence.size() == 1)
+			{
+				// a new episode was started
+				Traces.clear();
+			}
+
+			// check if the action was greedy before updating its value
+			bool greedyAction = true;
+			const auto& stateIt = Q.find(transition.StartState);
+			if (stateIt != Q.cend() && stateIt->second.MaxValueDefined)
+			{
+				float value = 0.0f;
+				if (!GetStateActionValue(transition.StartState, transition.ActionTaken, value))
+				{
+					value = config->InitialValue;
+				}
+				greedyAction = value >= stateIt->second.MaxValue;
+			}
+
+			// decay the traces in place, discarding the negligible ones
+			if (config->CutTracesOnExploration && !greedyAction)
+			{
+				Traces.clear();
+			}
+			else
+			{
+				const float decay = config->DiscountRate * config->TraceDecay;
+				for (auto traceIt = Traces.begin(); traceIt != Traces.end(); )
+				{
+					traceIt->second *= decay;
+					if (traceIt->second < config->TraceThreshold || traceIt->first == stateAction)
+					{
+						traceIt = Traces.erase(traceIt);
+					}
+					else
+					{
+						++traceIt;
+					}
+				}
+			}
+
+			// the last state-action is updated with a full trace
+			LearnTransition(transition, experience);
+			const float tdError = LastTDError;
+
+			for (const auto& trace : Traces)
+			{
+				ValueInfo& valueInfo = Q[trace.first.State].ActionValueMap[trace.first.Action];
+				const float alpha = config->SampleAverage && valueInfo.Count > 0
+					? 1.0f / (float)valueInfo.Count : config->FixedStepSize;
+				const float value = valueInfo.Value + alpha * tdError * trace.second;
+				SetActionValue(trace.first.State, trace.first.Action, value);
+				experience->SetStateActionValue(trace.first, value);
+			}
+
+			if (lastActionResult == ActionResult::IN_PROGRESS)
+			{
+				Traces[stateAction] = 1.0f;
+			}
+			else
+			{
+				Traces.clear();
+			}
+		}
+
+
 		void RLAgent::BackUp(
 			const std::shared_ptr<Experience> experience,
 			const std::vector<Transition>& transitionSequence,
@@ -407,44 +608,48 @@ namespace discenfw
 			for (int i = t - 1; i >= first; i--)
 			{
 				const Transition& transition = transitionSequence[i];
-				QLearn(transition, experience);
+				LearnTransition(transition, experience);
 			}
 		}
 
 
 		float RLAgent::GetMaxValue(StateRef state) const
 		{
-				// maximum state-action value (initial value for new states)
-				float maxQ2 = GetRLConfig()->InitialValue;
+			// maximum state-action value (initial value for new states)
+			const auto& Q2 = Q.find(state);
+			if (Q2 != Q.end() && Q2->second.MaxValueDefined)
+			{
+				return Q2->second.MaxValue;
+			}
+			return GetRLConfig()->InitialValue;
+		}
 
-				// the given state was already stored?
-				bool q2Found = (Q.find(state) != Q.end());
 
-				if (q2Found)
-				{
-					bool valueFound = false; // keep track of a previous value found
+		void RLAgent::SetActionValue(StateRef state, ActionRef action, float value)
+		{
+			QElem& qElem = Q[state];
 
-					// Q for (state,{action,(value,n_selections)})
-					const auto& Q2 = Q.at(state);
-					if (!Q2.ActionValueMap.empty())
+			qElem.ActionValueMap[action].Value = value;
+
+			if (!qElem.MaxValueDefined || value >= qElem.MaxValue)
+			{
+				qElem.MaxValue = value;
+				qElem.MaxAction = action;
+				qElem.MaxValueDefined = true;
+			}
+			else if (action == qElem.MaxAction)
+			{
+				// the maximum value decreased, search the new maximum
+				qElem.MaxValue = value;
+				for (const auto& actionValuePair : qElem.ActionValueMap)
+				{
+					if (actionValuePair.second.Value > qElem.MaxValue)
 					{
-						for (const auto& actionValuePair : Q2.ActionValueMap)
-						{
-							// state-action value for n-th action
-							const float& actionValue = actionValuePair.second.Value;
-
-							// if it is the first found or this is greater than
-							// the previous value found...
-							if (!valueFound || actionValue > maxQ2)
-							{
-								// ...store this value
-								maxQ2 = actionValue;
-								valueFound = true;
-							}
-						}
+						qElem.MaxValue = actionValuePair.second.Value;
+						qElem.MaxAction = actionValuePair.first;
 					}
 				}
-			return maxQ2;
+			}
 		}
 
 	} // namespace xp
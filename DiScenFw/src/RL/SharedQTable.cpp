@@ -0,0 +1,173 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/RL/SharedQTable.h>
+
+#include <algorithm>
+
+namespace discenfw
+{
+	namespace xp
+	{
+
+		SharedQTable::SharedQTable(int shardCount)
+		{
+			shardCount = std::max(1, shardCount);
+			for (int i = 0; i < shardCount; i++)
+			{
+				Shards.push_back(std::unique_ptr<Shard>(new Shard));
+			}
+		}
+
+
+		SharedQTable::~SharedQTable()
+		{
+		}
+
+
+		bool SharedQTable::GetValue(StateRef state, ActionRef action, float& value) const
+		{
+			const Shard& shard = GetShard(state);
+			std::lock_guard<std::mutex> lock(shard.Mutex);
+			const auto& rowIt = shard.Rows.find(state);
+			if (rowIt == shard.Rows.end())
+			{
+				return false;
+			}
+			const auto& valueIt = rowIt->second.ActionValueMap.find(action);
+			if (valueIt == rowIt->second.ActionValueMap.end())
+			{
+				return false;
+			}
+			value = valueIt->second.Value;
+			return true;
+		}
+
+
+		bool SharedQTable::GetMaxValue(StateRef state, float& maxValue) const
+		{
+			const Shard& shard = GetShard(state);
+			std::lock_guard<std::mutex> lock(shard.Mutex);
+			const auto& rowIt = shard.Rows.find(state);
+			if (rowIt == shard.Rows.end())
+			{
+				return false;
+			}
+			maxValue = rowIt->second.MaxValue;
+			return true;
+		}
+
+
+		float SharedQTable::UpdateValue(
+			StateRef state,
+			ActionRef action,
+			float initialValue,
+			const UpdateFunction& update
+			)
+		{
+			Shard& shard = GetShard(state);
+			std::lock_guard<std::mutex> lock(shard.Mutex);
+			Row& row = shard.Rows[state];
+			auto valueIt = row.ActionValueMap.find(action);
+			if (valueIt == row.ActionValueMap.end())
+			{
+				valueIt = row.ActionValueMap.insert(std::make_pair(action, ValueInfo())).first;
+				valueIt->second.Value = initialValue;
+			}
+			ValueInfo& valueInfo = valueIt->second;
+			const float prevValue = valueInfo.Value;
+			valueInfo.Count++;
+			valueInfo.Value = update(valueInfo.Value, valueInfo.Count);
+
+			// keep the maximum value updated (search it again only if the maximum decreased)
+			if (row.ActionValueMap.size() == 1 || valueInfo.Value >= row.MaxValue)
+			{
+				row.MaxValue = valueInfo.Value;
+			}
+			else if (prevValue >= row.MaxValue)
+			{
+				row.MaxValue = valueInfo.Value;
+				for (const auto& actionValuePair : row.ActionValueMap)
+				{
+					row.MaxValue = std::max(row.MaxValue, actionValuePair.second.Value);
+				}
+			}
+			return valueInfo.Value;
+		}
+
+
+		size_t SharedQTable::GetSize() const
+		{
+			size_t size = 0;
+			for (const auto& shard : Shards)
+			{
+				std::lock_guard<std::mutex> lock(shard->Mutex);
+				for (const auto& rowPair : shard->Rows)
+				{
+					size += rowPair.second.ActionValueMap.size();
+				}
+			}
+			return size;
+		}
+
+
+		void SharedQTable::GetSnapshot(std::map<StateActionRef, float>& stateActionValues) const
+		{
+			// lock all the shards (always in the same order) to freeze the table
+			std::vector< std::unique_lock<std::mutex> > locks;
+			locks.reserve(Shards.size());
+			for (const auto& shard : Shards)
+			{
+				locks.push_back(std::unique_lock<std::mutex>(shard->Mutex));
+			}
+			for (const auto& shard : Shards)
+			{
+				for (const auto& rowPair : shard->Rows)
+				{
+					for (const auto& actionValuePair : rowPair.second.ActionValueMap)
+					{
+						stateActionValues[StateActionRef(rowPair.first, actionValuePair.first)] = actionValuePair.second.Value;
+					}
+				}
+			}
+		}
+
+
+		void SharedQTable::MarkReachableStates(StateMarkSet& reachableStates) const
+		{
+			for (const auto& shard : Shards)
+			{
+				std::lock_guard<std::mutex> lock(shard->Mutex);
+				for (const auto& rowPair : shard->Rows)
+				{
+					reachableStates.insert(rowPair.first.get());
+				}
+			}
+		}
+
+
+		void SharedQTable::Clear()
+		{
+			for (const auto& shard : Shards)
+			{
+				std::lock_guard<std::mutex> lock(shard->Mutex);
+				shard->Rows.clear();
+			}
+		}
+
+
+		SharedQTable::Shard& SharedQTable::GetShard(const StateRef& state) const
+		{
+			// states are stored once in the environment model, thus their address identifies them
+			const size_t hash = std::hash<StateRef>()(state);
+			return *Shards[(hash >> 4) % Shards.size()];
+		}
+
+	} // namespace xp
+}
@@ -77,6 +77,23 @@ namespace discenfw
 		}
 
 
+		void AgentLink::ChooseActions(
+			const std::shared_ptr<Experience> experience,
+			const std::vector< std::vector<ActionRef> >& possibleActions,
+			const std::vector<StateRef>& envStates,
+			bool updatePolicy,
+			std::vector<int>& chosenActions
+			)
+		{
+			if (!CheckAgentPluginLoaded())
+			{
+				chosenActions.assign(envStates.size(), -1);
+				return;
+			}
+			(*PluginPtr)->ChooseActions(experience, possibleActions, envStates, updatePolicy, chosenActions);
+		}
+
+
 		int AgentLink::GetActionChoiceCount() const
 		{
 			if (!CheckAgentPluginLoaded())
@@ -58,27 +58,23 @@ namespace discenfw
 					ExportAction(*(AvailableActionsCache[i]), AvailableActionsData[i]);
 				}
 			}
-			if (ForbiddenActionsCache.empty())
-			{
-				ForbiddenActionsCache = DiScenFw()->GetForbiddenActions(GetAgentName());
-				ForbiddenActionsData.resize(ForbiddenActionsCache.size());
-				for (size_t i = 0; i < ForbiddenActionsCache.size(); i++)
-				{
-					ExportAction(ForbiddenActionsCache[i], ForbiddenActionsData[i]);
-				}
-			}
-			if (SuggestedActionsCache.empty())
-			{
-				SuggestedActionsCache = DiScenFw()->GetSuggestedActions(GetAgentName());
-				SuggestedActionsData.resize(SuggestedActionsCache.size());
-				for (size_t i = 0; i < SuggestedActionsCache.size(); i++)
-				{
-					ExportAction(SuggestedActionsCache[i], SuggestedActionsData[i]);
-				}
+			// forbidden and suggested actions are memoized by the agent,
+			// they are exported (referring to the agent data) only if changed
+			const std::vector<Action>& forbiddenActions = DiScenFw()->GetForbiddenActions(GetAgentName());
+			const std::vector<Action>& suggestedActions = DiScenFw()->GetSuggestedActions(GetAgentName());
+			const unsigned actionHintsVersion = DiScenFw()->GetActionHintsVersion(GetAgentName());
+			if (&forbiddenActions != ForbiddenActionsSource || &suggestedActions != SuggestedActionsSource
+				|| actionHintsVersion != ActionHintsVersion)
+			{
+				ForbiddenActionsSource = &forbiddenActions;
+				SuggestedActionsSource = &suggestedActions;
+				ActionHintsVersion = actionHintsVersion;
+				ExportActions(forbiddenActions, ForbiddenActionsData);
+				ExportActions(suggestedActions, SuggestedActionsData);
 			}
 			//LogMessage(DEBUG, "AvailableActions=" + std::to_string(AvailableActionsCache.size())
-			//	+ " ForbiddenActions=" + std::to_string(ForbiddenActionsCache.size())
-			//	+ " SuggestedActions=" + std::to_string(SuggestedActionsCache.size()), "DiScenFw(xp)");
+			//	+ " ForbiddenActions=" + std::to_string(ForbiddenActionsData.size())
+			//	+ " SuggestedActions=" + std::to_string(SuggestedActionsData.size()), "DiScenFw(xp)");
 		}
 
 
@@ -442,7 +438,7 @@ namespace discenfw
 		int DiScenXpWrapper::GetForbiddenActionsCount()
 		{
 			UpdateActionsCache();
-			int actionsCount = (int)(ForbiddenActionsCache.size());
+			int actionsCount = (int)(ForbiddenActionsData.size());
 			return actionsCount;
 		}
 
@@ -466,7 +462,7 @@ namespace discenfw
 		int DiScenXpWrapper::GetSuggestedActionsCount()
 		{
 			UpdateActionsCache();
-			int actionsCount = (int)(SuggestedActionsCache.size());
+			int actionsCount = (int)(SuggestedActionsData.size());
 			return actionsCount;
 		}
 
@@ -595,8 +591,6 @@ namespace discenfw
 		void DiScenXpWrapper::ClearActionsCache()
 		{
 			AvailableActionsCache.clear();
-			ForbiddenActionsCache.clear();
-			SuggestedActionsCache.clear();
 		}
 
 
@@ -743,6 +737,20 @@ namespace discenfw
 			}
 		}
 
+
+		void DiScenXpWrapper::ExportActions(const std::vector<Action>& actions, std::vector<ActionData>& actionsData)
+		{
+			for (ActionData& actionData : actionsData)
+			{
+				delete[] actionData.Params;
+			}
+			actionsData.assign(actions.size(), ActionData());
+			for (size_t i = 0; i < actions.size(); i++)
+			{
+				ExportAction(actions[i], actionsData[i]);
+			}
+		}
+
 	} // namespace xp
 } // namespace discenfw
 
@@ -0,0 +1,966 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/sim/HistoryArchive.h>
+#include <discenfw/util/MessageLog.h>
+#include <discenfw/util/DateTimeUtil.h>
+
+#include <gpvulc/time/DateTimeUtil.h>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+namespace
+{
+	const char ARCHIVE_MAGIC[8] = { 'D','S','F','H','I','S','T','\0' };
+	// Version 2: entity identifier in event records (version 1 files are read without it)
+	const uint32_t ARCHIVE_VERSION = 2;
+
+	// State flags
+	const uint8_t STATE_ELEMENT = 1;
+	const uint8_t STATE_USE_COORD_SYS = 2;
+	const uint8_t STATE_START_UNDEFINED = 4;
+	const uint8_t STATE_END_UNDEFINED = 8;
+
+	// Time flags of header, entity and event records
+	// (undefined date/times are stored as 0 and restored as undefined)
+	const uint32_t START_TIME_UNDEFINED = 1;
+	const uint32_t END_TIME_UNDEFINED = 2;
+
+	// Floats per state in the orientation column:
+	// right, forward, up axes (UseCoordSys) or Euler angles, scale, unused
+	const int ORIENTATION_SIZE = 9;
+
+	/*
+	File layout (all the offsets are absolute and 8-byte aligned):
+	ArchiveHeader
+	for each entity: columns (start times, end times, positions, orientations,
+	  origins, representations, parents, flags) and keyframe index
+	EventRecord table (sorted by time)
+	EntityRecord table
+	string end offsets table (uint64 x StringCount), string data
+	*/
+	struct ArchiveHeader
+	{
+		char Magic[8];
+		uint32_t Version;
+		uint32_t EntityCount;
+		uint32_t EventCount;
+		uint32_t StringCount;
+		// Year, Month, Day, WeekDay, Hour, Minute, Second, Millisecond,
+		// TimeOffsetHour, TimeOffsetMinute, IsDST
+		int32_t BaseDateTime[11];
+		uint32_t TimeFlags;
+		uint32_t UriStr;
+		uint32_t NameStr;
+		uint32_t DescriptionStr;
+		uint32_t DetailsStr;
+		int64_t StartMs;
+		int64_t EndMs;
+		uint64_t EntityTableOffset;
+		uint64_t EventTableOffset;
+		uint64_t StringTableOffset;
+		uint64_t StringDataOffset;
+	};
+
+	struct EntityRecord
+	{
+		uint32_t IdStr;
+		uint32_t LogUriStr;
+		uint32_t StateCount;
+		uint32_t KeyframeStride;
+		uint32_t KeyframeCount;
+		uint32_t TimeFlags;
+		int64_t StartMs;
+		int64_t EndMs;
+		uint64_t StartTimesOffset;
+		uint64_t EndTimesOffset;
+		uint64_t PositionsOffset;
+		uint64_t OrientationsOffset;
+		uint64_t OriginsOffset;
+		uint64_t RepresentationsOffset;
+		uint64_t ParentsOffset;
+		uint64_t FlagsOffset;
+		uint64_t KeyframesOffset;
+	};
+
+	struct EventRecord
+	{
+		int64_t TimeMs;
+		uint32_t UriStr;
+		uint32_t CategoryStr;
+		uint32_t EntityStr;
+		uint32_t TimeFlags;
+	};
+
+	// Event record of version 1 archives
+	struct EventRecordV1
+	{
+		int64_t TimeMs;
+		uint32_t UriStr;
+		uint32_t CategoryStr;
+	};
+
+	static_assert(sizeof(ArchiveHeader) == 136, "Unexpected ArchiveHeader layout");
+	static_assert(sizeof(EntityRecord) == 112, "Unexpected EntityRecord layout");
+	static_assert(sizeof(EventRecord) == 24, "Unexpected EventRecord layout");
+	static_assert(sizeof(EventRecordV1) == 16, "Unexpected EventRecordV1 layout");
+
+
+	void EncodeDateTime(const discenfw::DateTime& dateTime, int32_t* fields)
+	{
+		fields[0] = dateTime.Year;
+		fields[1] = dateTime.Month;
+		fields[2] = dateTime.Day;
+		fields[3] = dateTime.WeekDay;
+		fields[4] = dateTime.Hour;
+		fields[5] = dateTime.Minute;
+		fields[6] = dateTime.Second;
+		fields[7] = dateTime.Millisecond;
+		fields[8] = dateTime.TimeOffsetHour;
+		fields[9] = dateTime.TimeOffsetMinute;
+		fields[10] = dateTime.IsDST ? 1 : 0;
+	}
+
+
+	discenfw::DateTime DecodeDateTime(const int32_t* fields)
+	{
+		discenfw::DateTime dateTime(
+			fields[0], fields[1], fields[2],
+			fields[4], fields[5], fields[6], fields[7],
+			fields[8], fields[9]);
+		dateTime.WeekDay = fields[3];
+		dateTime.IsDST = fields[10] != 0;
+		return dateTime;
+	}
+
+
+	uint32_t GetTimeFlags(const discenfw::DateTime& startDateTime, const discenfw::DateTime& endDateTime)
+	{
+		return (discenfw::DateTimeDefined(startDateTime) ? 0 : START_TIME_UNDEFINED)
+			| (discenfw::DateTimeDefined(endDateTime) ? 0 : END_TIME_UNDEFINED);
+	}
+
+
+	// Collect strings in a table, mapping them to their index.
+	class StringTableBuilder
+	{
+	public:
+
+		StringTableBuilder()
+		{
+			Add("");
+		}
+
+		uint32_t Add(const std::string& str)
+		{
+			auto it = StringIndex.find(str);
+			if (it != StringIndex.end())
+			{
+				return it->second;
+			}
+			uint32_t index = (uint32_t)Strings.size();
+			StringIndex[str] = index;
+			Strings.push_back(str);
+			return index;
+		}
+
+		std::vector<std::string> Strings;
+
+	private:
+		std::map<std::string, uint32_t> StringIndex;
+	};
+
+
+	class ArchiveOutput
+	{
+	public:
+
+		ArchiveOutput(const std::string& filePath)
+			: Out(filePath, std::ios::binary | std::ios::trunc)
+		{
+		}
+
+		bool Good() const { return Out.good(); }
+
+		// Write the given data at an 8-byte aligned position, return its offset.
+		uint64_t WriteBlock(const void* data, size_t size)
+		{
+			static const char padding[8] = { 0 };
+			if (Position % 8)
+			{
+				size_t padSize = 8 - (size_t)(Position % 8);
+				Out.write(padding, padSize);
+				Position += padSize;
+			}
+			uint64_t offset = Position;
+			if (size > 0)
+			{
+				Out.write(static_cast<const char*>(data), size);
+				Position += size;
+			}
+			return offset;
+		}
+
+		// Write the given data at the current position (no alignment).
+		void Write(const void* data, size_t size)
+		{
+			Out.write(static_cast<const char*>(data), size);
+			Position += size;
+		}
+
+		template <typename T>
+		uint64_t WriteArray(const std::vector<T>& values)
+		{
+			return WriteBlock(values.data(), values.size() * sizeof(T));
+		}
+
+		void WriteAt(uint64_t offset, const void* data, size_t size)
+		{
+			Out.seekp((std::streamoff)offset);
+			Out.write(static_cast<const char*>(data), size);
+			Out.seekp((std::streamoff)Position);
+		}
+
+	private:
+		std::ofstream Out;
+		uint64_t Position = 0;
+	};
+}
+
+
+namespace discenfw
+{
+	namespace sim
+	{
+		struct HistoryArchive::MappedFile
+		{
+			boost::interprocess::file_mapping Mapping;
+			boost::interprocess::mapped_region Region;
+		};
+
+
+		HistoryArchive::HistoryArchive()
+		{
+		}
+
+
+		HistoryArchive::~HistoryArchive()
+		{
+		}
+
+
+		bool HistoryArchive::Write(const std::string& filePath, const ScenarioHistory& history, int keyframeStride)
+		{
+			if (keyframeStride < 1)
+			{
+				keyframeStride = 1;
+			}
+
+			// find the base date/time (the earliest defined time)
+			DateTime baseDateTime;
+			bool baseFound = false;
+			auto updateBase = [&baseDateTime, &baseFound](const DateTime& dateTime)
+			{
+				if (DateTimeDefined(dateTime) && (!baseFound || dateTime < baseDateTime))
+				{
+					baseDateTime = dateTime;
+					baseFound = true;
+				}
+			};
+			updateBase(history.StartDateTime);
+			for (const auto& entityHistory : history.EntityHistories)
+			{
+				if (entityHistory.second)
+				{
+					updateBase(entityHistory.second->StartDateTime);
+					for (const auto& state : entityHistory.second->States)
+					{
+						updateBase(state->StartDateTime);
+					}
+				}
+			}
+			for (const auto& historyEvent : history.Events)
+			{
+				updateBase(historyEvent->DateTime);
+			}
+			auto timeMs = [&baseDateTime](const DateTime& dateTime) -> int64_t
+			{
+				return DateTimeDefined(dateTime) ? (int64_t)gpvulc::DateTimeDistanceMs(baseDateTime, dateTime) : 0;
+			};
+
+			ArchiveOutput out(filePath);
+			if (!out.Good())
+			{
+				LogMessage(LOG_ERROR, "Failed to create " + filePath, "DiScenFw|Sim");
+				return false;
+			}
+
+			StringTableBuilder strings;
+			ArchiveHeader header;
+			memset(&header, 0, sizeof(header));
+			memcpy(header.Magic, ARCHIVE_MAGIC, sizeof(header.Magic));
+			header.Version = ARCHIVE_VERSION;
+			EncodeDateTime(baseDateTime, header.BaseDateTime);
+			header.UriStr = strings.Add(history.Uri);
+			header.NameStr = strings.Add(history.Name);
+			header.DescriptionStr = strings.Add(history.Description);
+			header.DetailsStr = strings.Add(history.Details);
+			header.StartMs = timeMs(history.StartDateTime);
+			header.EndMs = timeMs(history.EndDateTime);
+			header.TimeFlags = GetTimeFlags(history.StartDateTime, history.EndDateTime);
+
+			// placeholder, rewritten at the end
+			out.WriteBlock(&header, sizeof(header));
+
+			bool statesStartFound = false;
+			bool statesEndFound = false;
+			std::vector<EntityRecord> entityRecords;
+			entityRecords.reserve(history.EntityHistories.size());
+			for (const auto& entityHistoryPair : history.EntityHistories)
+			{
+				static const EntityHistory emptyHistory;
+				const EntityHistory& entityHistory = entityHistoryPair.second ? *entityHistoryPair.second : emptyHistory;
+				const size_t stateCount = entityHistory.States.size();
+
+				EntityRecord record;
+				memset(&record, 0, sizeof(record));
+				record.IdStr = strings.Add(entityHistoryPair.first);
+				record.LogUriStr = strings.Add(entityHistory.LogUri);
+				record.StateCount = (uint32_t)stateCount;
+				record.KeyframeStride = (uint32_t)keyframeStride;
+				record.StartMs = timeMs(entityHistory.StartDateTime);
+				record.EndMs = timeMs(entityHistory.EndDateTime);
+				record.TimeFlags = GetTimeFlags(entityHistory.StartDateTime, entityHistory.EndDateTime);
+
+				std::vector<int64_t> startTimes(stateCount);
+				std::vector<int64_t> endTimes(stateCount);
+				std::vector<float> positions(stateCount * 3, 0.0f);
+				std::vector<float> orientations(stateCount * ORIENTATION_SIZE, 0.0f);
+				std::vector<uint32_t> origins(stateCount, 0);
+				std::vector<uint32_t> representations(stateCount, 0);
+				std::vector<uint32_t> parents(stateCount, 0);
+				std::vector<uint8_t> flags(stateCount, 0);
+
+				for (size_t i = 0; i < stateCount; i++)
+				{
+					const std::shared_ptr<TemporalState>& state = entityHistory.States[i];
+					startTimes[i] = timeMs(state->StartDateTime);
+					endTimes[i] = timeMs(state->EndDateTime);
+					origins[i] = strings.Add(state->Origin);
+					if (!DateTimeDefined(state->StartDateTime))
+					{
+						flags[i] |= STATE_START_UNDEFINED;
+					}
+					if (!DateTimeDefined(state->EndDateTime))
+					{
+						flags[i] |= STATE_END_UNDEFINED;
+					}
+					if (state->IsA("ElementState"))
+					{
+						const ElementState& elementState = static_cast<const ElementState&>(*state);
+						const LocalTransform& transform = elementState.Transform;
+						float* pos = &positions[i * 3];
+						float* orient = &orientations[i * ORIENTATION_SIZE];
+						flags[i] |= STATE_ELEMENT;
+						if (transform.UseCoordSys)
+						{
+							flags[i] |= STATE_USE_COORD_SYS;
+							const CoordSys3D& cs = transform.CoordSys;
+							pos[0] = cs.Origin.Right; pos[1] = cs.Origin.Forward; pos[2] = cs.Origin.Up;
+							orient[0] = cs.RightAxis.Right; orient[1] = cs.RightAxis.Forward; orient[2] = cs.RightAxis.Up;
+							orient[3] = cs.ForwardAxis.Right; orient[4] = cs.ForwardAxis.Forward; orient[5] = cs.ForwardAxis.Up;
+							orient[6] = cs.UpAxis.Right; orient[7] = cs.UpAxis.Forward; orient[8] = cs.UpAxis.Up;
+						}
+						else
+						{
+							pos[0] = transform.Location.Right; pos[1] = transform.Location.Forward; pos[2] = transform.Location.Up;
+							orient[0] = transform.EulerAngles.Right; orient[1] = transform.EulerAngles.Forward; orient[2] = transform.EulerAngles.Up;
+							orient[3] = transform.Scale.Right; orient[4] = transform.Scale.Forward; orient[5] = transform.Scale.Up;
+						}
+						representations[i] = strings.Add(elementState.Representation);
+						parents[i] = strings.Add(transform.ParentId);
+					}
+				}
+
+				// the time interval includes all the entity states (see SimulationController::InitSimulation())
+				bool startFound = false;
+				bool endFound = false;
+				for (size_t i = 0; i < stateCount; i++)
+				{
+					if (!(flags[i] & STATE_START_UNDEFINED) && (!startFound || startTimes[i] < record.StartMs))
+					{
+						record.StartMs = startTimes[i];
+						startFound = true;
+					}
+					if (!(flags[i] & STATE_END_UNDEFINED) && (!endFound || endTimes[i] > record.EndMs))
+					{
+						record.EndMs = endTimes[i];
+						endFound = true;
+					}
+				}
+				if (startFound)
+				{
+					record.TimeFlags &= ~START_TIME_UNDEFINED;
+					if (!statesStartFound || record.StartMs < header.StartMs)
+					{
+						header.StartMs = record.StartMs;
+					}
+					header.TimeFlags &= ~START_TIME_UNDEFINED;
+					statesStartFound = true;
+				}
+				if (endFound)
+				{
+					record.TimeFlags &= ~END_TIME_UNDEFINED;
+					if (!statesEndFound || record.EndMs > header.EndMs)
+					{
+						header.EndMs = record.EndMs;
+					}
+					header.TimeFlags &= ~END_TIME_UNDEFINED;
+					statesEndFound = true;
+				}
+
+				std::vector<int64_t> keyframes;
+				keyframes.reserve(stateCount / keyframeStride + 1);
+				for (size_t i = 0; i < stateCount; i += keyframeStride)
+				{
+					keyframes.push_back(startTimes[i]);
+				}
+				record.KeyframeCount = (uint32_t)keyframes.size();
+
+				record.StartTimesOffset = out.WriteArray(startTimes);
+				record.EndTimesOffset = out.WriteArray(endTimes);
+				record.PositionsOffset = out.WriteArray(positions);
+				record.OrientationsOffset = out.WriteArray(orientations);
+				record.OriginsOffset = out.WriteArray(origins);
+				record.RepresentationsOffset = out.WriteArray(representations);
+				record.ParentsOffset = out.WriteArray(parents);
+				record.FlagsOffset = out.WriteArray(flags);
+				record.KeyframesOffset = out.WriteArray(keyframes);
+				entityRecords.push_back(record);
+			}
+
+			std::vector<EventRecord> eventRecords;
+			eventRecords.reserve(history.Events.size());
+			for (const auto& historyEvent : history.Events)
+			{
+				EventRecord record;
+				record.TimeMs = timeMs(historyEvent->DateTime);
+				record.UriStr = strings.Add(historyEvent->Uri);
+				record.CategoryStr = strings.Add(historyEvent->Category);
+				record.EntityStr = strings.Add(historyEvent->EntityId);
+				record.TimeFlags = DateTimeDefined(historyEvent->DateTime) ? 0 : START_TIME_UNDEFINED;
+				eventRecords.push_back(record);
+			}
+			std::stable_sort(eventRecords.begin(), eventRecords.end(),
+				[](const EventRecord& e1, const EventRecord& e2) { return e1.TimeMs < e2.TimeMs; });
+
+			header.EntityCount = (uint32_t)entityRecords.size();
+			header.EventCount = (uint32_t)eventRecords.size();
+			header.EventTableOffset = out.WriteArray(eventRecords);
+			header.EntityTableOffset = out.WriteArray(entityRecords);
+
+			std::vector<uint64_t> stringEnds;
+			stringEnds.reserve(strings.Strings.size());
+			uint64_t stringEnd = 0;
+			for (const std::string& str : strings.Strings)
+			{
+				stringEnd += str.size();
+				stringEnds.push_back(stringEnd);
+			}
+			header.StringCount = (uint32_t)strings.Strings.size();
+			header.StringTableOffset = out.WriteArray(stringEnds);
+			header.StringDataOffset = out.WriteBlock(nullptr, 0);
+			for (const std::string& str : strings.Strings)
+			{
+				// strings are packed (no alignment)
+				out.Write(str.data(), str.size());
+			}
+
+			out.WriteAt(0, &header, sizeof(header));
+
+			if (!out.Good())
+			{
+				LogMessage(LOG_ERROR, "Failed to write " + filePath, "DiScenFw|Sim");
+				return false;
+			}
+			return true;
+		}
+
+
+		bool HistoryArchive::Open(const std::string& filePath)
+		{
+			Close();
+
+			using namespace boost::interprocess;
+			std::unique_ptr<MappedFile> mapping(new MappedFile);
+			try
+			{
+				mapping->Mapping = file_mapping(filePath.c_str(), read_only);
+				mapping->Region = mapped_region(mapping->Mapping, read_only);
+			}
+			catch (const interprocess_exception& e)
+			{
+				LogMessage(LOG_ERROR, "Failed to open " + filePath + ": " + e.what(), "DiScenFw|Sim");
+				return false;
+			}
+
+			const char* data = static_cast<const char*>(mapping->Region.get_address());
+			const size_t dataSize = mapping->Region.get_size();
+
+			auto inRange = [dataSize](uint64_t offset, uint64_t size)
+			{
+				return offset % 8 == 0 && offset <= dataSize && size <= dataSize - offset;
+			};
+
+			const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>(data);
+			bool valid = dataSize >= sizeof(ArchiveHeader)
+				&& memcmp(header->Magic, ARCHIVE_MAGIC, sizeof(header->Magic)) == 0
+				&& (header->Version == ARCHIVE_VERSION || header->Version == 1);
+			const size_t eventRecordSize = valid && header->Version == 1 ? sizeof(EventRecordV1) : sizeof(EventRecord);
+			valid = valid
+				&& header->StringCount > 0
+				&& inRange(header->EntityTableOffset, (uint64_t)header->EntityCount * sizeof(EntityRecord))
+				&& inRange(header->EventTableOffset, (uint64_t)header->EventCount * eventRecordSize)
+				&& inRange(header->StringTableOffset, (uint64_t)header->StringCount * sizeof(uint64_t));
+			if (valid)
+			{
+				// string end offsets must be non-decreasing (the last one is checked against the file size)
+				const uint64_t* stringEnds = reinterpret_cast<const uint64_t*>(data + header->StringTableOffset);
+				valid = header->StringDataOffset <= dataSize
+					&& stringEnds[header->StringCount - 1] <= dataSize - header->StringDataOffset;
+				for (uint32_t i = 1; valid && i < header->StringCount; i++)
+				{
+					valid = stringEnds[i] >= stringEnds[i - 1];
+				}
+			}
+			if (valid)
+			{
+				const EntityRecord* records = reinterpret_cast<const EntityRecord*>(data + header->EntityTableOffset);
+				for (uint32_t i = 0; valid && i < header->EntityCount; i++)
+				{
+					const EntityRecord& rec = records[i];
+					const uint64_t n = rec.StateCount;
+					valid = rec.KeyframeStride > 0
+						&& rec.KeyframeCount == (n + rec.KeyframeStride - 1) / rec.KeyframeStride
+						&& inRange(rec.StartTimesOffset, n * sizeof(int64_t))
+						&& inRange(rec.EndTimesOffset, n * sizeof(int64_t))
+						&& inRange(rec.PositionsOffset, n * 3 * sizeof(float))
+						&& inRange(rec.OrientationsOffset, n * ORIENTATION_SIZE * sizeof(float))
+						&& inRange(rec.OriginsOffset, n * sizeof(uint32_t))
+						&& inRange(rec.RepresentationsOffset, n * sizeof(uint32_t))
+						&& inRange(rec.ParentsOffset, n * sizeof(uint32_t))
+						&& inRange(rec.FlagsOffset, n)
+						&& inRange(rec.KeyframesOffset, rec.KeyframeCount * sizeof(int64_t));
+				}
+			}
+			if (!valid)
+			{
+				LogMessage(LOG_ERROR, "Invalid history archive " + filePath, "DiScenFw|Sim");
+				return false;
+			}
+
+			Mapping = std::move(mapping);
+			Data = data;
+			DataSize = dataSize;
+			FilePath = filePath;
+			BaseDateTime = DecodeDateTime(header->BaseDateTime);
+			EventRecordSize = eventRecordSize;
+			return true;
+		}
+
+
+		void HistoryArchive::Close()
+		{
+			Mapping.reset();
+			Data = nullptr;
+			DataSize = 0;
+			FilePath.clear();
+			BaseDateTime.Reset();
+			EventRecordSize = 0;
+		}
+
+
+		bool HistoryArchive::IsOpen() const
+		{
+			return Data != nullptr;
+		}
+
+
+		long long HistoryArchive::ToTimeMs(const DateTime& dateTime) const
+		{
+			return gpvulc::DateTimeDistanceMs(BaseDateTime, dateTime);
+		}
+
+
+		DateTime HistoryArchive::ToDateTime(long long timeMs) const
+		{
+			return DateTimeAddLongMs(BaseDateTime, timeMs);
+		}
+
+
+		bool HistoryArchive::GetInfo(ScenarioHistory& history) const
+		{
+			if (!IsOpen())
+			{
+				return false;
+			}
+			const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>(Data);
+			history.Uri = GetString(header->UriStr);
+			history.Name = GetString(header->NameStr);
+			history.Description = GetString(header->DescriptionStr);
+			history.Details = GetString(header->DetailsStr);
+			history.StartDateTime = (header->TimeFlags & START_TIME_UNDEFINED) ? DateTime() : ToDateTime(header->StartMs);
+			history.EndDateTime = (header->TimeFlags & END_TIME_UNDEFINED) ? DateTime() : ToDateTime(header->EndMs);
+			return true;
+		}
+
+
+		long long HistoryArchive::GetStartTimeMs() const
+		{
+			return IsOpen() ? reinterpret_cast<const ArchiveHeader*>(Data)->StartMs : 0;
+		}
+
+
+		long long HistoryArchive::GetEndTimeMs() const
+		{
+			return IsOpen() ? reinterpret_cast<const ArchiveHeader*>(Data)->EndMs : 0;
+		}
+
+
+		int HistoryArchive::GetEntityCount() const
+		{
+			return IsOpen() ? (int)reinterpret_cast<const ArchiveHeader*>(Data)->EntityCount : 0;
+		}
+
+
+		std::string HistoryArchive::GetEntityId(int entityIndex) const
+		{
+			if (!ValidEntityIndex(entityIndex))
+			{
+				return "";
+			}
+			const EntityRecord* rec = static_cast<const EntityRecord*>(GetEntityRecord(entityIndex));
+			return GetString(rec->IdStr);
+		}
+
+
+		int HistoryArchive::FindEntity(const std::string& entityId) const
+		{
+			const int entityCount = GetEntityCount();
+			for (int i = 0; i < entityCount; i++)
+			{
+				const EntityRecord* rec = static_cast<const EntityRecord*>(GetEntityRecord(i));
+				if (GetString(rec->IdStr) == entityId)
+				{
+					return i;
+				}
+			}
+			return -1;
+		}
+
+
+		long long HistoryArchive::GetEntityStartMs(int entityIndex) const
+		{
+			if (!ValidEntityIndex(entityIndex))
+			{
+				return 0;
+			}
+			return static_cast<const EntityRecord*>(GetEntityRecord(entityIndex))->StartMs;
+		}
+
+
+		long long HistoryArchive::GetEntityEndMs(int entityIndex) const
+		{
+			if (!ValidEntityIndex(entityIndex))
+			{
+				return 0;
+			}
+			return static_cast<const EntityRecord*>(GetEntityRecord(entityIndex))->EndMs;
+		}
+
+
+		int HistoryArchive::GetStateCount(int entityIndex) const
+		{
+			if (!ValidEntityIndex(entityIndex))
+			{
+				return 0;
+			}
+			return (int)static_cast<const EntityRecord*>(GetEntityRecord(entityIndex))->StateCount;
+		}
+
+
+		long long HistoryArchive::GetStateStartMs(int entityIndex, int stateIndex) const
+		{
+			if (!ValidStateIndex(entityIndex, stateIndex))
+			{
+				return 0;
+			}
+			const EntityRecord* rec = static_cast<const EntityRecord*>(GetEntityRecord(entityIndex));
+			return reinterpret_cast<const int64_t*>(Data + rec->StartTimesOffset)[stateIndex];
+		}
+
+
+		long long HistoryArchive::GetStateEndMs(int entityIndex, int stateIndex) const
+		{
+			if (!ValidStateIndex(entityIndex, stateIndex))
+			{
+				return 0;
+			}
+			const EntityRecord* rec = static_cast<const EntityRecord*>(GetEntityRecord(entityIndex));
+			return reinterpret_cast<const int64_t*>(Data + rec->EndTimesOffset)[stateIndex];
+		}
+
+
+		int HistoryArchive::FindStateIndex(int entityIndex, long long timeMs) const
+		{
+			if (!ValidEntityIndex(entityIndex))
+			{
+				return -1;
+			}
+			const EntityRecord* rec = static_cast<const EntityRecord*>(GetEntityRecord(entityIndex));
+			if (rec->StateCount == 0)
+			{
+				return -1;
+			}
+
+			// first search the keyframe index (small, usually cached),
+			// then search only the block of states following the keyframe found
+			const int64_t* keyframes = reinterpret_cast<const int64_t*>(Data + rec->KeyframesOffset);
+			const int64_t* keyframesEnd = keyframes + rec->KeyframeCount;
+			const int64_t* keyframe = std::upper_bound(keyframes, keyframesEnd, (int64_t)timeMs);
+			if (keyframe == keyframes)
+			{
+				return -1;
+			}
+			const uint32_t blockIndex = (uint32_t)(keyframe - keyframes) - 1;
+			const uint32_t blockBegin = blockIndex * rec->KeyframeStride;
+			const uint32_t blockEnd = std::min(blockBegin + rec->KeyframeStride, rec->StateCount);
+
+			const int64_t* startTimes = reinterpret_cast<const int64_t*>(Data + rec->StartTimesOffset);
+			const int64_t* state = std::upper_bound(startTimes + blockBegin, startTimes + blockEnd, (int64_t)timeMs);
+			return (int)(state - startTimes) - 1;
+		}
+
+
+		std::shared_ptr<TemporalState> HistoryArchive::GetState(int entityIndex, int stateIndex) const
+		{
+			std::vector< std::shared_ptr<TemporalState> > states;
+			if (!LoadEntityStates(entityIndex, stateIndex, 1, states) || states.empty())
+			{
+				return nullptr;
+			}
+			return states[0];
+		}
+
+
+		bool HistoryArchive::LoadEntityStates(
+			int entityIndex,
+			int firstState,
+			int stateCount,
+			std::vector< std::shared_ptr<TemporalState> >& states
+			) const
+		{
+			if (!ValidEntityIndex(entityIndex))
+			{
+				return false;
+			}
+			const EntityRecord* rec = static_cast<const EntityRecord*>(GetEntityRecord(entityIndex));
+			if (firstState < 0 || (uint32_t)firstState > rec->StateCount)
+			{
+				return false;
+			}
+			uint32_t lastState = rec->StateCount;
+			if (stateCount >= 0 && (uint32_t)firstState + (uint32_t)stateCount < lastState)
+			{
+				lastState = (uint32_t)firstState + (uint32_t)stateCount;
+			}
+
+			const int64_t* startTimes = reinterpret_cast<const int64_t*>(Data + rec->StartTimesOffset);
+			const int64_t* endTimes = reinterpret_cast<const int64_t*>(Data + rec->EndTimesOffset);
+			const float* positions = reinterpret_cast<const float*>(Data + rec->PositionsOffset);
+			const float* orientations = reinterpret_cast<const float*>(Data + rec->OrientationsOffset);
+			const uint32_t* origins = reinterpret_cast<const uint32_t*>(Data + rec->OriginsOffset);
+			const uint32_t* representations = reinterpret_cast<const uint32_t*>(Data + rec->RepresentationsOffset);
+			const uint32_t* parents = reinterpret_cast<const uint32_t*>(Data + rec->ParentsOffset);
+			const uint8_t* flags = reinterpret_cast<const uint8_t*>(Data + rec->FlagsOffset);
+
+			states.reserve(states.size() + (lastState - firstState));
+			for (uint32_t i = (uint32_t)firstState; i < lastState; i++)
+			{
+				std::shared_ptr<TemporalState> state;
+				if (flags[i] & STATE_ELEMENT)
+				{
+					std::shared_ptr<ElementState> elementState = std::make_shared<ElementState>();
+					LocalTransform& transform = elementState->Transform;
+					const float* pos = positions + i * 3;
+					const float* orient = orientations + i * ORIENTATION_SIZE;
+					if (flags[i] & STATE_USE_COORD_SYS)
+					{
+						transform.UseCoordSys = true;
+						transform.CoordSys.Origin = { pos[0], pos[1], pos[2] };
+						transform.CoordSys.RightAxis = { orient[0], orient[1], orient[2] };
+						transform.CoordSys.ForwardAxis = { orient[3], orient[4], orient[5] };
+						transform.CoordSys.UpAxis = { orient[6], orient[7], orient[8] };
+					}
+					else
+					{
+						transform.Location = { pos[0], pos[1], pos[2] };
+						transform.EulerAngles = { orient[0], orient[1], orient[2] };
+						transform.Scale = { orient[3], orient[4], orient[5] };
+					}
+					transform.ParentId = GetString(parents[i]);
+					elementState->Representation = GetString(representations[i]);
+					state = elementState;
+				}
+				else
+				{
+					state = std::make_shared<TemporalState>();
+				}
+				state->StartDateTime = (flags[i] & STATE_START_UNDEFINED) ? DateTime() : ToDateTime(startTimes[i]);
+				state->EndDateTime = (flags[i] & STATE_END_UNDEFINED) ? DateTime() : ToDateTime(endTimes[i]);
+				state->Origin = GetString(origins[i]);
+				states.push_back(state);
+			}
+			return true;
+		}
+
+
+		bool HistoryArchive::LoadEntityHistory(int entityIndex, EntityHistory& history) const
+		{
+			if (!ValidEntityIndex(entityIndex))
+			{
+				return false;
+			}
+			const EntityRecord* rec = static_cast<const EntityRecord*>(GetEntityRecord(entityIndex));
+			history.LogUri = GetString(rec->LogUriStr);
+			history.StartDateTime = (rec->TimeFlags & START_TIME_UNDEFINED) ? DateTime() : ToDateTime(rec->StartMs);
+			history.EndDateTime = (rec->TimeFlags & END_TIME_UNDEFINED) ? DateTime() : ToDateTime(rec->EndMs);
+			history.States.clear();
+			return LoadEntityStates(entityIndex, 0, -1, history.States);
+		}
+
+
+		int HistoryArchive::GetEventCount() const
+		{
+			return IsOpen() ? (int)reinterpret_cast<const ArchiveHeader*>(Data)->EventCount : 0;
+		}
+
+
+		long long HistoryArchive::GetEventTimeMs(int eventIndex) const
+		{
+			if (eventIndex < 0 || eventIndex >= GetEventCount())
+			{
+				return 0;
+			}
+			// the time is the first field of all the event record versions
+			return reinterpret_cast<const EventRecordV1*>(GetEventRecord(eventIndex))->TimeMs;
+		}
+
+
+		std::shared_ptr<HistoryEvent> HistoryArchive::GetEvent(int eventIndex) const
+		{
+			if (eventIndex < 0 || eventIndex >= GetEventCount())
+			{
+				return nullptr;
+			}
+			std::shared_ptr<HistoryEvent> historyEvent = std::make_shared<HistoryEvent>();
+			if (EventRecordSize == sizeof(EventRecordV1))
+			{
+				const EventRecordV1& rec = *reinterpret_cast<const EventRecordV1*>(GetEventRecord(eventIndex));
+				historyEvent->Uri = GetString(rec.UriStr);
+				historyEvent->Category = GetString(rec.CategoryStr);
+				historyEvent->DateTime = ToDateTime(rec.TimeMs);
+				return historyEvent;
+			}
+			const EventRecord& rec = *reinterpret_cast<const EventRecord*>(GetEventRecord(eventIndex));
+			historyEvent->Uri = GetString(rec.UriStr);
+			historyEvent->Category = GetString(rec.CategoryStr);
+			historyEvent->DateTime = (rec.TimeFlags & START_TIME_UNDEFINED) ? DateTime() : ToDateTime(rec.TimeMs);
+			historyEvent->EntityId = GetString(rec.EntityStr);
+			return historyEvent;
+		}
+
+
+		bool HistoryArchive::Load(ScenarioHistory& history) const
+		{
+			if (!GetInfo(history))
+			{
+				return false;
+			}
+			history.EntityHistories.clear();
+			history.Events.clear();
+			const int entityCount = GetEntityCount();
+			for (int i = 0; i < entityCount; i++)
+			{
+				std::shared_ptr<EntityHistory> entityHistory = std::make_shared<EntityHistory>();
+				LoadEntityHistory(i, *entityHistory);
+				history.EntityHistories[GetEntityId(i)] = entityHistory;
+			}
+			const int eventCount = GetEventCount();
+			history.Events.reserve(eventCount);
+			for (int i = 0; i < eventCount; i++)
+			{
+				history.Events.push_back(GetEvent(i));
+			}
+			return true;
+		}
+
+
+		std::string HistoryArchive::GetString(unsigned stringIndex) const
+		{
+			const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>(Data);
+			if (!IsOpen() || stringIndex >= header->StringCount)
+			{
+				return "";
+			}
+			const uint64_t* stringEnds = reinterpret_cast<const uint64_t*>(Data + header->StringTableOffset);
+			uint64_t start = stringIndex > 0 ? stringEnds[stringIndex - 1] : 0;
+			uint64_t end = stringEnds[stringIndex];
+			if (end < start)
+			{
+				return "";
+			}
+			return std::string(Data + header->StringDataOffset + start, (size_t)(end - start));
+		}
+
+
+		const void* HistoryArchive::GetEntityRecord(int entityIndex) const
+		{
+			const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>(Data);
+			return reinterpret_cast<const EntityRecord*>(Data + header->EntityTableOffset) + entityIndex;
+		}
+
+
+		const void* HistoryArchive::GetEventRecord(int eventIndex) const
+		{
+			const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>(Data);
+			return Data + header->EventTableOffset + (size_t)eventIndex * EventRecordSize;
+		}
+
+
+		bool HistoryArchive::ValidEntityIndex(int entityIndex) const
+		{
+			return entityIndex >= 0 && entityIndex < GetEntityCount();
+		}
+
+
+		bool HistoryArchive::ValidStateIndex(int entityIndex, int stateIndex) const
+		{
+			return stateIndex >= 0 && stateIndex < GetStateCount(entityIndex);
+		}
+
+	} // namespace sim
+}
@@ -0,0 +1,159 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/sim/HistoryEventIndex.h>
+
+#include <gpvulc/time/DateTimeUtil.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace discenfw
+{
+	namespace sim
+	{
+
+		HistoryEventIndex::HistoryEventIndex()
+		{
+		}
+
+
+		HistoryEventIndex::~HistoryEventIndex()
+		{
+		}
+
+
+		void HistoryEventIndex::Build(const std::vector< std::shared_ptr<HistoryEvent> >& events, const DateTime& baseDateTime)
+		{
+			Clear();
+			BaseDateTime = baseDateTime;
+
+			std::vector<long long> times;
+			std::vector<int> order;
+			times.reserve(events.size());
+			order.reserve(events.size());
+			for (const auto& historyEvent : events)
+			{
+				if (historyEvent)
+				{
+					order.push_back((int)times.size());
+					times.push_back(gpvulc::DateTimeDistanceMs(BaseDateTime, historyEvent->DateTime));
+				}
+				else
+				{
+					times.push_back(0);
+				}
+			}
+			std::stable_sort(order.begin(), order.end(),
+				[&times](int i1, int i2) { return times[i1] < times[i2]; });
+
+			Events.reserve(order.size());
+			EventTimes.reserve(order.size());
+			for (int i : order)
+			{
+				const std::shared_ptr<HistoryEvent>& historyEvent = events[i];
+				if (!historyEvent->EntityId.empty())
+				{
+					EntityEvents[historyEvent->EntityId].push_back((int)Events.size());
+				}
+				Events.push_back(historyEvent);
+				EventTimes.push_back(times[i]);
+			}
+		}
+
+
+		void HistoryEventIndex::Clear()
+		{
+			BaseDateTime.Reset();
+			Events.clear();
+			EventTimes.clear();
+			EntityEvents.clear();
+		}
+
+
+		int HistoryEventIndex::LowerBound(long long timeMs) const
+		{
+			return (int)(std::lower_bound(EventTimes.begin(), EventTimes.end(), timeMs) - EventTimes.begin());
+		}
+
+
+		int HistoryEventIndex::UpperBound(long long timeMs) const
+		{
+			return (int)(std::upper_bound(EventTimes.begin(), EventTimes.end(), timeMs) - EventTimes.begin());
+		}
+
+
+		void HistoryEventIndex::FindEvents(
+			const DateTime& startDateTime,
+			const DateTime& endDateTime,
+			std::vector< std::shared_ptr<HistoryEvent> >& events
+			) const
+		{
+			const int first = LowerBound(gpvulc::DateTimeDistanceMs(BaseDateTime, startDateTime));
+			const int last = UpperBound(gpvulc::DateTimeDistanceMs(BaseDateTime, endDateTime));
+			if (first < last)
+			{
+				events.insert(events.end(), Events.begin() + first, Events.begin() + last);
+			}
+		}
+
+
+		void HistoryEventIndex::FindEntityEvents(
+			const std::string& entityId,
+			std::vector< std::shared_ptr<HistoryEvent> >& events
+			) const
+		{
+			FindEntityEvents(entityId,
+				std::numeric_limits<long long>::min(),
+				std::numeric_limits<long long>::max(),
+				events);
+		}
+
+
+		void HistoryEventIndex::FindEntityEvents(
+			const std::string& entityId,
+			const DateTime& startDateTime,
+			const DateTime& endDateTime,
+			std::vector< std::shared_ptr<HistoryEvent> >& events
+			) const
+		{
+			FindEntityEvents(entityId,
+				gpvulc::DateTimeDistanceMs(BaseDateTime, startDateTime),
+				gpvulc::DateTimeDistanceMs(BaseDateTime, endDateTime),
+				events);
+		}
+
+
+		void HistoryEventIndex::FindEntityEvents(
+			const std::string& entityId,
+			long long startTimeMs,
+			long long endTimeMs,
+			std::vector< std::shared_ptr<HistoryEvent> >& events
+			) const
+		{
+			auto entityIt = EntityEvents.find(entityId);
+			if (entityIt == EntityEvents.end())
+			{
+				return;
+			}
+			const std::vector<int>& positions = entityIt->second;
+
+			// positions are sorted by time, thus they can be searched by time
+			auto first = std::lower_bound(positions.begin(), positions.end(), startTimeMs,
+				[this](int position, long long timeMs) { return EventTimes[position] < timeMs; });
+			auto last = std::upper_bound(first, positions.end(), endTimeMs,
+				[this](long long timeMs, int position) { return timeMs < EventTimes[position]; });
+			for (auto it = first; it != last; ++it)
+			{
+				events.push_back(Events[*it]);
+			}
+		}
+
+	} // namespace sim
+}
@@ -9,12 +9,201 @@
 
 #include <discenfw/sim/HistoryLogParser.h>
 #include <discenfw/sim/ScenarioHistoryData.h>
+#include <discenfw/util/MessageLog.h>
 
 #include <gpvulc/text/text_util.h>
 #include <gpvulc/time/DateTimeUtil.h>
 
-#include <fstream>
-#include <sstream>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <cstring>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+	// Number of tokens in a log line (see HistoryLogParser)
+	const int LOG_LINE_TOKENS = 17;
+
+
+	inline bool IsBlank(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+
+	// Split a line into blank separated tokens, return the number of tokens found
+	// (at most maxTokens, further tokens make the line invalid).
+	int TokenizeLine(
+		const char* lineBegin,
+		const char* lineEnd,
+		const char** tokBegin,
+		const char** tokEnd,
+		int maxTokens
+		)
+	{
+		int count = 0;
+		const char* p = lineBegin;
+		while (p < lineEnd)
+		{
+			while (p < lineEnd && IsBlank(*p))
+			{
+				p++;
+			}
+			if (p == lineEnd)
+			{
+				break;
+			}
+			if (count == maxTokens)
+			{
+				return maxTokens + 1;
+			}
+			tokBegin[count] = p;
+			while (p < lineEnd && !IsBlank(*p))
+			{
+				p++;
+			}
+			tokEnd[count] = p;
+			count++;
+		}
+		return count;
+	}
+
+
+	inline double Pow10(int exponent)
+	{
+		// powers of 10 exactly representable as double
+		static const double exactPow10[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+			1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+			1e21, 1e22
+		};
+		if (exponent <= 22)
+		{
+			return exactPow10[exponent];
+		}
+		return std::pow(10.0, exponent);
+	}
+
+
+	// Fallback for unusual number formats (e.g. "inf", "nan", very long mantissa)
+	bool ParseFloatStrtof(const char* first, const char* last, float& value)
+	{
+		char buffer[64];
+		size_t len = (size_t)(last - first);
+		if (len == 0 || len >= sizeof(buffer))
+		{
+			return false;
+		}
+		memcpy(buffer, first, len);
+		buffer[len] = '\0';
+		char* parseEnd = nullptr;
+		value = strtof(buffer, &parseEnd);
+		return parseEnd == buffer + len;
+	}
+
+
+	// Parse a decimal number without requiring a null-terminated string
+	// (no allocation, no locale, no stream state).
+	bool ParseFloat(const char* first, const char* last, float& value)
+	{
+		const char* p = first;
+		bool negative = false;
+		if (p < last && (*p == '-' || *p == '+'))
+		{
+			negative = (*p == '-');
+			p++;
+		}
+		double mantissa = 0.0;
+		int exponent = 0;
+		int digits = 0;
+		while (p < last && *p >= '0' && *p <= '9')
+		{
+			mantissa = mantissa * 10.0 + (*p - '0');
+			digits++;
+			p++;
+		}
+		if (p < last && *p == '.')
+		{
+			p++;
+			while (p < last && *p >= '0' && *p <= '9')
+			{
+				mantissa = mantissa * 10.0 + (*p - '0');
+				exponent--;
+				digits++;
+				p++;
+			}
+		}
+		if (digits == 0 || digits > 15)
+		{
+			return ParseFloatStrtof(first, last, value);
+		}
+		if (p < last && (*p == 'e' || *p == 'E'))
+		{
+			p++;
+			bool negativeExp = false;
+			if (p < last && (*p == '-' || *p == '+'))
+			{
+				negativeExp = (*p == '-');
+				p++;
+			}
+			int exp = 0;
+			const char* expBegin = p;
+			while (p < last && *p >= '0' && *p <= '9' && exp < 1000)
+			{
+				exp = exp * 10 + (*p - '0');
+				p++;
+			}
+			if (p == expBegin)
+			{
+				return false;
+			}
+			exponent += negativeExp ? -exp : exp;
+		}
+		if (p != last)
+		{
+			return ParseFloatStrtof(first, last, value);
+		}
+		double result = (exponent < 0) ? mantissa / Pow10(-exponent) : mantissa * Pow10(exponent);
+		value = (float)(negative ? -result : result);
+		return true;
+	}
+
+
+	// Cache of the last parsed date/time strings:
+	// consecutive lines usually share the same time stamps
+	// (the end of an interval is the start of the next one).
+	class DateTimeCache
+	{
+	public:
+
+		discenfw::DateTime Parse(const char* first, const char* last)
+		{
+			size_t len = (size_t)(last - first);
+			for (int i = 0; i < 2; i++)
+			{
+				if (Text[i].size() == len && memcmp(Text[i].data(), first, len) == 0)
+				{
+					return Value[i];
+				}
+			}
+			Next = 1 - Next;
+			Text[Next].assign(first, len);
+			Value[Next] = gpvulc::StringToDateTime(Text[Next]);
+			return Value[Next];
+		}
+
+	private:
+		std::string Text[2];
+		discenfw::DateTime Value[2];
+		int Next = 0;
+	};
+}
+
 
 namespace discenfw
 {
@@ -30,9 +219,23 @@ namespace discenfw
 		{
 		}
 
+
 		bool HistoryLogParser::ParseFile(const std::string& logPath, EntityHistory& history)
 		{
-			std::ifstream in(logPath);
+			using namespace boost::interprocess;
+			try
+			{
+				file_mapping logMapping(logPath.c_str(), read_only);
+				mapped_region logRegion(logMapping, read_only);
+				logRegion.advise(mapped_region::advice_sequential);
+				const char* text = static_cast<const char*>(logRegion.get_address());
+				return ParseBuffer(text, text + logRegion.get_size(), history);
+			}
+			catch (const interprocess_exception&)
+			{
+				// fall back to loading the text (e.g. empty files cannot be mapped)
+			}
+
 			std::string logText;
 			if (gpvulc::LoadText(logPath, logText))
 			{
@@ -41,59 +244,170 @@ namespace discenfw
 			return false;
 		}
 
+
 		bool HistoryLogParser::ParseText(const std::string& logText, EntityHistory& history)
 		{
-			std::istringstream textStrStr(logText);
-			std::string line;
-			if (!textStrStr.good())
+			return ParseBuffer(logText.data(), logText.data() + logText.size(), history);
+		}
+
+
+		bool HistoryLogParser::ParseBuffer(const char* textBegin, const char* textEnd, EntityHistory& history)
+		{
+			if (textBegin == nullptr || textEnd < textBegin)
 			{
 				return false;
 			}
-			while (textStrStr.good())
+			const size_t textSize = (size_t)(textEnd - textBegin);
+
+			unsigned threadCount = ThreadCount;
+			if (threadCount == 0)
+			{
+				threadCount = std::max(1u, std::thread::hardware_concurrency());
+			}
+			if (MinChunkSize > 0)
+			{
+				threadCount = (unsigned)std::min<size_t>(threadCount, std::max<size_t>(1, textSize / MinChunkSize));
+			}
+
+			int invalidLines = 0;
+
+			if (threadCount <= 1)
+			{
+				invalidLines = ParseLines(textBegin, textEnd, history.States);
+			}
+			else
 			{
-				std::string startTime;
-				std::string endTime;
-				textStrStr >> startTime;
-				if (!startTime.empty())
+				// split the text in chunks on line boundaries
+				std::vector<const char*> chunkBounds;
+				chunkBounds.push_back(textBegin);
+				for (unsigned i = 1; i < threadCount; i++)
 				{
-					float x;
-					float y;
-					float z;
-					float sc2mt;
-					Vector3D rightAxis;
-					std::string yAxis;
-					std::string zAxis;
-					std::shared_ptr<ElementState> state = std::make_shared<ElementState>();
-					state->StartDateTime = gpvulc::StringToDateTime(startTime);
-					textStrStr >> endTime;
-					state->EndDateTime = gpvulc::StringToDateTime(endTime);
-					textStrStr >> state->Origin;
-					textStrStr >> x >> y >> z;
-					textStrStr >> sc2mt;
-					sc2mt *= ScaleFactor;
-					state->Transform.CoordSys.Origin = { sc2mt*x,sc2mt*z,sc2mt*y };
-					// xAxis
-					textStrStr >> x >> y >> z;
-					state->Transform.CoordSys.RightAxis = { sc2mt*x,sc2mt*z,sc2mt*y };
-					// yAxis
-					textStrStr >> x >> y >> z;
-					state->Transform.CoordSys.UpAxis = { sc2mt*x,sc2mt*z,sc2mt*y };
-					// zAxis
-					textStrStr >> x >> y >> z;
-					state->Transform.CoordSys.ForwardAxis = { sc2mt*x,sc2mt*z,sc2mt*y };
-					textStrStr >> state->Transform.ParentId;
-					state->Transform.UseCoordSys = true;
-					if (state->Transform.ParentId == "ScenarioRoot")
+					const char* bound = textBegin + textSize * i / threadCount;
+					if (bound < chunkBounds.back())
 					{
-						state->Transform.ParentId.clear();
+						bound = chunkBounds.back();
 					}
-					history.States.push_back(state);
+					const char* lineEnd = static_cast<const char*>(memchr(bound, '\n', textEnd - bound));
+					bound = lineEnd ? lineEnd + 1 : textEnd;
+					chunkBounds.push_back(bound);
+				}
+				chunkBounds.push_back(textEnd);
+
+				std::vector< std::vector< std::shared_ptr<TemporalState> > > chunkStates(threadCount);
+				std::vector<int> chunkInvalidLines(threadCount, 0);
+				std::vector<std::thread> workers;
+				workers.reserve(threadCount - 1);
+				for (unsigned i = 1; i < threadCount; i++)
+				{
+					workers.emplace_back([this, i, &chunkBounds, &chunkStates, &chunkInvalidLines]()
+					{
+						chunkInvalidLines[i] = ParseLines(chunkBounds[i], chunkBounds[i + 1], chunkStates[i]);
+					});
+				}
+				// the calling thread parses the first chunk
+				chunkInvalidLines[0] = ParseLines(chunkBounds[0], chunkBounds[1], chunkStates[0]);
+				for (std::thread& worker : workers)
+				{
+					worker.join();
+				}
+
+				size_t stateCount = history.States.size();
+				for (const auto& states : chunkStates)
+				{
+					stateCount += states.size();
 				}
+				history.States.reserve(stateCount);
+				for (unsigned i = 0; i < threadCount; i++)
+				{
+					std::move(chunkStates[i].begin(), chunkStates[i].end(), std::back_inserter(history.States));
+					invalidLines += chunkInvalidLines[i];
+				}
+			}
+
+			if (invalidLines > 0)
+			{
+				LogMessage(LOG_WARNING,
+					"History log: " + std::to_string(invalidLines) + " invalid lines skipped.",
+					"DiScenFw|Sim");
 			}
 
 			return true;
 		}
 
 
+		int HistoryLogParser::ParseLines(
+			const char* textBegin,
+			const char* textEnd,
+			std::vector< std::shared_ptr<TemporalState> >& states
+			) const
+		{
+			// pre-allocate room for all the lines
+			size_t lineCount = (size_t)std::count(textBegin, textEnd, '\n') + 1;
+			states.reserve(states.size() + lineCount);
+
+			DateTimeCache dateTimeCache;
+			const char* tokBegin[LOG_LINE_TOKENS];
+			const char* tokEnd[LOG_LINE_TOKENS];
+			int invalidLines = 0;
+
+			const char* lineBegin = textBegin;
+			while (lineBegin < textEnd)
+			{
+				const char* lineEnd = static_cast<const char*>(memchr(lineBegin, '\n', textEnd - lineBegin));
+				if (!lineEnd)
+				{
+					lineEnd = textEnd;
+				}
+
+				int tokCount = TokenizeLine(lineBegin, lineEnd, tokBegin, tokEnd, LOG_LINE_TOKENS);
+				lineBegin = lineEnd + 1;
+				if (tokCount == 0)
+				{
+					// skip empty lines
+					continue;
+				}
+				if (tokCount != LOG_LINE_TOKENS)
+				{
+					invalidLines++;
+					continue;
+				}
+
+				// origin, scale, right axis, up axis, forward axis
+				float values[13];
+				bool valid = true;
+				for (int i = 0; i < 13 && valid; i++)
+				{
+					valid = ParseFloat(tokBegin[3 + i], tokEnd[3 + i], values[i]);
+				}
+				if (!valid)
+				{
+					invalidLines++;
+					continue;
+				}
+
+				std::shared_ptr<ElementState> state = std::make_shared<ElementState>();
+				state->StartDateTime = dateTimeCache.Parse(tokBegin[0], tokEnd[0]);
+				state->EndDateTime = dateTimeCache.Parse(tokBegin[1], tokEnd[1]);
+				state->Origin.assign(tokBegin[2], tokEnd[2]);
+
+				const float sc2mt = values[3] * ScaleFactor;
+				state->Transform.CoordSys.Origin = { sc2mt*values[0],sc2mt*values[2],sc2mt*values[1] };
+				state->Transform.CoordSys.RightAxis = { sc2mt*values[4],sc2mt*values[6],sc2mt*values[5] };
+				state->Transform.CoordSys.UpAxis = { sc2mt*values[7],sc2mt*values[9],sc2mt*values[8] };
+				state->Transform.CoordSys.ForwardAxis = { sc2mt*values[10],sc2mt*values[12],sc2mt*values[11] };
+
+				const size_t parentIdLen = (size_t)(tokEnd[16] - tokBegin[16]);
+				if (parentIdLen != 12 || memcmp(tokBegin[16], "ScenarioRoot", 12) != 0)
+				{
+					state->Transform.ParentId.assign(tokBegin[16], tokEnd[16]);
+				}
+				state->Transform.UseCoordSys = true;
+				states.push_back(state);
+			}
+
+			return invalidLines;
+		}
+
+
 	} // namespace disenapi
 }
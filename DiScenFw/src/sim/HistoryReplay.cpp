@@ -0,0 +1,282 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/sim/HistoryReplay.h>
+#include <discenfw/sim/HistoryArchive.h>
+#include <discenfw/sim/HistoryEventIndex.h>
+#include <discenfw/util/MessageLog.h>
+#include <discenfw/util/DateTimeUtil.h>
+
+#include <gpvulc/time/DateTimeUtil.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	using namespace discenfw;
+	using namespace discenfw::sim;
+
+
+	// Forward-only cursor on the states of an entity.
+	struct EntityCursor
+	{
+		std::string EntityId;
+		int StateCount = 0;
+		std::function<long long(int)> StartMs;
+		std::function<long long(int)> EndMs;
+		std::function<std::shared_ptr<TemporalState>(int)> GetState;
+
+		// last state started at or before the current time (-1 if none)
+		int Index = -1;
+
+		// decoded states for Index and Index+1 (slot = index parity)
+		std::shared_ptr<ElementState> Cached[2];
+		int CachedIndex[2] = { -1, -1 };
+
+
+		std::shared_ptr<ElementState> GetElementState(int stateIndex)
+		{
+			const int slot = stateIndex & 1;
+			if (CachedIndex[slot] != stateIndex)
+			{
+				std::shared_ptr<TemporalState> state = GetState(stateIndex);
+				Cached[slot] = (state && state->IsA("ElementState"))
+					? std::static_pointer_cast<ElementState>(state) : nullptr;
+				CachedIndex[slot] = stateIndex;
+			}
+			return Cached[slot];
+		}
+
+
+		// Fill the frame with the state at the given time
+		// (the same selection made by SimulationExecutor, without binary search).
+		bool Evaluate(long long timeMs, HistoryReplay::Frame& frame)
+		{
+			while (Index + 1 < StateCount && StartMs(Index + 1) <= timeMs)
+			{
+				Index++;
+			}
+			frame.NextState = nullptr;
+			frame.Lerp = 0.0f;
+			if (Index < 0)
+			{
+				// before the first state
+				frame.State = GetElementState(0);
+			}
+			else if (timeMs <= EndMs(Index) || Index + 1 >= StateCount)
+			{
+				// inside a state or after the last one
+				frame.State = GetElementState(Index);
+			}
+			else
+			{
+				// between two states
+				frame.State = GetElementState(Index);
+				frame.NextState = GetElementState(Index + 1);
+				const long long gapStart = EndMs(Index);
+				const long long gap = StartMs(Index + 1) - gapStart;
+				frame.Lerp = gap > 0 ? (float)((double)(timeMs - gapStart) / (double)gap) : 0.0f;
+			}
+			return frame.State != nullptr;
+		}
+	};
+
+
+	long long ReplaySteps(
+		std::vector<EntityCursor>& cursors,
+		long long startMs,
+		long long endMs,
+		long long stepMs,
+		const std::function<DateTime(long long)>& toDateTime,
+		const HistoryEventIndex& eventIndex,
+		const HistoryReplay::FrameSink& frameSink,
+		const HistoryReplay::EventSink& eventSink
+		)
+	{
+		HistoryReplay::Frame frame;
+		int nextEvent = 0;
+		long long step = 0;
+		long long timeMs = startMs;
+		for (;;)
+		{
+			frame.Step = step;
+			frame.Time = (double)(timeMs - startMs) / 1000.0;
+			frame.DateTime = toDateTime(timeMs);
+			if (frameSink)
+			{
+				for (EntityCursor& cursor : cursors)
+				{
+					if (cursor.Evaluate(timeMs, frame))
+					{
+						frame.EntityId = cursor.EntityId;
+						frameSink(frame);
+					}
+				}
+			}
+			if (eventSink)
+			{
+				const int lastEvent = eventIndex.UpperBound(timeMs);
+				for (; nextEvent < lastEvent; nextEvent++)
+				{
+					eventSink(frame.Time, eventIndex.GetEvent(nextEvent));
+				}
+			}
+			step++;
+			if (timeMs >= endMs)
+			{
+				break;
+			}
+			// steps are computed from the start time to avoid accumulating errors,
+			// the last step is clamped to the end time
+			timeMs = std::min(endMs, startMs + step * stepMs);
+		}
+		return step;
+	}
+}
+
+
+namespace discenfw
+{
+	namespace sim
+	{
+
+		HistoryReplay::HistoryReplay()
+		{
+		}
+
+
+		HistoryReplay::~HistoryReplay()
+		{
+		}
+
+
+		long long HistoryReplay::Run(const ScenarioHistory& history)
+		{
+			// find the time interval covered by the entity states
+			DateTime baseDateTime;
+			DateTime endDateTime;
+			bool baseFound = false;
+			for (const auto& entityHistory : history.EntityHistories)
+			{
+				if (!entityHistory.second)
+				{
+					continue;
+				}
+				for (const auto& state : entityHistory.second->States)
+				{
+					if (!DateTimeDefined(state->StartDateTime))
+					{
+						continue;
+					}
+					if (!baseFound || state->StartDateTime < baseDateTime)
+					{
+						baseDateTime = state->StartDateTime;
+					}
+					if (!baseFound || endDateTime < state->EndDateTime)
+					{
+						endDateTime = state->EndDateTime;
+					}
+					baseFound = true;
+				}
+			}
+			if (!baseFound)
+			{
+				LogMessage(LOG_WARNING, "No state to replay in history " + history.Name, "DiScenFw|Sim");
+				return 0;
+			}
+
+			// convert state times once, the replay loop compares only integers
+			std::vector<EntityCursor> cursors;
+			for (const auto& entityHistory : history.EntityHistories)
+			{
+				if (!entityHistory.second || entityHistory.second->States.empty())
+				{
+					continue;
+				}
+				const std::vector< std::shared_ptr<TemporalState> >& states = entityHistory.second->States;
+				auto startTimes = std::make_shared< std::vector<long long> >(states.size());
+				auto endTimes = std::make_shared< std::vector<long long> >(states.size());
+				for (size_t i = 0; i < states.size(); i++)
+				{
+					(*startTimes)[i] = gpvulc::DateTimeDistanceMs(baseDateTime, states[i]->StartDateTime);
+					(*endTimes)[i] = gpvulc::DateTimeDistanceMs(baseDateTime, states[i]->EndDateTime);
+				}
+				EntityCursor cursor;
+				cursor.EntityId = entityHistory.first;
+				cursor.StateCount = (int)states.size();
+				cursor.StartMs = [startTimes](int i) { return (*startTimes)[i]; };
+				cursor.EndMs = [endTimes](int i) { return (*endTimes)[i]; };
+				cursor.GetState = [&states](int i) { return states[i]; };
+				cursors.push_back(cursor);
+			}
+
+			HistoryEventIndex eventIndex;
+			if (OnEvent)
+			{
+				eventIndex.Build(history.Events, baseDateTime);
+			}
+
+			return ReplaySteps(cursors, 0, gpvulc::DateTimeDistanceMs(baseDateTime, endDateTime), GetTimeStepMs(),
+				[&baseDateTime](long long timeMs) { return DateTimeAddLongMs(baseDateTime, timeMs); },
+				eventIndex, OnFrame, OnEvent);
+		}
+
+
+		long long HistoryReplay::Run(const HistoryArchive& archive)
+		{
+			if (!archive.IsOpen())
+			{
+				LogMessage(LOG_ERROR, "History archive not open", "DiScenFw|Sim");
+				return 0;
+			}
+
+			// state times are read from the mapped columns, states are decoded only when reached
+			std::vector<EntityCursor> cursors;
+			const HistoryArchive* source = &archive;
+			for (int e = 0; e < archive.GetEntityCount(); e++)
+			{
+				EntityCursor cursor;
+				cursor.StateCount = archive.GetStateCount(e);
+				if (cursor.StateCount == 0)
+				{
+					continue;
+				}
+				cursor.EntityId = archive.GetEntityId(e);
+				cursor.StartMs = [source, e](int i) { return source->GetStateStartMs(e, i); };
+				cursor.EndMs = [source, e](int i) { return source->GetStateEndMs(e, i); };
+				cursor.GetState = [source, e](int i) { return source->GetState(e, i); };
+				cursors.push_back(cursor);
+			}
+
+			HistoryEventIndex eventIndex;
+			if (OnEvent)
+			{
+				std::vector< std::shared_ptr<HistoryEvent> > events;
+				for (int i = 0; i < archive.GetEventCount(); i++)
+				{
+					events.push_back(archive.GetEvent(i));
+				}
+				eventIndex.Build(events, archive.ToDateTime(0));
+			}
+
+			return ReplaySteps(cursors, archive.GetStartTimeMs(), archive.GetEndTimeMs(), GetTimeStepMs(),
+				[source](long long timeMs) { return source->ToDateTime(timeMs); },
+				eventIndex, OnFrame, OnEvent);
+		}
+
+
+		long long HistoryReplay::GetTimeStepMs() const
+		{
+			return std::max(1LL, (long long)std::llround(TimeStep * 1000.0));
+		}
+
+	} // namespace sim
+}
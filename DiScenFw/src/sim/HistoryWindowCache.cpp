@@ -0,0 +1,161 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/sim/HistoryWindowCache.h>
+#include <discenfw/sim/HistoryArchive.h>
+
+#include <algorithm>
+
+namespace
+{
+	// Approximate memory used by a decoded state (object, control block, vector slot).
+	const size_t STATE_BASE_BYTES = sizeof(discenfw::sim::ElementState) + 2 * sizeof(void*)
+		+ sizeof(std::shared_ptr<discenfw::sim::TemporalState>);
+
+
+	size_t EstimateStateBytes(const discenfw::sim::TemporalState& state)
+	{
+		size_t bytes = STATE_BASE_BYTES + state.Origin.capacity();
+		if (state.IsA("ElementState"))
+		{
+			const discenfw::sim::ElementState& elementState = static_cast<const discenfw::sim::ElementState&>(state);
+			bytes += elementState.Transform.ParentId.capacity() + elementState.Representation.capacity();
+		}
+		return bytes;
+	}
+}
+
+
+namespace discenfw
+{
+	namespace sim
+	{
+
+		HistoryWindowCache::HistoryWindowCache(
+			const std::shared_ptr<HistoryArchive>& archive,
+			size_t memoryBudget,
+			int segmentSize
+			)
+			: Archive(archive), MemoryBudget(memoryBudget), SegmentSize(std::max(1, segmentSize))
+		{
+		}
+
+
+		HistoryWindowCache::~HistoryWindowCache()
+		{
+		}
+
+
+		void HistoryWindowCache::SetMemoryBudget(size_t memoryBudget)
+		{
+			MemoryBudget = memoryBudget;
+			EvictSegments();
+		}
+
+
+		bool HistoryWindowCache::UpdateWindow(int entityIndex, long long timeMs, EntityHistory& history)
+		{
+			if (!Archive || !Archive->IsOpen())
+			{
+				return false;
+			}
+			const int stateCount = Archive->GetStateCount(entityIndex);
+			if (stateCount == 0)
+			{
+				return false;
+			}
+			const int lastSegment = (stateCount - 1) / SegmentSize;
+			int stateIndex = std::max(0, Archive->FindStateIndex(entityIndex, timeMs));
+			const int centerSegment = stateIndex / SegmentSize;
+
+			auto windowIt = WindowCenters.find(entityIndex);
+			if (windowIt != WindowCenters.end() && windowIt->second == centerSegment)
+			{
+				return false;
+			}
+			WindowCenters[entityIndex] = centerSegment;
+
+			// load the segment at the cursor and its neighbours
+			// (previous and next states are needed for interpolation)
+			const int firstSegment = std::max(0, centerSegment - 1);
+			const int endSegment = std::min(lastSegment, centerSegment + 1) + 1;
+			history.States.clear();
+			for (int i = firstSegment; i < endSegment; i++)
+			{
+				Segment& segment = LoadSegment(entityIndex, i);
+				segment.LastAccess = ++AccessCount;
+				history.States.insert(history.States.end(), segment.States.begin(), segment.States.end());
+			}
+
+			EvictSegments();
+			return true;
+		}
+
+
+		void HistoryWindowCache::Clear()
+		{
+			Segments.clear();
+			WindowCenters.clear();
+			ResidentBytes = 0;
+		}
+
+
+		HistoryWindowCache::Segment& HistoryWindowCache::LoadSegment(int entityIndex, int segmentIndex)
+		{
+			Segment& segment = Segments[std::make_pair(entityIndex, segmentIndex)];
+			if (segment.States.empty())
+			{
+				Archive->LoadEntityStates(entityIndex, segmentIndex * SegmentSize, SegmentSize, segment.States);
+				for (const auto& state : segment.States)
+				{
+					segment.Bytes += EstimateStateBytes(*state);
+				}
+				ResidentBytes += segment.Bytes;
+			}
+			return segment;
+		}
+
+
+		void HistoryWindowCache::EvictSegments()
+		{
+			if (ResidentBytes <= MemoryBudget)
+			{
+				return;
+			}
+
+			// collect the segments that are not in a current window, least recently used first
+			std::vector< std::pair<unsigned long long, std::pair<int, int> > > candidates;
+			for (const auto& segmentPair : Segments)
+			{
+				const int entityIndex = segmentPair.first.first;
+				const int segmentIndex = segmentPair.first.second;
+				auto windowIt = WindowCenters.find(entityIndex);
+				if (windowIt != WindowCenters.end()
+					&& segmentIndex >= windowIt->second - 1 && segmentIndex <= windowIt->second + 1)
+				{
+					continue;
+				}
+				candidates.push_back(std::make_pair(segmentPair.second.LastAccess, segmentPair.first));
+			}
+			std::sort(candidates.begin(), candidates.end());
+
+			for (const auto& candidate : candidates)
+			{
+				if (ResidentBytes <= MemoryBudget)
+				{
+					break;
+				}
+				auto segmentIt = Segments.find(candidate.second);
+				ResidentBytes -= segmentIt->second.Bytes;
+				Segments.erase(segmentIt);
+			}
+		}
+
+	} // namespace sim
+}
@@ -8,6 +8,8 @@
 //
 
 #include <discenfw/sim/SimulationController.h>
+#include <discenfw/sim/HistoryArchive.h>
+#include <discenfw/sim/HistoryWindowCache.h>
 
 #include <discenfw/util/MessageLog.h>
 #include <gpvulc/time/DateTimeUtil.h>
@@ -134,6 +136,8 @@ namespace discenfw
 				return false;
 			}
 			SimulationUpdateTime = -1.0f;
+			WindowCache.reset();
+			WindowedEntities.clear();
 			DateTime maxDateTime = { 9999,12,31,23,59,59,0,0,0 };
 			DateTime minDateTime = { 1400,1,1,0,0,0,0,0,0 };
 
@@ -164,19 +168,10 @@ namespace discenfw
 				{
 					SimulationHistory->EndDateTime = history->EndDateTime;
 				}
-				auto& exec = Executors[entityId];
-				if (!exec)
-				{
-					exec = std::make_shared<SimulationExecutor>();
-				}
-				exec->History = history;
-				exec->TargetElement = Scenario->GetElementById(entityId);
-				if (!exec->TargetElement)
-				{
-					LogMessage(LOG_WARNING, "Missing target element "+entityId, "DiScenFw|Sim", true, true);
-				}
+				InitExecutor(entityId, history);
 			}
 			SimulationDuration = gpvulc::DateTimeDistanceSecD(SimulationHistory->StartDateTime, SimulationHistory->EndDateTime);
+			InitEventIndex();
 			LogMessage(LOG_DEBUG, "Simulation loaded.", "DiScenFw|Sim", true, true);
 			if (SimulationLoaded)
 			{
@@ -186,6 +181,64 @@ namespace discenfw
 		}
 
 
+		bool SimulationController::InitSimulation(const std::shared_ptr<HistoryArchive>& archive)
+		{
+			if (!archive || !archive->IsOpen())
+			{
+				return false;
+			}
+			SimulationUpdateTime = -1.0f;
+			Executors.clear();
+			WindowedEntities.clear();
+			WindowCache = std::make_shared<HistoryWindowCache>(archive, HistoryMemoryBudget);
+
+			// only the time intervals are read here, states are loaded on demand
+			SimulationHistory = std::make_shared<ScenarioHistory>();
+			archive->GetInfo(*SimulationHistory);
+			SimulationHistory->StartDateTime = archive->ToDateTime(archive->GetStartTimeMs());
+			SimulationHistory->EndDateTime = archive->ToDateTime(archive->GetEndTimeMs());
+			const int eventCount = archive->GetEventCount();
+			SimulationHistory->Events.reserve(eventCount);
+			for (int i = 0; i < eventCount; i++)
+			{
+				SimulationHistory->Events.push_back(archive->GetEvent(i));
+			}
+
+			const int entityCount = archive->GetEntityCount();
+			for (int i = 0; i < entityCount; i++)
+			{
+				std::string entityId = archive->GetEntityId(i);
+				std::shared_ptr<EntityHistory> history = std::make_shared<EntityHistory>();
+				history->StartDateTime = archive->ToDateTime(archive->GetEntityStartMs(i));
+				history->EndDateTime = archive->ToDateTime(archive->GetEntityEndMs(i));
+				SimulationHistory->EntityHistories[entityId] = history;
+				WindowedEntities[entityId] = i;
+				InitExecutor(entityId, history);
+			}
+			SimulationDuration = (double)(archive->GetEndTimeMs() - archive->GetStartTimeMs()) / 1000.0;
+			SimulationTime = 0;
+			UpdateHistoryWindows();
+			InitEventIndex();
+
+			LogMessage(LOG_DEBUG, "Simulation loaded (windowed).", "DiScenFw|Sim", true, true);
+			if (SimulationLoaded)
+			{
+				SimulationLoaded();
+			}
+			return true;
+		}
+
+
+		void SimulationController::SetHistoryMemoryBudget(size_t memoryBudget)
+		{
+			HistoryMemoryBudget = memoryBudget;
+			if (WindowCache)
+			{
+				WindowCache->SetMemoryBudget(memoryBudget);
+			}
+		}
+
+
 		bool SimulationController::SimulationDefined()
 		{
 			return SimulationHistory && !SimulationHistory->EntityHistories.empty();
@@ -294,11 +347,13 @@ namespace discenfw
 				pauseSim = SimulationTimeSpeed < 0;
 			}
 			SimulationDateTime = gpvulc::DateTimeAddMs(SimulationHistory->StartDateTime, (long)(SimulationTime*1000.0));
+			UpdateHistoryWindows();
 
 			for (auto& executorPair : Executors)
 			{
 				executorPair.second->Update(SimulationDateTime);
 			}
+			TriggerHistoryEvents();
 			if (SimulationUpdated)
 			{
 				SimulationUpdated();
@@ -320,6 +375,57 @@ namespace discenfw
 		}
 
 
+		void SimulationController::InitExecutor(const std::string& entityId, const std::shared_ptr<EntityHistory>& history)
+		{
+			auto& exec = Executors[entityId];
+			if (!exec)
+			{
+				exec = std::make_shared<SimulationExecutor>();
+			}
+			exec->History = history;
+			exec->TargetElement = Scenario->GetElementById(entityId);
+			if (!exec->TargetElement)
+			{
+				LogMessage(LOG_WARNING, "Missing target element "+entityId, "DiScenFw|Sim", true, true);
+			}
+		}
+
+
+		void SimulationController::UpdateHistoryWindows()
+		{
+			if (!WindowCache)
+			{
+				return;
+			}
+			const long long timeMs = WindowCache->GetArchive()->GetStartTimeMs() + (long long)(SimulationTime*1000.0);
+			for (const auto& entityPair : WindowedEntities)
+			{
+				WindowCache->UpdateWindow(entityPair.second, timeMs, *Executors[entityPair.first]->History);
+			}
+		}
+
+
+		void SimulationController::InitEventIndex()
+		{
+			EventIndex.Build(SimulationHistory->Events, SimulationHistory->StartDateTime);
+			NextEventPosition = 0;
+		}
+
+
+		void SimulationController::TriggerHistoryEvents()
+		{
+			const int eventPosition = EventIndex.UpperBound((long long)(SimulationTime*1000.0));
+			if (HistoryEventReached)
+			{
+				for (int i = NextEventPosition; i < eventPosition; i++)
+				{
+					HistoryEventReached(EventIndex.GetEvent(i));
+				}
+			}
+			NextEventPosition = eventPosition;
+		}
+
+
 	} // namespace sim
 }
 
@@ -12,6 +12,7 @@
 #include <discenfw/sim/SimulationManager.h>
 #include <discenfw/sim/ScenarioHistoryData.h>
 #include <discenfw/sim/HistoryLogParser.h>
+#include <discenfw/sim/HistoryArchive.h>
 #include "../JSON/JsonHistory.h"
 
 #include <discenfw/scen/ScenarioData.h>
@@ -168,6 +169,10 @@ namespace discenfw
 
 		bool SimulationManager::SaveHistoryJson(const std::string& jsonFile)
 		{
+			if (!CheckHistoryComplete(jsonFile))
+			{
+				return false;
+			}
 			std::string jsonText;
 			HistoryToJson(jsonText);
 			if (gpvulc::SaveText(jsonFile, jsonText))
@@ -180,6 +185,76 @@ namespace discenfw
 			return false;
 		}
 
+
+		bool SimulationManager::LoadHistoryArchive(const std::string& archiveFile)
+		{
+			if (!HistoryData)
+			{
+				HistoryData = std::make_shared<ScenarioHistory>();
+				Simulation->SimulationHistory = HistoryData;
+			}
+			HistoryArchive archive;
+			if (archive.Open(archiveFile) && archive.Load(*HistoryData))
+			{
+				HistoryPath = archiveFile;
+				LoadHistoryLogs();
+				Simulation->Scenario = this->ScenarioData;
+				Simulation->InitSimulation();
+				return true;
+			}
+			LogMessage(LOG_ERROR, "Failed to load " + archiveFile, "DiScenFw|Sim");
+
+			return false;
+		}
+
+
+		bool SimulationManager::SaveHistoryArchive(const std::string& archiveFile)
+		{
+			if (!CheckHistoryComplete(archiveFile))
+			{
+				return false;
+			}
+			if (HistoryData && HistoryArchive::Write(archiveFile, *HistoryData))
+			{
+				HistoryPath = archiveFile;
+				return true;
+			}
+			LogMessage(LOG_ERROR, "Failed to save " + archiveFile, "DiScenFw|Sim");
+
+			return false;
+		}
+
+
+		bool SimulationManager::OpenHistoryArchive(const std::string& archiveFile)
+		{
+			std::shared_ptr<HistoryArchive> archive = std::make_shared<HistoryArchive>();
+			Simulation->Scenario = this->ScenarioData;
+			if (archive->Open(archiveFile) && Simulation->InitSimulation(archive))
+			{
+				HistoryData = Simulation->SimulationHistory;
+				HistoryPath = archiveFile;
+				return true;
+			}
+			LogMessage(LOG_ERROR, "Failed to open " + archiveFile, "DiScenFw|Sim");
+
+			return false;
+		}
+
+
+		bool SimulationManager::CheckHistoryComplete(const std::string& filePath)
+		{
+			// only the segments around the simulation time are in memory,
+			// saving them would truncate the history (and overwrite the archive still mapped)
+			if (Simulation->IsHistoryWindowed())
+			{
+				LogMessage(LOG_ERROR, "Cannot save " + filePath + ": the history is streamed from " + HistoryPath
+					+ " (see OpenHistoryArchive())", "DiScenFw|Sim");
+				return false;
+			}
+			return true;
+		}
+
+
 		void SimulationManager::ClearSimulation()
 		{
 			//if (Simulation) Simulation->StopSimulation();
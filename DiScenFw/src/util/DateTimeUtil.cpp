@@ -54,6 +54,23 @@ namespace discenfw
 	}
 
 
+	DateTime DateTimeAddLongMs(const DateTime& dateTime, long long ms)
+	{
+		// split the offset to avoid overflows with 32 bit long (day-long recordings exceed 2^31 ms)
+		long long sec = ms / 1000;
+		int h = (int)(sec / 3600);
+		int m = (int)((sec % 3600) / 60);
+		int s = (int)(sec % 60);
+		return gpvulc::DateTimeAdd(dateTime, h, m, s, (int)(ms % 1000));
+	}
+
+
+	bool DateTimeDefined(const DateTime& dateTime)
+	{
+		return dateTime.Month > 0 && dateTime.Day > 0;
+	}
+
+
 	//-------------------------------------------------------------------
 	// time-string conversion
 
@@ -22,15 +22,24 @@
 
 #endif
 
+#include <mutex>
 #include <random>
 
 namespace
 {
 	// This is used to obtain a seed for the random number engine
 	static std::random_device rd;
+	static std::mutex rdMutex;
 
-	// Standard mersenne_twister_engine seeded with rd()
-	static std::mt19937 gRandomEngine(rd());
+	unsigned RandomSeed()
+	{
+		std::lock_guard<std::mutex> lock(rdMutex);
+		return rd();
+	}
+
+	// Standard mersenne_twister_engine seeded with rd(),
+	// one for each thread (agents can act in parallel threads)
+	thread_local std::mt19937 gRandomEngine(RandomSeed());
 }
 
 
@@ -0,0 +1,121 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/xp/CompactEpisodeStore.h>
+
+
+namespace discenfw
+{
+	namespace xp
+	{
+
+		CompactEpisodeStore::CompactEpisodeStore()
+		{
+			Clear();
+		}
+
+
+		size_t CompactEpisodeStore::AddEpisode(const std::shared_ptr<Episode>& episode)
+		{
+			for (const Transition& transition : episode->TransitionSequence)
+			{
+				StartStateIds.push_back(GetStateId(transition.StartState));
+				ActionIdSequence.push_back(GetActionId(transition.ActionTaken));
+				EndStateIds.push_back(GetStateId(transition.EndState));
+			}
+			EpisodeOffsets.push_back((uint32_t)StartStateIds.size());
+			InitialStateIds.push_back(GetStateId(episode->InitialState));
+			LastStateIds.push_back(GetStateId(episode->LastState));
+			Performances.push_back(episode->Performance);
+			Results.push_back(episode->Result);
+			RepetitionsCounts.push_back(episode->RepetitionsCount);
+			Fingerprints.push_back(episode->GetFingerprint());
+			return Results.size() - 1;
+		}
+
+
+		void CompactEpisodeStore::Clear()
+		{
+			States.assign(1, nullptr);
+			Actions.assign(1, nullptr);
+			StateIds.clear();
+			ActionIds.clear();
+			EpisodeOffsets.assign(1, 0);
+			InitialStateIds.clear();
+			LastStateIds.clear();
+			Performances.clear();
+			Results.clear();
+			RepetitionsCounts.clear();
+			Fingerprints.clear();
+			StartStateIds.clear();
+			ActionIdSequence.clear();
+			EndStateIds.clear();
+		}
+
+
+		size_t CompactEpisodeStore::GetMemoryUsage() const
+		{
+			return States.capacity() * sizeof(StateRef) + Actions.capacity() * sizeof(ActionRef)
+				+ (StateIds.size() + ActionIds.size()) * (sizeof(void*) * 2 + sizeof(uint32_t))
+				+ (EpisodeOffsets.capacity() + InitialStateIds.capacity() + LastStateIds.capacity()) * sizeof(uint32_t)
+				+ (Performances.capacity() + RepetitionsCounts.capacity()) * sizeof(int)
+				+ Results.capacity() * sizeof(ActionResult) + Fingerprints.capacity() * sizeof(size_t)
+				+ (StartStateIds.capacity() + ActionIdSequence.capacity() + EndStateIds.capacity()) * sizeof(uint32_t);
+		}
+
+
+		void CompactEpisodeStore::MarkReachableStates(StateMarkSet& reachableStates) const
+		{
+			// the first element is null
+			for (size_t i = 1; i < States.size(); i++)
+			{
+				reachableStates.insert(States[i].get());
+			}
+		}
+
+
+		uint32_t CompactEpisodeStore::GetStateId(const StateRef& state)
+		{
+			if (!state)
+			{
+				return 0;
+			}
+			// states are stored once in the environment model, they can be identified by address
+			const auto& idIt = StateIds.find(state.get());
+			if (idIt != StateIds.cend())
+			{
+				return idIt->second;
+			}
+			const uint32_t id = (uint32_t)States.size();
+			States.push_back(state);
+			StateIds[state.get()] = id;
+			return id;
+		}
+
+
+		uint32_t CompactEpisodeStore::GetActionId(const ActionRef& action)
+		{
+			if (!action)
+			{
+				return 0;
+			}
+			// actions are encoded once in the environment model, they can be identified by address
+			const auto& idIt = ActionIds.find(action.get());
+			if (idIt != ActionIds.cend())
+			{
+				return idIt->second;
+			}
+			const uint32_t id = (uint32_t)Actions.size();
+			Actions.push_back(action);
+			ActionIds[action.get()] = id;
+			return id;
+		}
+
+	} // namespace xp
+}
@@ -35,6 +35,7 @@ namespace discenfw
 
 		CyberSystemAgent::~CyberSystemAgent()
 		{
+			StopLearner();
 		}
 
 
@@ -114,7 +115,7 @@ namespace discenfw
 					UpdateStats(result);
 					if (LearningEnabled)
 					{
-						GetAgent()->Learn(experience, CurrentEpisode->TransitionSequence, result);
+						Learn(experience, CurrentEpisode->TransitionSequence, result);
 					}
 				}
 			}
@@ -123,6 +124,94 @@ namespace discenfw
 
 
 
+		void CyberSystemAgent::SetAsyncLearningEnabled(bool enabled)
+		{
+			AsyncLearningEnabled = enabled;
+			if (!enabled)
+			{
+				StopLearner();
+			}
+			else if (!LearnerThread.joinable())
+			{
+				LearnerThread = std::thread(&CyberSystemAgent::RunLearner, this);
+			}
+		}
+
+
+		void CyberSystemAgent::SetMaxLearningLag(int maxLearningLag)
+		{
+			std::lock_guard<std::mutex> lock(LearningMutex);
+			MaxLearningLag = maxLearningLag > 0 ? maxLearningLag : 1;
+			LearningCondition.notify_all();
+		}
+
+
+		void CyberSystemAgent::FlushLearning()
+		{
+			std::unique_lock<std::mutex> lock(LearningMutex);
+			LearningCondition.wait(lock, [this]() { return PendingLearningSteps == 0; });
+		}
+
+
+		void CyberSystemAgent::MarkReachableStates(StateMarkSet& reachableStates) const
+		{
+			CyberSystemAssistant::MarkReachableStates(reachableStates);
+			for (const auto& agentPair : Agents)
+			{
+				if (agentPair.second)
+				{
+					agentPair.second->MarkReachableStates(reachableStates);
+				}
+			}
+			for (const auto& visitCount : StateVisitCount)
+			{
+				reachableStates.insert(visitCount.first.get());
+			}
+			for (const StateRef& state : StateSet)
+			{
+				reachableStates.insert(state.get());
+			}
+			for (const auto& deadlock : DeadlockActions)
+			{
+				reachableStates.insert(deadlock.first.get());
+			}
+			reachableStates.insert(LastTransition.StartState.get());
+			reachableStates.insert(LastTransition.EndState.get());
+			if (PolicyTable)
+			{
+				PolicyTable->MarkReachableStates(reachableStates);
+			}
+		}
+
+
+		bool CyberSystemAgent::SaveExperience(const std::string& fileName, const std::string& goalName, bool saveAll)
+		{
+			FlushLearning();
+			return DigitalAssistant::SaveExperience(fileName, goalName, saveAll);
+		}
+
+
+		bool CyberSystemAgent::SaveCheckpoint(const std::string& fileName, const std::string& goalName, bool saveAll)
+		{
+			FlushLearning();
+			return DigitalAssistant::SaveCheckpoint(fileName, goalName, saveAll);
+		}
+
+
+		bool CyberSystemAgent::LoadExperience(const std::string& fileName, bool loadAll)
+		{
+			FlushLearning();
+			return DigitalAssistant::LoadExperience(fileName, loadAll);
+		}
+
+
+		bool CyberSystemAgent::MergeExperiences(const std::vector<std::string>& fileNames, unsigned threadCount)
+		{
+			FlushLearning();
+			return DigitalAssistant::MergeExperiences(fileNames, threadCount);
+		}
+
+
 		/*!
 		Get the reinforcement learning configuration parameters (see RLConfig).
 		*/
@@ -139,6 +228,7 @@ namespace discenfw
 
 		void CyberSystemAgent::SetAgentConfiguration(const std::shared_ptr<IAgentConfiguration> config)
 		{
+			FlushLearning();
 			GetAgent()->SetConfiguration(config);
 			AgentConfiguration = GetAgent()->GetConfiguration();
 		}
@@ -158,6 +248,7 @@ namespace discenfw
 
 		void CyberSystemAgent::ResetAgentForCurrentGoal()
 		{
+			FlushLearning();
 			StateVisitCount.clear();
 			StateSet.clear();
 			DeadlockActions.clear();
@@ -169,6 +260,7 @@ namespace discenfw
 
 		void CyberSystemAgent::ResetAgent()
 		{
+			FlushLearning();
 			for (auto& agentPair : Agents)
 			{
 				agentPair.second->Reset();
@@ -200,6 +292,7 @@ namespace discenfw
 
 		void CyberSystemAgent::SetCustomAgentMaker(std::function<std::shared_ptr<IAgent>()> makeAgentCallback)
 		{
+			FlushLearning();
 			Agents.clear();
 			CustomAgentMaker = makeAgentCallback;
 		}
@@ -244,10 +337,18 @@ namespace discenfw
 				}
 				std::shared_ptr<EnvironmentState> initState = GetLastState();
 				RegisterState(initState);
+				LastActionResult = ActionResult::IN_PROGRESS;
 			}
 		}
 
 
+		bool CyberSystemAgent::StartNextEpisode()
+		{
+			ProcessLastEpisode();
+			return NewEpisodeStarted;
+		}
+
+
 
 
 		ActionResult CyberSystemAgent::Act(bool updateXp)
@@ -276,8 +377,16 @@ namespace discenfw
 
 			int actionChosenIndex = -1;
 
-			if (!possibleActions.empty())
+			if (!possibleActions.empty() && !LearningEnabled && PolicyTable)
+			{
+				// the frozen policy needs neither the learner lock nor random choices
+				actionChosenIndex = PolicyTable->ChooseAction(possibleActions, prevStateRef);
+			}
+
+			if (actionChosenIndex < 0 && !possibleActions.empty())
 			{
+				// the learner can be updated by the learning thread
+				std::lock_guard<std::mutex> agentLock(AgentMutex);
 				if (LearningEnabled)
 				{
 					actionChosenIndex = GetAgent()->ChooseAction(experience, possibleActions, prevStateRef, true);
@@ -338,7 +447,7 @@ namespace discenfw
 			UpdateStats(result);
 			if (LearningEnabled)
 			{
-				GetAgent()->Learn(experience, GetCurrentEpisode()->TransitionSequence, result);
+				Learn(experience, GetCurrentEpisode()->TransitionSequence, result);
 			}
 		}
 
@@ -429,7 +538,7 @@ namespace discenfw
 
 			if (LearningEnabled)
 			{
-				GetAgent()->Learn(experience, transitionSequence, actionChosenResult);
+				Learn(experience, transitionSequence, actionChosenResult);
 			}
 			//Statistics.ActionChoiceCount++;
 
@@ -468,6 +577,115 @@ namespace discenfw
 		}
 
 
+		void CyberSystemAgent::Learn(
+			const std::shared_ptr<Experience> experience,
+			const std::vector<Transition>& transitionSequence,
+			ActionResult result
+			)
+		{
+			if (!AsyncLearningEnabled)
+			{
+				GetAgent()->Learn(experience, transitionSequence, result);
+				return;
+			}
+
+			// bounded staleness: wait if the learning thread is too far behind
+			std::unique_lock<std::mutex> lock(LearningMutex);
+			LearningCondition.wait(lock, [this]() { return PendingLearningSteps < MaxLearningLag; });
+
+			LearningStep step;
+			step.Agent = GetAgent();
+			step.AgentExperience = experience;
+			step.Result = result;
+
+			// queue only the new transitions if the sequence grew from the last queued one,
+			// otherwise (new episode, different sequence or agent) queue the whole sequence
+			bool sequenceGrown = QueuedSequence == &transitionSequence
+				&& QueuedAgent == step.Agent
+				&& QueuedExperience == experience
+				&& QueuedSequenceLength > 0
+				&& transitionSequence.size() >= QueuedSequenceLength
+				&& transitionSequence[QueuedSequenceLength - 1] == QueuedLastTransition;
+			if (sequenceGrown)
+			{
+				step.Transitions.assign(transitionSequence.begin() + QueuedSequenceLength, transitionSequence.end());
+				step.AppendTransitions = true;
+			}
+			else
+			{
+				step.Transitions = transitionSequence;
+			}
+			QueuedSequence = &transitionSequence;
+			QueuedSequenceLength = transitionSequence.size();
+			QueuedLastTransition = transitionSequence.empty() ? Transition() : transitionSequence.back();
+			QueuedAgent = step.Agent;
+			QueuedExperience = experience;
+
+			LearningQueue.push_back(std::move(step));
+			PendingLearningSteps++;
+			LearningCondition.notify_all();
+		}
+
+
+		void CyberSystemAgent::RunLearner()
+		{
+			for (;;)
+			{
+				LearningStep step;
+				{
+					std::unique_lock<std::mutex> lock(LearningMutex);
+					LearningCondition.wait(lock, [this]() { return LearnerStopping || !LearningQueue.empty(); });
+					if (LearningQueue.empty())
+					{
+						// stopping, all the queued steps were learned
+						return;
+					}
+					step = std::move(LearningQueue.front());
+					LearningQueue.pop_front();
+				}
+				{
+					std::lock_guard<std::mutex> agentLock(AgentMutex);
+					if (step.AppendTransitions)
+					{
+						LearnerSequence.insert(LearnerSequence.end(), step.Transitions.begin(), step.Transitions.end());
+					}
+					else
+					{
+						LearnerSequence.swap(step.Transitions);
+					}
+					step.Agent->Learn(step.AgentExperience, LearnerSequence, step.Result);
+				}
+				{
+					std::lock_guard<std::mutex> lock(LearningMutex);
+					PendingLearningSteps--;
+				}
+				LearningCondition.notify_all();
+			}
+		}
+
+
+		void CyberSystemAgent::StopLearner()
+		{
+			if (!LearnerThread.joinable())
+			{
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock(LearningMutex);
+				LearnerStopping = true;
+			}
+			LearningCondition.notify_all();
+			LearnerThread.join();
+			LearnerStopping = false;
+			LearnerSequence.clear();
+			QueuedSequence = nullptr;
+			QueuedSequenceLength = 0;
+			QueuedLastTransition = Transition();
+			QueuedAgent.reset();
+			QueuedExperience.reset();
+		}
+
+
 		StateRef CyberSystemAgent::RegisterState(std::shared_ptr<EnvironmentState> state)
 		{
 			StateSet.insert(state);
@@ -20,12 +20,225 @@
 #include <gpvulc/path/PathInfo.h>
 #include <gpvulc/json/RapidJsonInclude.h> // ParseException, FormatException
 
+#include <boost/filesystem.hpp>
+
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 #include <math.h>
 
+namespace
+{
+	using namespace discenfw::xp;
+
+	// Experience read from a file, with the states of the related model knowledge
+	struct ExperienceFileData
+	{
+		std::shared_ptr<Experience> FileExperience;
+		std::vector<StateRef> States;
+		std::string ErrorMessage;
+	};
+
+
+	void ReadExperienceFile(const std::string& fileName, ExperienceFileData& data)
+	{
+		gpvulc::PathInfo xpPath(fileName);
+		std::string jsonText;
+		if (!gpvulc::LoadText(xpPath.GetFullPath(), jsonText))
+		{
+			data.ErrorMessage = "cannot read the file.";
+			return;
+		}
+		try
+		{
+			std::shared_ptr<Experience> attributes = ExperienceAttributesFromJson(jsonText);
+			std::string modelFileName = xpPath.GetName() + "_" + gpvulc::GetCidStr(attributes->Model) + "_model_knowl";
+			gpvulc::PathInfo modelFileKnowl(xpPath.GetPath(), modelFileName, "json");
+			std::string knowlJsonText;
+			if (!gpvulc::LoadText(modelFileKnowl.GetFullPath(), knowlJsonText))
+			{
+				data.ErrorMessage = "cannot read " + modelFileKnowl.GetFullPath();
+				return;
+			}
+			EnvironmentStatesFromJson(knowlJsonText, data.States);
+			data.FileExperience = ExperienceFromJson(jsonText, nullptr, &data.States);
+		}
+		catch (gpvulc::json::ParseException parseException)
+		{
+			data.ErrorMessage = GetParseExceptionErrorMessage(parseException);
+		}
+		catch (gpvulc::json::FormatException formatException)
+		{
+			data.ErrorMessage = std::string("JSON assert failed: ") + formatException.what();
+		}
+		catch (gpvulc::json::ContentException contentException)
+		{
+			data.ErrorMessage = contentException.what();
+		}
+		if (!data.FileExperience && data.ErrorMessage.empty())
+		{
+			data.ErrorMessage = "failed to parse the experience.";
+		}
+	}
+
+
+	// Read the attributes at the beginning of an experience file (the whole file is read only if needed)
+	std::shared_ptr<Experience> ReadExperienceAttributes(const std::string& filePath)
+	{
+		// attributes are written before the experience data
+		const size_t headerSize = 4096;
+		std::ifstream file(filePath, std::ios::in | std::ios::binary);
+		if (!file.is_open())
+		{
+			return nullptr;
+		}
+		std::string jsonText(headerSize, '\0');
+		file.read(&jsonText[0], (std::streamsize)headerSize);
+		jsonText.resize((size_t)file.gcount());
+		std::shared_ptr<Experience> experience = ScanExperienceAttributes(jsonText);
+		if (!experience && jsonText.size() == headerSize && gpvulc::LoadText(filePath, jsonText))
+		{
+			experience = ScanExperienceAttributes(jsonText);
+		}
+		return experience;
+	}
+
+
+	// Load the data of an experience created from the attributes of its file (see ReadExperienceAttributes()),
+	// the states of the related model knowledge file are stored in the model and the experience journal is replayed
+	void LoadExperienceData(const std::string& filePath, const std::shared_ptr<Experience>& experience, std::string& errorMessage)
+	{
+		gpvulc::PathInfo xpPath(filePath);
+		std::string jsonText;
+		if (!gpvulc::LoadText(filePath, jsonText))
+		{
+			errorMessage = "cannot read the file.";
+			return;
+		}
+		std::string modelFileName = xpPath.GetName() + "_" + gpvulc::GetCidStr(experience->Model) + "_model_knowl";
+		gpvulc::PathInfo modelFileKnowl(xpPath.GetPath(), modelFileName, "json");
+		std::string knowlJsonText;
+		if (!gpvulc::LoadText(modelFileKnowl.GetFullPath(), knowlJsonText))
+		{
+			errorMessage = "cannot read " + modelFileKnowl.GetFullPath();
+			return;
+		}
+		std::vector<StateRef> states;
+		try
+		{
+			EnvironmentStatesFromJson(knowlJsonText, states);
+			std::shared_ptr<EnvironmentModel> model = experience->GetModel();
+			for (StateRef& state : states)
+			{
+				if (state)
+				{
+					state = model->GetStoredState(state);
+				}
+			}
+			ExperienceContentFromJson(jsonText, experience, &states);
+		}
+		catch (gpvulc::json::ParseException parseException)
+		{
+			errorMessage = GetParseExceptionErrorMessage(parseException);
+		}
+		catch (gpvulc::json::FormatException formatException)
+		{
+			errorMessage = std::string("JSON assert failed: ") + formatException.what();
+		}
+		catch (gpvulc::json::ContentException contentException)
+		{
+			errorMessage = contentException.what();
+		}
+		if (!errorMessage.empty())
+		{
+			return;
+		}
+		const std::string journalFilePath = filePath + ".journal";
+		boost::system::error_code errorCode;
+		if (boost::filesystem::exists(journalFilePath, errorCode) && !ExperienceJournal::Replay(journalFilePath, jsonText, experience, states))
+		{
+			errorMessage = "failed to load the experience journal " + journalFilePath;
+		}
+	}
+
+
+	// Replace the states of a parsed experience (not yet stored) with the given stored states
+	void ReplaceStates(Experience& experience, const std::map<const EnvironmentState*, StateRef>& storedStates)
+	{
+		auto replaceState = [&storedStates](StateRef& state)
+		{
+			if (state)
+			{
+				const auto& stateIt = storedStates.find(state.get());
+				if (stateIt != storedStates.cend())
+				{
+					state = stateIt->second;
+				}
+			}
+		};
+
+		// best episodes are shared with Episodes
+		for (const std::shared_ptr<Episode>& episode : experience.Episodes)
+		{
+			replaceState(episode->InitialState);
+			replaceState(episode->LastState);
+			for (Transition& transition : episode->TransitionSequence)
+			{
+				replaceState(transition.StartState);
+				replaceState(transition.EndState);
+			}
+			episode->FingerprintLength = 0;
+		}
+		for (Transition& transition : experience.FailedTransitions)
+		{
+			replaceState(transition.StartState);
+			replaceState(transition.EndState);
+		}
+		std::map<StateActionRef, float> stateActionValues;
+		for (const auto& stateActionValue : experience.StateActionValues)
+		{
+			StateActionRef stateAction = stateActionValue.first;
+			replaceState(stateAction.State);
+			stateActionValues[stateAction] = stateActionValue.second;
+		}
+		experience.StateActionValues.swap(stateActionValues);
+	}
+
+
+	// Save the text to a temporary file, to be renamed by ReplaceWithTempFile()
+	bool SaveTempText(const std::string& filePath, const std::string& text)
+	{
+		return gpvulc::SaveText(filePath + ".tmp", text);
+	}
+
+
+	// Remove the journal of the given experience file (see ExperienceJournal), if any
+	bool RemoveJournalFile(const std::string& xpFilePath)
+	{
+		boost::system::error_code errorCode;
+		boost::filesystem::remove(xpFilePath + ".journal", errorCode);
+		return !errorCode;
+	}
+
+
+	// Replace the given file with the temporary file saved by SaveTempText() (atomic rename)
+	bool ReplaceWithTempFile(const std::string& filePath)
+	{
+		boost::system::error_code errorCode;
+		boost::filesystem::rename(filePath + ".tmp", filePath, errorCode);
+		if (errorCode)
+		{
+			boost::filesystem::remove(filePath + ".tmp", errorCode);
+			return false;
+		}
+		return true;
+	}
+}
+
+
 namespace discenfw
 {
 	namespace xp
@@ -39,6 +252,7 @@ namespace discenfw
 
 		DigitalAssistant::~DigitalAssistant()
 		{
+			WaitForCheckpoint();
 		}
 
 
@@ -91,6 +305,11 @@ namespace discenfw
 			{
 				return false;
 			}
+			if (!LoadPendingExperience(CurrentGoal))
+			{
+				FailedExperienceFiles[newGoalName] = FailedExperienceFiles[CurrentGoal];
+				FailedExperienceFiles.erase(CurrentGoal);
+			}
 			WealthOfExperiences[newGoalName] = WealthOfExperiences[CurrentGoal];
 			WealthOfExperiences.erase(CurrentGoal);
 			CurrentGoal = newGoalName;
@@ -120,6 +339,8 @@ namespace discenfw
 				return false;
 			}
 			WealthOfExperiences.erase(goal);
+			PendingExperienceFiles.erase(goal);
+			FailedExperienceFiles.erase(goal);
 			if (goal == CurrentGoal)
 			{
 				if (WealthOfExperiences.empty())
@@ -202,6 +423,8 @@ namespace discenfw
 		{
 			CurrentEpisode = nullptr;
 			WealthOfExperiences.clear();
+			PendingExperienceFiles.clear();
+			FailedExperienceFiles.clear();
 			LastEpisodePerformance = 0;
 		}
 
@@ -216,7 +439,7 @@ namespace discenfw
 
 		void DigitalAssistant::SetSuccessCondition(const Condition& successCondition)
 		{
-			if (!GetCurrentExperience()->Episodes.empty())
+			if (GetCurrentExperience()->GetEpisodeCount() > 0)
 			{
 				ClearCurrentExperience();
 			}
@@ -226,7 +449,7 @@ namespace discenfw
 
 		void DigitalAssistant::AddSuccessCondition(const Condition& successCondition)
 		{
-			if (!GetCurrentExperience()->Episodes.empty())
+			if (GetCurrentExperience()->GetEpisodeCount() > 0)
 			{
 				ClearCurrentExperience();
 			}
@@ -236,7 +459,7 @@ namespace discenfw
 
 		void DigitalAssistant::SetFailureCondition(const Condition& failureCondition)
 		{
-			if (!GetCurrentExperience()->Episodes.empty())
+			if (GetCurrentExperience()->GetEpisodeCount() > 0)
 			{
 				ClearCurrentExperience();
 			}
@@ -246,7 +469,7 @@ namespace discenfw
 
 		void DigitalAssistant::AddFailureCondition(const Condition& failureCondition)
 		{
-			if (!GetCurrentExperience()->Episodes.empty())
+			if (GetCurrentExperience()->GetEpisodeCount() > 0)
 			{
 				ClearCurrentExperience();
 			}
@@ -256,7 +479,7 @@ namespace discenfw
 
 		void DigitalAssistant::SetDeadlockCondition(const Condition& deadlockCondition)
 		{
-			if (!GetCurrentExperience()->Episodes.empty())
+			if (GetCurrentExperience()->GetEpisodeCount() > 0)
 			{
 				ClearCurrentExperience();
 			}
@@ -266,7 +489,7 @@ namespace discenfw
 
 		void DigitalAssistant::AddDeadlockCondition(const Condition& deadlockCondition)
 		{
-			if (!GetCurrentExperience()->Episodes.empty())
+			if (GetCurrentExperience()->GetEpisodeCount() > 0)
 			{
 				ClearCurrentExperience();
 			}
@@ -284,7 +507,7 @@ namespace discenfw
 			{
 				if (LogEnabled && !CurrentEpisode->Completed() && !CurrentEpisode->Empty())
 				{
-					std::string msg = CurrentGoal + ": episode n." + std::to_string(GetCurrentExperience()->Episodes.size() + 1)
+					std::string msg = CurrentGoal + ": episode n." + std::to_string(GetCurrentExperience()->GetEpisodeCount() + 1)
 						+ " incomplete (discarded).\n";
 					LogMsg(LOG_DEBUG, msg);
 				}
@@ -365,94 +588,155 @@ namespace discenfw
 			{
 				return false;
 			}
-			for (const Transition& actionInfo : CurrentEpisode->TransitionSequence)
-			{
-				actionsSequence.push_back(*actionInfo.ActionTaken);
-			}
+			actionsSequence = GetLastActionsSequence();
 			return true;
 		}
 
 		const std::vector<Action>& DigitalAssistant::GetLastActionsSequence() const
 		{
-			if(ActionsSequenceChanged)
-			{
-				CachedActionsSequence.clear();
-				GetLastActionsSequence(CachedActionsSequence);
-				ActionsSequenceChanged = false;
-			}
-			return CachedActionsSequence;
+			UpdateActionsSequenceCache();
+			return ActionsSequenceCache.Actions;
 		}
 
 
 		bool DigitalAssistant::GetSuggestedActions(std::vector<Action>& suggestedActions) const
 		{
-			std::vector<Transition> transitions;
-			std::vector<int> performances;
-			suggestedActions.clear();
+			suggestedActions = GetSuggestedActions();
+			return !suggestedActions.empty();
+		}
+
+
+		const std::vector<Action>& DigitalAssistant::GetSuggestedActions() const
+		{
+			UpdateSuggestedActionsCache();
+			return SuggestedActionsCache.Actions;
+		}
+
+
+		bool DigitalAssistant::GetForbiddenActions(std::vector<Action>& forbiddenActions) const
+		{
+			forbiddenActions = GetForbiddenActions();
+			return !forbiddenActions.empty();
+		}
+
+
+		const std::vector<Action>& DigitalAssistant::GetForbiddenActions() const
+		{
+			UpdateForbiddenActionsCache();
+			return ForbiddenActionsCache.Actions;
+		}
+
+
+		void DigitalAssistant::UpdateSuggestedActionsCache() const
+		{
+			ActionListCache& cache = SuggestedActionsCache;
 			std::shared_ptr<Experience> currExperience = GetCurrentExperience();
-			if (!currExperience || currExperience->Level < ExperienceLevel::ASSISTANT)
+			if (!currExperience || currExperience->Level < ExperienceLevel::ASSISTANT
+				|| !currExperience->BestEpisode || !CurrentEpisode)
 			{
-				return false;
+				ResetActionHintsCache(cache);
+				return;
+			}
+			// best episodes are only appended, or replaced when a better episode is found
+			const std::vector< std::shared_ptr<Episode> >& bestEpisodes = currExperience->BestEpisodes;
+			if (cache.Source.lock() != currExperience || cache.State != CurrentEpisode->LastState
+				|| cache.ScannedCount > bestEpisodes.size()
+				|| (cache.ScannedCount > 0 && cache.LastScannedEpisode.lock() != bestEpisodes[cache.ScannedCount - 1]))
+			{
+				ResetActionHintsCache(cache);
+				cache.Source = currExperience;
+				cache.State = CurrentEpisode->LastState;
 			}
-			std::shared_ptr<Episode> bestEpisode = currExperience->BestEpisode;
-			if (bestEpisode)
+			for (; cache.ScannedCount < bestEpisodes.size(); cache.ScannedCount++)
 			{
-				int bestPerformance = bestEpisode->Performance;
-				for (std::shared_ptr<Episode> episode : currExperience->BestEpisodes)
+				const std::shared_ptr<Episode>& episode = bestEpisodes[cache.ScannedCount];
+				cache.LastScannedEpisode = episode;
+				// search the scenario state in transitions sequence
+				for (const Transition& transition : episode->TransitionSequence)
 				{
-					// search the scenario state in transitions sequence
-					bool stateFound = false;
-					for (unsigned int i = 0; !stateFound && i < episode->TransitionSequence.size(); i++)
+					if (transition.StartState == cache.State)
 					{
-						const Transition& currTransition = episode->TransitionSequence[i];
-						// check if each intermediate state is equal to the current state
-						if (currTransition.StartState == CurrentEpisode->LastState)
-						{
-							stateFound = true;
-							// store the action
-							suggestedActions.push_back(*(currTransition.ActionTaken));
-						}
+						cache.Actions.push_back(*(transition.ActionTaken));
+						ActionHintsVersion++;
+						break;
 					}
 				}
 			}
-
-			return !suggestedActions.empty();
 		}
 
 
-		const std::vector<Action>& DigitalAssistant::GetSuggestedActions() const
+		void DigitalAssistant::UpdateForbiddenActionsCache() const
 		{
-			CachedSuggestedActions.clear();
-			GetSuggestedActions(CachedSuggestedActions);
-			return CachedSuggestedActions;
+			ActionListCache& cache = ForbiddenActionsCache;
+			std::shared_ptr<Experience> currExperience = GetCurrentExperience();
+			if (!currExperience || !CurrentEpisode)
+			{
+				ResetActionHintsCache(cache);
+				return;
+			}
+			// failed transitions are only appended (or cleared)
+			const std::vector<Transition>& failedTransitions = currExperience->FailedTransitions;
+			if (cache.Source.lock() != currExperience || cache.State != CurrentEpisode->LastState
+				|| cache.ScannedCount > failedTransitions.size()
+				|| (cache.ScannedCount > 0 && !(failedTransitions[cache.ScannedCount - 1] == cache.LastScannedTransition)))
+			{
+				ResetActionHintsCache(cache);
+				cache.Source = currExperience;
+				cache.State = CurrentEpisode->LastState;
+			}
+			if (cache.ScannedCount == failedTransitions.size())
+			{
+				return;
+			}
+			for (; cache.ScannedCount < failedTransitions.size(); cache.ScannedCount++)
+			{
+				const Transition& transition = failedTransitions[cache.ScannedCount];
+				if (transition.StartState == cache.State)
+				{
+					cache.Actions.push_back(*(transition.ActionTaken));
+					ActionHintsVersion++;
+				}
+			}
+			cache.LastScannedTransition = failedTransitions.back();
 		}
 
 
-		bool DigitalAssistant::GetForbiddenActions(std::vector<Action>& forbiddenActions) const
+		void DigitalAssistant::UpdateActionsSequenceCache() const
 		{
-			forbiddenActions.clear();
-
-			if (GetCurrentExperience()->FailedTransitions.empty())
+			ActionListCache& cache = ActionsSequenceCache;
+			if (!CurrentEpisode)
 			{
-				return false;
+				cache.Source.reset();
+				cache.ScannedCount = 0;
+				cache.Actions.clear();
+				return;
 			}
-			for (const Transition& transition : GetCurrentExperience()->FailedTransitions)
+			// the transition sequence of the current episode is only appended
+			const std::vector<Transition>& transitionSequence = CurrentEpisode->TransitionSequence;
+			if (cache.Source.lock() != CurrentEpisode || cache.ScannedCount > transitionSequence.size())
 			{
-				if (transition.StartState == CurrentEpisode->LastState)
-				{
-					forbiddenActions.push_back(*(transition.ActionTaken));
-				}
+				cache.Source = CurrentEpisode;
+				cache.ScannedCount = 0;
+				cache.Actions.clear();
+			}
+			for (; cache.ScannedCount < transitionSequence.size(); cache.ScannedCount++)
+			{
+				cache.Actions.push_back(*(transitionSequence[cache.ScannedCount].ActionTaken));
 			}
-
-			return !forbiddenActions.empty();
 		}
 
 
-		const std::vector<Action>& DigitalAssistant::GetForbiddenActions() const
+		void DigitalAssistant::ResetActionHintsCache(ActionListCache& cache) const
 		{
-			CachedForbiddenActions.clear();
-			GetForbiddenActions(CachedForbiddenActions);
-			return CachedForbiddenActions;
+			if (!cache.Actions.empty())
+			{
+				cache.Actions.clear();
+				ActionHintsVersion++;
+			}
+			cache.Source.reset();
+			cache.State = nullptr;
+			cache.ScannedCount = 0;
+			cache.LastScannedEpisode.reset();
 		}
 
 
@@ -479,7 +763,6 @@ namespace discenfw
 				return;
 			}
 			CurrentEpisode->TransitionSequence.push_back(newTransition);
-			ActionsSequenceChanged = true;
 			CurrentEpisode->LastState = newState;
 			EvaluateEpisode();
 			UpdateState();
@@ -546,10 +829,34 @@ namespace discenfw
 				LogMsg(LOG_WARNING, "Experience loaded is not for the current goal.");
 			}
 			WealthOfExperiences[goal] = experience;
+			PendingExperienceFiles.erase(goal);
+			FailedExperienceFiles.erase(goal);
 			return experience;
 		}
 
 
+		void DigitalAssistant::SetStateIndexEnabled(bool enabled)
+		{
+			GetCurrentExperience()->SetStateIndexEnabled(enabled);
+		}
+
+
+		bool DigitalAssistant::GetEpisodesThroughState(const StateRef& state, std::vector<size_t>& episodeIndices) const
+		{
+			return GetCurrentExperience()->GetEpisodesThroughState(state, episodeIndices);
+		}
+
+
+		bool DigitalAssistant::GetEpisodesThroughState(
+			const StateRef& state,
+			ActionResult result,
+			std::vector<size_t>& episodeIndices
+			) const
+		{
+			return GetCurrentExperience()->GetEpisodesThroughState(state, result, episodeIndices);
+		}
+
+
 		bool DigitalAssistant::SaveExperience(const std::string& fileName, const std::string& goalName, bool saveAll)
 		{
 			if (fileName.empty())
@@ -557,31 +864,57 @@ namespace discenfw
 				LogMsg(LOG_ERROR, "Saving experience: empty file name.");
 				return false;
 			}
+			WaitForCheckpoint();
 			gpvulc::PathInfo xpPath(fileName);
 			const std::string& filePath= xpPath.GetFullPath();
 			std::string goal = goalName.empty() ? GetCurrentGoal() : goalName;
 			LogMsg(LOG_DEBUG, "Saving experience for " + goal);
+			const std::string journalFilePath = filePath + ".journal";
+			if (saveAll && AppendExperienceJournal(goal, journalFilePath))
+			{
+				return true;
+			}
 			std::string jsonText;
 			if (!SerializeExperience(jsonText, goal))
 			{
 				return false;
 			}
 			jsonText += "\n"; // add a newline at the end of file
-			if (!gpvulc::SaveText(filePath, jsonText))
+			if (!SaveTempText(filePath, jsonText))
 			{
 				LogMsg(LOG_ERROR, " Failed to save " + filePath);
 				return false;
 			}
-			if (saveAll)
-			{
-				std::string modelFileName = xpPath.GetName() + "_" + gpvulc::GetCidStr(GetCurrentExperience()->GetModelName()) + "_model";
-
-				// save the model in the same path as the experience
 
-				gpvulc::PathInfo modelFile(xpPath.GetPath(), modelFileName, "json");
-				gpvulc::PathInfo modelFileKnowl(xpPath.GetPath(), modelFileName+"_knowl", "json");
+			// the journal of the previous experience file is no more valid, it is removed after replacing the file
+			// (if this fails the journal does not match the new file and it is ignored, see ExperienceJournal::Replay())
+			ExperienceJournals.erase(goal);
+			if (!ReplaceWithTempFile(filePath))
+			{
+				LogMsg(LOG_ERROR, " Failed to replace " + filePath);
+				return false;
+			}
+			if (!RemoveJournalFile(filePath))
+			{
+				LogMsg(LOG_WARNING, " Failed to remove the previous experience journal " + journalFilePath);
+			}
 
-				SaveModel(modelFile.GetFullPath(), modelFileKnowl.GetFullPath());
+			if (saveAll)
+			{
+				std::string modelFilePath;
+				std::string knowlFilePath;
+				GetModelFilePaths(filePath, modelFilePath, knowlFilePath);
+				std::vector<StateRef> savedStates;
+				WealthOfExperiences[goal]->GetModel()->CopyStoredStates(savedStates);
+				SaveModel(modelFilePath, knowlFilePath);
+				if (ExperienceJournalEnabled)
+				{
+					std::shared_ptr<ExperienceJournal> journal = std::make_shared<ExperienceJournal>();
+					if (journal->Start(journalFilePath, WealthOfExperiences[goal], savedStates, jsonText))
+					{
+						ExperienceJournals[goal] = journal;
+					}
+				}
 
 				//gpvulc::PathInfo modelFile(xpPath.GetPath(), modelFileName, "json");
 
@@ -625,6 +958,76 @@ namespace discenfw
 		}
 
 
+		bool DigitalAssistant::AppendExperienceJournal(const std::string& goal, const std::string& journalFilePath)
+		{
+			const auto& journalIt = ExperienceJournals.find(goal);
+			const auto& xpIt = WealthOfExperiences.find(goal);
+			if (!ExperienceJournalEnabled || journalIt == ExperienceJournals.cend() || xpIt == WealthOfExperiences.cend())
+			{
+				return false;
+			}
+			ExperienceJournal& journal = *journalIt->second;
+
+			// compact the journal saving the whole experience when it grows too much
+			if (journal.GetFilePath() != journalFilePath || !journal.CanAppend(xpIt->second)
+				|| (double)journal.GetFileSize() > (double)JournalCompactionRatio * (double)journal.GetSnapshotSize())
+			{
+				return false;
+			}
+			if (!journal.Append(xpIt->second))
+			{
+				LogMsg(LOG_WARNING, " Failed to append to the experience journal, saving the whole experience.");
+				return false;
+			}
+			LogMsg(LOG_DEBUG, "Experience journal saved to " + journalFilePath);
+			return true;
+		}
+
+
+		void DigitalAssistant::SetExperienceJournalEnabled(bool enabled, float compactionRatio)
+		{
+			ExperienceJournalEnabled = enabled;
+			JournalCompactionRatio = compactionRatio;
+			if (!enabled)
+			{
+				// journal files are still valid until the experience is saved again
+				ExperienceJournals.clear();
+			}
+		}
+
+
+		bool DigitalAssistant::IsExperienceLoaded(const std::string& goalName) const
+		{
+			const std::string& goal = goalName.empty() ? CurrentGoal : goalName;
+			return WealthOfExperiences.find(goal) != WealthOfExperiences.cend()
+				&& PendingExperienceFiles.find(goal) == PendingExperienceFiles.cend()
+				&& FailedExperienceFiles.find(goal) == FailedExperienceFiles.cend();
+		}
+
+
+		bool DigitalAssistant::LoadPendingExperience(const std::string& goal) const
+		{
+			const auto& pendingIt = PendingExperienceFiles.find(goal);
+			if (pendingIt == PendingExperienceFiles.cend())
+			{
+				return FailedExperienceFiles.find(goal) == FailedExperienceFiles.cend();
+			}
+			const std::string filePath = pendingIt->second;
+			PendingExperienceFiles.erase(pendingIt);
+			LogMsg(LOG_DEBUG, "Loading experience data for " + goal + " from " + filePath);
+			std::string errorMessage;
+			LoadExperienceData(filePath, WealthOfExperiences.at(goal), errorMessage);
+			if (!errorMessage.empty())
+			{
+				// the experience could be incomplete, it is kept for queries but it is not saved
+				LogMsg(LOG_ERROR, " Failed to load experience data from " + filePath + ": " + errorMessage);
+				FailedExperienceFiles[goal] = filePath;
+				return false;
+			}
+			return true;
+		}
+
+
 		bool DigitalAssistant::SerializeExperience(std::string& jsonText, const std::string& goalName)
 		{
 			std::string goal = goalName;
@@ -638,11 +1041,154 @@ namespace discenfw
 				LogMsg(LOG_ERROR, " Goal " + goal + " not found.");
 				return false;
 			}
-			ExperienceToJson(WealthOfExperiences[goal], jsonText);
+			if (!LoadPendingExperience(goal))
+			{
+				LogMsg(LOG_ERROR, " Experience for " + goal + " not serialized: its data failed to load from " + FailedExperienceFiles[goal]);
+				return false;
+			}
+			if (!ExperienceToJson(WealthOfExperiences[goal], jsonText))
+			{
+				LogMsg(LOG_ERROR, " Failed to serialize experience for " + goal);
+				return false;
+			}
 			return true;
 		}
 
 
+		bool DigitalAssistant::SaveCheckpoint(const std::string& fileName, const std::string& goalName, bool saveAll)
+		{
+			if (fileName.empty())
+			{
+				LogMsg(LOG_ERROR, "Saving checkpoint: empty file name.");
+				return false;
+			}
+			if (CheckpointRunning)
+			{
+				LogMsg(LOG_WARNING, "Checkpoint skipped: the previous one is still in progress.");
+				return false;
+			}
+			WaitForCheckpoint();
+
+			const std::string filePath = gpvulc::PathInfo(fileName).GetFullPath();
+			const std::string goal = goalName.empty() ? GetCurrentGoal() : goalName;
+			const auto& xpIt = WealthOfExperiences.find(goal);
+			if (xpIt == WealthOfExperiences.cend())
+			{
+				LogMsg(LOG_ERROR, " Goal " + goal + " not found.");
+				return false;
+			}
+
+			if (!LoadPendingExperience(goal))
+			{
+				LogMsg(LOG_ERROR, " Checkpoint not saved for " + goal + ": its data failed to load from " + FailedExperienceFiles[goal]);
+				return false;
+			}
+
+			// take a snapshot of the experience and of the model states (the only data that could change),
+			// the small model definition is serialized immediately
+			std::shared_ptr<Experience> experience = xpIt->second->CreateSnapshot();
+			if (!experience)
+			{
+				LogMsg(LOG_ERROR, " Failed to take a snapshot of the experience for " + goal);
+				return false;
+			}
+			std::shared_ptr<EnvironmentModel> model = experience->GetModel();
+			std::shared_ptr< std::vector<StateRef> > states = std::make_shared< std::vector<StateRef> >();
+			model->CopyStoredStates(*states);
+			std::string modelFilePath;
+			std::string knowlFilePath;
+			std::string modelJsonText;
+			if (saveAll)
+			{
+				GetModelFilePaths(filePath, modelFilePath, knowlFilePath);
+				EnvironmentModelDefinitionToJson(model, modelJsonText);
+				modelJsonText += "\n"; // add a newline at the end of file
+			}
+
+			// the journal is no more valid (the journal file is removed after replacing the experience file)
+			ExperienceJournals.erase(goal);
+
+			LogMsg(LOG_DEBUG, "Saving checkpoint for " + goal);
+			CheckpointError.clear();
+			CheckpointRunning = true;
+			CheckpointThread = std::thread(
+				[this, experience, model, states, filePath, modelFilePath, knowlFilePath, modelJsonText]()
+			{
+				// messages are not logged from this thread, errors are reported by WaitForCheckpoint()
+				std::string jsonText;
+				if (!ExperienceToJson(experience, jsonText, states.get()))
+				{
+					CheckpointError = "Failed to serialize checkpoint " + filePath;
+					CheckpointRunning = false;
+					return;
+				}
+				jsonText += "\n"; // add a newline at the end of file
+				std::string knowlJsonText;
+				if (!modelFilePath.empty())
+				{
+					EnvironmentModelKnowledgeToJson(model, knowlJsonText, states.get());
+					knowlJsonText += "\n"; // add a newline at the end of file
+				}
+
+				// write all the files before replacing them, the experience is replaced last
+				// (the states referenced by the previous experience are still in the new knowledge)
+				if (!SaveTempText(filePath, jsonText)
+					|| (!modelFilePath.empty() && (!SaveTempText(modelFilePath, modelJsonText) || !SaveTempText(knowlFilePath, knowlJsonText))))
+				{
+					CheckpointError = "Failed to save checkpoint " + filePath;
+				}
+				else if (!modelFilePath.empty() && (!ReplaceWithTempFile(knowlFilePath) || !ReplaceWithTempFile(modelFilePath)))
+				{
+					CheckpointError = "Failed to replace model files for checkpoint " + filePath;
+				}
+				else if (!ReplaceWithTempFile(filePath))
+				{
+					CheckpointError = "Failed to replace checkpoint " + filePath;
+				}
+				else
+				{
+					// a journal left here does not match the new file, thus it would be ignored anyway
+					RemoveJournalFile(filePath);
+				}
+				CheckpointRunning = false;
+			});
+			return true;
+		}
+
+
+		bool DigitalAssistant::WaitForCheckpoint()
+		{
+			if (!CheckpointThread.joinable())
+			{
+				return CheckpointError.empty();
+			}
+			CheckpointThread.join();
+			if (!CheckpointError.empty())
+			{
+				LogMsg(LOG_ERROR, CheckpointError);
+				return false;
+			}
+			LogMsg(LOG_DEBUG, "Checkpoint saved.");
+			return true;
+		}
+
+
+		void DigitalAssistant::GetModelFilePaths(
+			const std::string& xpFileName,
+			std::string& modelFilePath,
+			std::string& knowlFilePath
+			) const
+		{
+			gpvulc::PathInfo xpPath(xpFileName);
+			std::string modelFileName = xpPath.GetName() + "_" + gpvulc::GetCidStr(GetCurrentExperience()->GetModelName()) + "_model";
+
+			// save the model in the same path as the experience
+
+			modelFilePath = gpvulc::PathInfo(xpPath.GetPath(), modelFileName, "json").GetFullPath();
+			knowlFilePath = gpvulc::PathInfo(xpPath.GetPath(), modelFileName + "_knowl", "json").GetFullPath();
+		}
+
+
 		bool DigitalAssistant::LoadExperience(const std::string& fileName, bool loadAll)
 		{
 			LogMsg(LOG_DEBUG, "Loading experience from: " + fileName);
@@ -653,6 +1199,38 @@ namespace discenfw
 			}
 			gpvulc::PathInfo xpPath(fileName);
 			const std::string& filePath = xpPath.GetFullPath();
+			if (loadAll && LazyLoadingEnabled)
+			{
+				// the experience data is loaded on first access (see LoadPendingExperience())
+				std::shared_ptr<Experience> experience = ReadExperienceAttributes(filePath);
+				if (!experience)
+				{
+					LogMsg(LOG_ERROR, " Failed to read the experience attributes from " + filePath);
+					return false;
+				}
+				std::string modelFileName = xpPath.GetName() + "_" + gpvulc::GetCidStr(experience->Model) + "_model";
+				gpvulc::PathInfo modelFileDef(xpPath.GetPath(), modelFileName, "json");
+				LogMsg(LOG_DEBUG, " Loading model definition " + experience->Model + "...");
+				if (!LoadModel(modelFileDef.GetFullPath()))
+				{
+					return false;
+				}
+				const std::string& goal = experience->Goal;
+				if (CurrentGoal.empty())
+				{
+					CurrentGoal = goal;
+				}
+				if (goal != CurrentGoal)
+				{
+					LogMsg(LOG_WARNING, "Experience loaded is not for the current goal.");
+				}
+				WealthOfExperiences[goal] = experience;
+				PendingExperienceFiles[goal] = filePath;
+				FailedExperienceFiles.erase(goal);
+				ExperienceJournals.erase(goal);
+				LogMsg(LOG_DEBUG, "Experience indexed for " + goal + ", its data will be loaded on first access.");
+				return true;
+			}
 			std::string jsonText;
 			if (!gpvulc::LoadText(filePath, jsonText))
 			{
@@ -684,16 +1262,104 @@ namespace discenfw
 					return false;
 				}
 			}
-			if (!ParseExperience(jsonText, experience, false))
+			experience = ParseExperience(jsonText, experience, false);
+			if (!experience)
 			{
 				LogMsg(LOG_ERROR, " Failed to parse the experience.");
 				return false;
 			}
+			ExperienceJournals.erase(experience->Goal);
+			const std::string journalFilePath = filePath + ".journal";
+			boost::system::error_code errorCode;
+			if (boost::filesystem::exists(journalFilePath, errorCode))
+			{
+				// journaled states follow the states of the model knowledge file,
+				// the experience was parsed referring to the stored states also if the model was already loaded
+				std::vector<StateRef> stateTable;
+				experience->GetModel()->CopyStoredStates(stateTable);
+				if (!ExperienceJournal::Replay(journalFilePath, jsonText, experience, stateTable))
+				{
+					LogMsg(LOG_WARNING, " Failed to load the experience journal " + journalFilePath);
+				}
+			}
 			LogMsg(LOG_DEBUG, "Experience loaded for " + experience->Goal + ".");
 			return true;
 		}
 
 
+		bool DigitalAssistant::MergeExperiences(const std::vector<std::string>& fileNames, unsigned threadCount)
+		{
+			if (fileNames.empty())
+			{
+				return true;
+			}
+
+			// read and parse the files in parallel
+			std::vector<ExperienceFileData> filesData(fileNames.size());
+			if (threadCount == 0)
+			{
+				threadCount = std::max(1u, std::thread::hardware_concurrency());
+			}
+			threadCount = (unsigned)std::min<size_t>(threadCount, fileNames.size());
+			std::atomic<size_t> nextFile(0);
+			auto readFiles = [&fileNames, &filesData, &nextFile]()
+			{
+				for (size_t i = nextFile++; i < fileNames.size(); i = nextFile++)
+				{
+					ReadExperienceFile(fileNames[i], filesData[i]);
+				}
+			};
+			std::vector<std::thread> workers;
+			for (unsigned i = 1; i < threadCount; i++)
+			{
+				workers.emplace_back(readFiles);
+			}
+			readFiles();
+			for (std::thread& worker : workers)
+			{
+				worker.join();
+			}
+
+			// store the states in the current model (in the order of the files)
+			std::shared_ptr<Experience> experience = CurrentExperience();
+			std::shared_ptr<EnvironmentModel> model = experience->GetModel();
+			std::vector< std::shared_ptr<Experience> > experiences;
+			bool allMerged = true;
+			for (size_t i = 0; i < fileNames.size(); i++)
+			{
+				ExperienceFileData& data = filesData[i];
+				if (!data.FileExperience)
+				{
+					LogMsg(LOG_ERROR, " Failed to load experience from " + fileNames[i] + ": " + data.ErrorMessage);
+					allMerged = false;
+					continue;
+				}
+				if (data.FileExperience->Goal != experience->Goal
+					|| data.FileExperience->GetModelName() != experience->GetModelName()
+					|| data.FileExperience->GetRoleName() != experience->GetRoleName())
+				{
+					LogMsg(LOG_WARNING, " Experience in " + fileNames[i] + " not merged: goal, model or role not matching.");
+					allMerged = false;
+					continue;
+				}
+				std::map<const EnvironmentState*, StateRef> storedStates;
+				for (const StateRef& state : data.States)
+				{
+					if (state)
+					{
+						storedStates[state.get()] = model->GetStoredState(state);
+					}
+				}
+				ReplaceStates(*data.FileExperience, storedStates);
+				experiences.push_back(data.FileExperience);
+			}
+
+			experience->MergeExperiences(experiences);
+			LogMsg(LOG_DEBUG, std::to_string(experiences.size()) + " experiences merged for " + experience->Goal + ".");
+			return allMerged;
+		}
+
+
 		bool DigitalAssistant::ParseModel(const std::string& jsonText, const std::string& knowlJsonText)
 		{
 			std::shared_ptr<EnvironmentModel> model;
@@ -798,12 +1464,34 @@ namespace discenfw
 			}
 
 			// keep only best episodes (with higher performance)
-			GetCurrentExperience()->Episodes.clear();
+			GetCurrentExperience()->ClearEpisodes();
 
 			return true;
 		}
 
 
+		void DigitalAssistant::MarkReachableStates(StateMarkSet& reachableStates) const
+		{
+			for (const auto& xpPair : WealthOfExperiences)
+			{
+				if (xpPair.second)
+				{
+					xpPair.second->MarkReachableStates(reachableStates);
+				}
+			}
+			if (CurrentEpisode)
+			{
+				reachableStates.insert(CurrentEpisode->InitialState.get());
+				reachableStates.insert(CurrentEpisode->LastState.get());
+				for (const Transition& transition : CurrentEpisode->TransitionSequence)
+				{
+					reachableStates.insert(transition.StartState.get());
+					reachableStates.insert(transition.EndState.get());
+				}
+			}
+		}
+
+
 		void DigitalAssistant::PrintHints(bool toConsole, bool toScreen)
 		{
 			if (!GetCurrentExperience() || !GetCurrentExperience()->Valid())
@@ -875,6 +1563,7 @@ namespace discenfw
 			}
 			CurrentModel = WealthOfExperiences[CurrentGoal]->Model;
 			CurrentRole = WealthOfExperiences[CurrentGoal]->Role;
+			LoadPendingExperience(CurrentGoal);
 			return WealthOfExperiences[CurrentGoal];
 		}
 
@@ -963,7 +1652,7 @@ namespace discenfw
 					}
 					else
 					{
-						size_t episodeNum = GetCurrentExperience()->Episodes.size() + 1;
+						size_t episodeNum = GetCurrentExperience()->GetEpisodeCount() + 1;
 						oStr << CurrentGoal << ": Episode n." << episodeNum
 							<< " " << (CurrentEpisode->Succeded() ? "completed" : "failed");
 						if (CurrentEpisode->Succeded())
@@ -999,7 +1688,6 @@ namespace discenfw
 			CurrentEpisode->LastState = newState;
 			CurrentEpisode->Result = result;
 			CurrentEpisode->TransitionSequence.push_back(actionInfo);
-			ActionsSequenceChanged = true;
 			EvaluateEpisode();
 			if (updateXp)
 			{
@@ -1022,7 +1710,7 @@ namespace discenfw
 				{
 					if (LogEnabled)
 					{
-						std::string msg = CurrentGoal + ": episode n." + std::to_string(GetCurrentExperience()->Episodes.size() + 1)
+						std::string msg = CurrentGoal + ": episode n." + std::to_string(GetCurrentExperience()->GetEpisodeCount() + 1)
 							+ " duplicate (already stored).\n";
 						LogMsg(LOG_DEBUG, msg);
 					}
@@ -1030,7 +1718,7 @@ namespace discenfw
 			}
 		}
 
-		void DigitalAssistant::LogMsg(int severity, const std::string& message, const std::string& msgRef)
+		void DigitalAssistant::LogMsg(int severity, const std::string& message, const std::string& msgRef) const
 		{
 			LogMessage(severity, message, "DiScenFw(xp)", ConsoleLogEnabled, ScreenLogEnabled, msgRef);
 		}
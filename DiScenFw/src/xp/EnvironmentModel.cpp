@@ -33,6 +33,8 @@ namespace discenfw
 
 		std::string EnvironmentModel::LastModelName;
 
+		std::mutex EnvironmentModel::ModelMapMutex;
+
 
 		EnvironmentModel::~EnvironmentModel()
 		{
@@ -42,6 +44,7 @@ namespace discenfw
 
 		std::shared_ptr<EnvironmentModel> EnvironmentModel::GetOrCreate(const std::string& modelName)
 		{
+			std::lock_guard<std::mutex> lock(ModelMapMutex);
 			std::string actualName = modelName;
 			if (!EnvironmentModelMap.empty() && actualName.empty())
 			{
@@ -59,6 +62,7 @@ namespace discenfw
 
 		void EnvironmentModel::RemoveModel(const std::string& modelName)
 		{
+			std::lock_guard<std::mutex> lock(ModelMapMutex);
 			if (LastModelName == modelName)
 			{
 				LastModelName.clear();
@@ -72,6 +76,7 @@ namespace discenfw
 
 		void EnvironmentModel::RemoveAllModels()
 		{
+			std::lock_guard<std::mutex> lock(ModelMapMutex);
 			LastModelName.clear();
 			EnvironmentModelMap.clear();
 		}
@@ -92,27 +97,27 @@ namespace discenfw
 		const std::shared_ptr<EnvironmentState> EnvironmentModel::FindState(
 			const EnvironmentState& environmentState) const
 		{
-			auto it = std::find_if(EnvironmentStates.begin(), EnvironmentStates.end(),
-				[&environmentState](const std::shared_ptr<EnvironmentState> state)
-			{
-				return *state == environmentState;
-			}
-			);
-			if (it == EnvironmentStates.end())
-			{
-				return nullptr;
-			}
-			return *it;
+			// the hash is computed before locking to keep the lock short
+			const size_t hash = environmentState.GetHash();
+			std::lock_guard<std::recursive_mutex> lock(StoreMutex);
+			return FindStoredState(environmentState, hash);
 		}
 
 
 		const std::shared_ptr<EnvironmentState> EnvironmentModel::FindState(
 			const std::shared_ptr<EnvironmentState> environmentState) const
 		{
-			auto it = std::find(EnvironmentStates.begin(), EnvironmentStates.end(), environmentState);
-			if (it != EnvironmentStates.end())
+			if (!environmentState)
+			{
+				return nullptr;
+			}
 			{
-				return *it;
+				std::lock_guard<std::recursive_mutex> lock(StoreMutex);
+				const auto& posIt = StatePositions.find(environmentState.get());
+				if (posIt != StatePositions.cend())
+				{
+					return EnvironmentStates[posIt->second];
+				}
 			}
 			return FindState(*environmentState);
 		}
@@ -121,11 +126,13 @@ namespace discenfw
 		const std::shared_ptr<EnvironmentState> EnvironmentModel::GetStoredState(
 			const EnvironmentState& environmentState)
 		{
-			std::shared_ptr<EnvironmentState> state = FindState(environmentState);
+			const size_t hash = environmentState.GetHash();
+			std::lock_guard<std::recursive_mutex> lock(StoreMutex);
+			std::shared_ptr<EnvironmentState> state = FindStoredState(environmentState, hash);
 			if (!state)
 			{
 				state = environmentState.Clone();
-				EnvironmentStates.push_back(state);
+				AddStoredState(state, hash);
 			}
 			return state;
 		}
@@ -134,22 +141,31 @@ namespace discenfw
 		const std::shared_ptr<EnvironmentState> EnvironmentModel::GetStoredState(
 			const std::shared_ptr<EnvironmentState> environmentState)
 		{
-			std::shared_ptr<EnvironmentState> state = FindState(environmentState);
+			std::shared_ptr<EnvironmentState> state = environmentState;
 			if (!state)
 			{
-				state = environmentState;
-				if (!state)
-				{
-					state = EnvironmentState::Make();
-				}
-				EnvironmentStates.push_back(state);
+				state = EnvironmentState::Make();
 			}
-			return state;
+			const size_t hash = state->GetHash();
+			std::lock_guard<std::recursive_mutex> lock(StoreMutex);
+			const auto& posIt = StatePositions.find(state.get());
+			if (posIt != StatePositions.cend())
+			{
+				return EnvironmentStates[posIt->second];
+			}
+			std::shared_ptr<EnvironmentState> storedState = FindStoredState(*state, hash);
+			if (!storedState)
+			{
+				storedState = state;
+				AddStoredState(storedState, hash);
+			}
+			return storedState;
 		}
 
 
 		std::shared_ptr<EnvironmentState> EnvironmentModel::GetStoredState(int stateIndex)
 		{
+			std::lock_guard<std::recursive_mutex> lock(StoreMutex);
 			if (stateIndex < 0 || stateIndex >= (int)EnvironmentStates.size())
 			{
 				return nullptr;
@@ -161,26 +177,30 @@ namespace discenfw
 
 		int EnvironmentModel::IndexOfState(const std::shared_ptr<EnvironmentState> state) const
 		{
-			for (int i = 0; i < (int)EnvironmentStates.size(); i++)
-			{
-				if (EnvironmentStates[i] == state)
-				{
-					return i;
-				}
-			}
-			return -1;
+			std::lock_guard<std::recursive_mutex> lock(StoreMutex);
+			const auto& posIt = StatePositions.find(state.get());
+			return posIt != StatePositions.cend() ? posIt->second : -1;
 		}
 
 
 		int EnvironmentModel::GetNumStates() const
 		{
+			std::lock_guard<std::recursive_mutex> lock(StoreMutex);
 			return (int)EnvironmentStates.size();
 		}
 
 
-		const std::vector<std::shared_ptr<const EnvironmentState>>& EnvironmentModel::GetAllStates()
+		std::vector< std::shared_ptr<const EnvironmentState> > EnvironmentModel::GetAllStates() const
 		{
-			return (const std::vector<std::shared_ptr<const EnvironmentState>>&)(EnvironmentStates);
+			std::lock_guard<std::recursive_mutex> lock(StoreMutex);
+			return std::vector< std::shared_ptr<const EnvironmentState> >(EnvironmentStates.cbegin(), EnvironmentStates.cend());
+		}
+
+
+		void EnvironmentModel::CopyStoredStates(std::vector< std::shared_ptr<EnvironmentState> >& states) const
+		{
+			std::lock_guard<std::recursive_mutex> lock(StoreMutex);
+			states = EnvironmentStates;
 		}
 
 
@@ -255,7 +275,44 @@ namespace discenfw
 
 		void EnvironmentModel::ClearStoredStates()
 		{
+			std::lock_guard<std::recursive_mutex> lock(StoreMutex);
 			EnvironmentStates.clear();
+			StatePositions.clear();
+			StateHashIndex.clear();
+		}
+
+
+		int EnvironmentModel::CollectUnusedStates(const StateMarkSet& reachableStates)
+		{
+			std::lock_guard<std::recursive_mutex> lock(StoreMutex);
+			StateMarkSet keptStates;
+			size_t keptCount = 0;
+			for (size_t i = 0; i < EnvironmentStates.size(); i++)
+			{
+				const EnvironmentState* state = EnvironmentStates[i].get();
+				if (state == CurrentState.get() || reachableStates.find(state) != reachableStates.cend())
+				{
+					keptStates.insert(state);
+					EnvironmentStates[keptCount] = EnvironmentStates[i];
+					keptCount++;
+				}
+			}
+			const int removedCount = (int)(EnvironmentStates.size() - keptCount);
+			if (removedCount == 0)
+			{
+				return 0;
+			}
+			EnvironmentStates.resize(keptCount);
+			EnvironmentStates.shrink_to_fit();
+			IndexStoredStates();
+			for (const auto& rolePair : Roles)
+			{
+				if (rolePair.second)
+				{
+					rolePair.second->ReleaseStateInfo(keptStates);
+				}
+			}
+			return removedCount;
 		}
 
 
@@ -492,6 +549,7 @@ namespace discenfw
 
 		std::shared_ptr<Action> EnvironmentModel::EncodeAction(const Action& action, std::string& actionString) const
 		{
+			std::lock_guard<std::recursive_mutex> lock(StoreMutex);
 			actionString = action.ToString();
 			std::shared_ptr<Action> storedAction = EncodedActions[actionString];
 			if (!storedAction)
@@ -506,6 +564,7 @@ namespace discenfw
 
 		std::shared_ptr<Action> EnvironmentModel::DecodeAction(const std::string& actionString) const
 		{
+			std::lock_guard<std::recursive_mutex> lock(StoreMutex);
 			if (EncodedActions.find(actionString) != EncodedActions.cend())
 			{
 				return EncodedActions.at(actionString);
@@ -528,6 +587,44 @@ namespace discenfw
 		}
 
 
+		std::shared_ptr<EnvironmentState> EnvironmentModel::FindStoredState(const EnvironmentState& environmentState, size_t hash) const
+		{
+			const auto& range = StateHashIndex.equal_range(hash);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				const std::shared_ptr<EnvironmentState>& state = EnvironmentStates[it->second];
+				if (*state == environmentState)
+				{
+					return state;
+				}
+			}
+			return nullptr;
+		}
+
+
+		void EnvironmentModel::AddStoredState(const std::shared_ptr<EnvironmentState>& environmentState, size_t hash)
+		{
+			const int position = (int)EnvironmentStates.size();
+			EnvironmentStates.push_back(environmentState);
+			StatePositions[environmentState.get()] = position;
+			StateHashIndex.emplace(hash, position);
+		}
+
+
+		void EnvironmentModel::IndexStoredStates()
+		{
+			StatePositions.clear();
+			StateHashIndex.clear();
+			StatePositions.reserve(EnvironmentStates.size());
+			StateHashIndex.reserve(EnvironmentStates.size());
+			for (int i = 0; i < (int)EnvironmentStates.size(); i++)
+			{
+				StatePositions[EnvironmentStates[i].get()] = i;
+				StateHashIndex.emplace(EnvironmentStates[i]->GetHash(), i);
+			}
+		}
+
+
 		EnvironmentModel::EnvironmentModel(const std::string& name)
 			: Name(name)
 		{
@@ -11,6 +11,17 @@
 #include "discenfw/xp/EnvironmentState.h"
 #include <discenfw/xp/EnvironmentModel.h>
 
+#include <functional>
+
+namespace
+{
+	size_t CombineHash(size_t seed, const std::string& value)
+	{
+		return seed ^ (std::hash<std::string>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+	}
+}
+
+
 namespace discenfw
 {
 	namespace xp
@@ -149,6 +160,38 @@ namespace discenfw
 		}
 
 
+		size_t EnvironmentState::GetHash() const
+		{
+			// maps are ordered, thus equal states are hashed in the same order
+			size_t hash = EntityStates.size();
+			for (const auto& entStateEntry : EntityStates)
+			{
+				hash = CombineHash(hash, entStateEntry.first);
+				if (!entStateEntry.second)
+				{
+					continue;
+				}
+				for (const auto& propValue : entStateEntry.second->GetPropertyValues())
+				{
+					hash = CombineHash(hash, propValue.first);
+					hash = CombineHash(hash, propValue.second);
+				}
+				for (const auto& relationship : entStateEntry.second->GetRelationships())
+				{
+					hash = CombineHash(hash, relationship.first);
+					hash = CombineHash(hash, relationship.second.EntityId);
+					hash = CombineHash(hash, relationship.second.LinkId);
+				}
+			}
+			for (const auto& feature : Features)
+			{
+				hash = CombineHash(hash, feature.first);
+				hash = CombineHash(hash, feature.second);
+			}
+			return hash;
+		}
+
+
 		bool EnvironmentState::operator == (const EnvironmentState& state) const
 		{
 			if (state.Features != Features)
@@ -0,0 +1,348 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/xp/EpisodeLog.h>
+#include <discenfw/util/MessageLog.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <set>
+
+namespace
+{
+	// Record layout (32-bit words): transitions count, initial state, last state,
+	// performance, result, repetitions count, then (start state, action, end state) for each transition
+	const size_t RecordHeaderSize = 6;
+	const size_t RepetitionsCountPosition = 5;
+
+	// paths of the log files in use, a file shared with snapshots is never overwritten
+	std::mutex LogPathsMutex;
+	std::set<std::string> LogPaths;
+}
+
+
+namespace discenfw
+{
+	namespace xp
+	{
+		struct EpisodeLog::LogFile
+		{
+			std::string Path;
+
+			LogFile(const std::string& path) : Path(path)
+			{
+			}
+
+			~LogFile()
+			{
+				std::remove(Path.c_str());
+				std::lock_guard<std::mutex> lock(LogPathsMutex);
+				LogPaths.erase(Path);
+			}
+		};
+
+
+		EpisodeLog::EpisodeLog()
+		{
+			States.assign(1, nullptr);
+			Actions.assign(1, nullptr);
+		}
+
+
+		EpisodeLog::~EpisodeLog()
+		{
+			Close();
+		}
+
+
+		bool EpisodeLog::Open(const std::string& filePath)
+		{
+			Close();
+
+			// if the file is still read by a snapshot use a new one
+			std::string path = filePath;
+			{
+				std::lock_guard<std::mutex> lock(LogPathsMutex);
+				for (int i = 1; LogPaths.find(path) != LogPaths.cend(); i++)
+				{
+					path = filePath + "." + std::to_string(i);
+				}
+				LogPaths.insert(path);
+			}
+			std::shared_ptr<LogFile> logFile = std::make_shared<LogFile>(path);
+			File.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!File.is_open())
+			{
+				LogMessage(LOG_ERROR, "Failed to create episode log " + path, "DiScenFw");
+				return false;
+			}
+			SharedFile = logFile;
+			FilePath = filePath;
+			return true;
+		}
+
+
+		bool EpisodeLog::OpenSnapshot(const EpisodeLog& sourceLog)
+		{
+			Close();
+			if (!sourceLog.IsOpen())
+			{
+				return false;
+			}
+			sourceLog.File.flush();
+			File.open(sourceLog.SharedFile->Path, std::ios::in | std::ios::binary);
+			if (!File.is_open())
+			{
+				LogMessage(LOG_ERROR, "Failed to read episode log " + sourceLog.SharedFile->Path, "DiScenFw");
+				return false;
+			}
+			SharedFile = sourceLog.SharedFile;
+			FilePath = sourceLog.FilePath;
+			ReadOnly = true;
+			FileSize = sourceLog.FileSize;
+			RecordOffsets = sourceLog.RecordOffsets;
+			Fingerprints = sourceLog.Fingerprints;
+			RepetitionsCounts = sourceLog.RepetitionsCounts;
+			States = sourceLog.States;
+			Actions = sourceLog.Actions;
+			StateIds = sourceLog.StateIds;
+			ActionIds = sourceLog.ActionIds;
+			sourceLog.SharedFileSize = std::max(sourceLog.SharedFileSize, sourceLog.FileSize);
+			return true;
+		}
+
+
+		void EpisodeLog::Close()
+		{
+			ClearIndex();
+			// the file is deleted when released by the snapshots too
+			File.close();
+			SharedFile.reset();
+			SharedFileSize = 0;
+			ReadOnly = false;
+			FilePath.clear();
+		}
+
+
+		bool EpisodeLog::AppendEpisode(const EpisodeView& episode, size_t fingerprint)
+		{
+			if (!File.is_open() || ReadOnly)
+			{
+				return false;
+			}
+			const size_t transitionCount = episode.GetTransitionCount();
+			RecordBuffer.resize(RecordHeaderSize + transitionCount * 3);
+			RecordBuffer[0] = (uint32_t)transitionCount;
+			RecordBuffer[1] = GetStateId(episode.GetInitialState());
+			RecordBuffer[2] = GetStateId(episode.GetLastState());
+			RecordBuffer[3] = (uint32_t)episode.GetPerformance();
+			RecordBuffer[4] = (uint32_t)episode.GetResult();
+			RecordBuffer[RepetitionsCountPosition] = (uint32_t)episode.GetRepetitionsCount();
+			uint32_t* transitionIds = RecordBuffer.data() + RecordHeaderSize;
+			for (size_t t = 0; t < transitionCount; t++)
+			{
+				transitionIds[t * 3] = GetStateId(episode.GetStartState(t));
+				transitionIds[t * 3 + 1] = GetActionId(episode.GetActionTaken(t));
+				transitionIds[t * 3 + 2] = GetStateId(episode.GetEndState(t));
+			}
+
+			const std::streamsize recordSize = (std::streamsize)(RecordBuffer.size() * sizeof(uint32_t));
+			File.seekp((std::streamoff)FileSize);
+			File.write((const char*)RecordBuffer.data(), recordSize);
+			if (!File)
+			{
+				File.clear();
+				LogMessage(LOG_ERROR, "Failed to write episode log " + FilePath, "DiScenFw");
+				return false;
+			}
+			RecordOffsets.push_back(FileSize);
+			Fingerprints.push_back(fingerprint);
+			RepetitionsCounts.push_back(episode.GetRepetitionsCount());
+			FileSize += (uint64_t)recordSize;
+			return true;
+		}
+
+
+		std::shared_ptr<Episode> EpisodeLog::ReadEpisode(size_t index) const
+		{
+			if (index >= RecordOffsets.size())
+			{
+				return nullptr;
+			}
+			std::shared_ptr<Episode> episode = std::make_shared<Episode>();
+			if (!ReadRecord(index, *episode))
+			{
+				return nullptr;
+			}
+			return episode;
+		}
+
+
+		bool EpisodeLog::IncrementRepetitionsCount(size_t index)
+		{
+			if (index >= RepetitionsCounts.size())
+			{
+				return false;
+			}
+			RepetitionsCounts[index]++;
+			return true;
+		}
+
+
+		bool EpisodeLog::ForEachEpisode(const std::function<void(const EpisodeView&)>& episodeFunction) const
+		{
+			Episode episode;
+			for (size_t i = 0; i < RecordOffsets.size(); i++)
+			{
+				if (!ReadRecord(i, episode))
+				{
+					return false;
+				}
+				episodeFunction(EpisodeView(&episode));
+			}
+			return true;
+		}
+
+
+		void EpisodeLog::Truncate(size_t episodeCount)
+		{
+			if (episodeCount >= RecordOffsets.size())
+			{
+				return;
+			}
+			// next records will overwrite the removed ones, except the ones read by snapshots
+			FileSize = RecordOffsets[episodeCount];
+			if (SharedFile.use_count() > 1)
+			{
+				FileSize = std::max(FileSize, SharedFileSize);
+			}
+			RecordOffsets.resize(episodeCount);
+			Fingerprints.resize(episodeCount);
+			RepetitionsCounts.resize(episodeCount);
+		}
+
+
+		void EpisodeLog::Clear()
+		{
+			if (!File.is_open() || ReadOnly)
+			{
+				ClearIndex();
+			}
+			else if (SharedFile.use_count() > 1)
+			{
+				// the file is read by a snapshot, continue on a new file
+				const std::string filePath = FilePath;
+				Open(filePath);
+			}
+			else
+			{
+				ClearIndex();
+				// reopen the file to truncate it
+				File.close();
+				File.open(SharedFile->Path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+			}
+		}
+
+
+		void EpisodeLog::ClearIndex()
+		{
+			RecordOffsets.clear();
+			Fingerprints.clear();
+			RepetitionsCounts.clear();
+			States.assign(1, nullptr);
+			Actions.assign(1, nullptr);
+			StateIds.clear();
+			ActionIds.clear();
+			FileSize = 0;
+		}
+
+
+		void EpisodeLog::MarkReachableStates(StateMarkSet& reachableStates) const
+		{
+			// the first element is null
+			for (size_t i = 1; i < States.size(); i++)
+			{
+				reachableStates.insert(States[i].get());
+			}
+		}
+
+
+		uint32_t EpisodeLog::GetStateId(const StateRef& state)
+		{
+			if (!state)
+			{
+				return 0;
+			}
+			const auto& idIt = StateIds.find(state.get());
+			if (idIt != StateIds.cend())
+			{
+				return idIt->second;
+			}
+			const uint32_t id = (uint32_t)States.size();
+			States.push_back(state);
+			StateIds[state.get()] = id;
+			return id;
+		}
+
+
+		uint32_t EpisodeLog::GetActionId(const ActionRef& action)
+		{
+			if (!action)
+			{
+				return 0;
+			}
+			const auto& idIt = ActionIds.find(action.get());
+			if (idIt != ActionIds.cend())
+			{
+				return idIt->second;
+			}
+			const uint32_t id = (uint32_t)Actions.size();
+			Actions.push_back(action);
+			ActionIds[action.get()] = id;
+			return id;
+		}
+
+
+		bool EpisodeLog::ReadRecord(size_t index, Episode& episode) const
+		{
+			RecordBuffer.resize(RecordHeaderSize);
+			File.seekg((std::streamoff)RecordOffsets[index]);
+			File.read((char*)RecordBuffer.data(), RecordHeaderSize * sizeof(uint32_t));
+			const size_t transitionCount = File ? RecordBuffer[0] : 0;
+			RecordBuffer.resize(RecordHeaderSize + transitionCount * 3);
+			File.read((char*)(RecordBuffer.data() + RecordHeaderSize), transitionCount * 3 * sizeof(uint32_t));
+			if (!File)
+			{
+				File.clear();
+				LogMessage(LOG_ERROR, "Failed to read episode log " + FilePath, "DiScenFw");
+				return false;
+			}
+
+			episode.InitialState = States[RecordBuffer[1]];
+			episode.LastState = States[RecordBuffer[2]];
+			episode.Performance = (int)RecordBuffer[3];
+			episode.Result = (ActionResult)RecordBuffer[4];
+			episode.RepetitionsCount = RepetitionsCounts[index];
+			episode.TransitionSequence.resize(transitionCount);
+			const uint32_t* transitionIds = RecordBuffer.data() + RecordHeaderSize;
+			for (size_t t = 0; t < transitionCount; t++)
+			{
+				Transition& transition = episode.TransitionSequence[t];
+				transition.StartState = States[transitionIds[t * 3]];
+				transition.ActionTaken = Actions[transitionIds[t * 3 + 1]];
+				transition.EndState = States[transitionIds[t * 3 + 2]];
+			}
+			episode.SequenceFingerprint = 0;
+			episode.FingerprintLength = 0;
+			return true;
+		}
+
+	} // namespace xp
+}
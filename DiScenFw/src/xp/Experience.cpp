@@ -11,8 +11,17 @@
 
 #include <discenfw/xp/EnvironmentModel.h>
 #include <discenfw/xp/RoleInfo.h>
+#include <discenfw/util/MessageLog.h>
 
 #include <algorithm>
+#include <set>
+
+namespace
+{
+	// viewed for the episodes not in memory (see Experience::GetEpisode())
+	const discenfw::xp::Episode EmptyEpisode;
+}
+
 
 namespace discenfw
 {
@@ -98,47 +107,78 @@ namespace discenfw
 
 		bool Experience::CheckDuplicateEpisode(std::shared_ptr<Episode> episode)
 		{
-			for (size_t i = 0; i < Episodes.size(); i++)
+			UpdateEpisodeIndex();
+			const auto& indexIt = EpisodeFingerprints.find(episode->GetFingerprint());
+			if (indexIt == EpisodeFingerprints.cend())
+			{
+				return false;
+			}
+
+			// compare only the episodes with the same fingerprint
+			const size_t spilledCount = SpilledEpisodes.GetEpisodeCount();
+			const size_t compactCount = CompactEpisodes.GetEpisodeCount();
+			for (size_t i : indexIt->second)
 			{
-				if (Episodes[i]->InitialState != episode->InitialState)
+				std::shared_ptr<Episode> spilledEpisode;
+				if (i < spilledCount)
+				{
+					spilledEpisode = SpilledEpisodes.ReadEpisode(i);
+					if (!spilledEpisode)
+					{
+						continue;
+					}
+				}
+				const EpisodeView storedEpisode = spilledEpisode ? EpisodeView(spilledEpisode.get()) : GetEpisode(i);
+				if (storedEpisode.GetInitialState() != episode->InitialState)
 				{
 					continue;
 				}
-				if (Episodes[i]->LastState != episode->LastState)
+				if (storedEpisode.GetLastState() != episode->LastState)
 				{
 					continue;
 				}
-				if (Episodes[i]->Result != episode->Result)
+				if (storedEpisode.GetResult() != episode->Result)
 				{
 					continue;
 				}
-				if (Episodes[i]->TransitionSequence.size() != episode->TransitionSequence.size())
+				if (storedEpisode.GetTransitionCount() != episode->TransitionSequence.size())
 				{
 					continue;
 				}
 				bool diffFound = false;
 				for (size_t t = 0; !diffFound && t < episode->TransitionSequence.size(); t++)
 				{
-					if (Episodes[i]->TransitionSequence[t].StartState != episode->TransitionSequence[t].StartState)
+					if (storedEpisode.GetStartState(t) != episode->TransitionSequence[t].StartState)
 					{
 						diffFound = true;
 					}
-					else if (Episodes[i]->TransitionSequence[t].EndState != episode->TransitionSequence[t].EndState)
+					else if (storedEpisode.GetEndState(t) != episode->TransitionSequence[t].EndState)
 					{
 						diffFound = true;
 					}
-					else if (Episodes[i]->TransitionSequence[t].ActionTaken->TypeId != episode->TransitionSequence[t].ActionTaken->TypeId)
+					else if (storedEpisode.GetActionTaken(t)->TypeId != episode->TransitionSequence[t].ActionTaken->TypeId)
 					{
 						diffFound = true;
 					}
-					else if (Episodes[i]->TransitionSequence[t].ActionTaken->Params != episode->TransitionSequence[t].ActionTaken->Params)
+					else if (storedEpisode.GetActionTaken(t)->Params != episode->TransitionSequence[t].ActionTaken->Params)
 					{
 						diffFound = true;
 					}
 				}
 				if (!diffFound)
 				{
-					Episodes[i]->RepetitionsCount++;
+					if (i < spilledCount)
+					{
+						SpilledEpisodes.IncrementRepetitionsCount(i);
+					}
+					else if (i < spilledCount + compactCount)
+					{
+						CompactEpisodes.IncrementRepetitionsCount(i - spilledCount);
+					}
+					else
+					{
+						Episodes[i - spilledCount - compactCount]->RepetitionsCount++;
+					}
 					return true;
 				}
 			}
@@ -146,6 +186,70 @@ namespace discenfw
 		}
 
 
+		void Experience::UpdateEpisodeIndex()
+		{
+			// spilled and compact episodes are only appended, check only the last one in Episodes
+			const size_t spilledCount = SpilledEpisodes.GetEpisodeCount();
+			const size_t appendedCount = spilledCount + CompactEpisodes.GetEpisodeCount();
+			if (IndexedEpisodeCount > GetEpisodeCount()
+				|| (IndexedEpisodeCount > appendedCount
+					&& Episodes[IndexedEpisodeCount - appendedCount - 1].get() != LastIndexedEpisode))
+			{
+				EpisodeFingerprints.clear();
+				StatePositions.clear();
+				IndexedEpisodeResults.clear();
+				IndexedEpisodeCount = 0;
+			}
+			for (; IndexedEpisodeCount < GetEpisodeCount(); IndexedEpisodeCount++)
+			{
+				if (StateIndexEnabled)
+				{
+					if (IndexedEpisodeCount < spilledCount)
+					{
+						std::shared_ptr<Episode> spilledEpisode = SpilledEpisodes.ReadEpisode(IndexedEpisodeCount);
+						if (!spilledEpisode)
+						{
+							// keep the index aligned, the episode cannot be found
+							spilledEpisode = std::make_shared<Episode>();
+						}
+						IndexEpisodeStates(IndexedEpisodeCount, EpisodeView(spilledEpisode.get()));
+					}
+					else
+					{
+						IndexEpisodeStates(IndexedEpisodeCount, GetEpisode(IndexedEpisodeCount));
+					}
+				}
+				size_t fingerprint = 0;
+				if (IndexedEpisodeCount < spilledCount)
+				{
+					fingerprint = SpilledEpisodes.GetFingerprint(IndexedEpisodeCount);
+				}
+				else if (IndexedEpisodeCount < appendedCount)
+				{
+					fingerprint = CompactEpisodes.GetFingerprint(IndexedEpisodeCount - spilledCount);
+				}
+				else
+				{
+					fingerprint = Episodes[IndexedEpisodeCount - appendedCount]->GetFingerprint();
+				}
+				EpisodeFingerprints[fingerprint].push_back(IndexedEpisodeCount);
+			}
+			LastIndexedEpisode = Episodes.empty() ? nullptr : Episodes.back().get();
+		}
+
+
+		void Experience::UpdateLastIndexedEpisode()
+		{
+			// the positions of the episodes do not change when they are moved, the index is still valid
+			const size_t appendedCount = SpilledEpisodes.GetEpisodeCount() + CompactEpisodes.GetEpisodeCount();
+			LastIndexedEpisode = nullptr;
+			if (IndexedEpisodeCount > appendedCount && IndexedEpisodeCount <= GetEpisodeCount())
+			{
+				LastIndexedEpisode = Episodes[IndexedEpisodeCount - appendedCount - 1].get();
+			}
+		}
+
+
 		bool Experience::StoreEpisode(std::shared_ptr<Episode> episode, bool checkDuplicate)
 		{
 			if (checkDuplicate && CheckDuplicateEpisode(episode))
@@ -164,29 +268,524 @@ namespace discenfw
 				}
 			}
 
-			Episodes.push_back(episode);
+			if (CompactStorage)
+			{
+				CompactStoredEpisodes();
+				CompactEpisodes.AddEpisode(episode);
+			}
+			else
+			{
+				Episodes.push_back(episode);
+			}
+			if (StateIndexEnabled)
+			{
+				// index the new episode before it is spilled
+				UpdateEpisodeIndex();
+			}
+			if (MaxResidentEpisodes > 0 && SpilledEpisodes.IsOpen()
+				&& CompactEpisodes.GetEpisodeCount() + Episodes.size() > MaxResidentEpisodes)
+			{
+				SpillStoredEpisodes();
+			}
 			if (episode->Succeded())
 			{
-				if (!BestEpisode)
+				UpdateBestEpisodes(episode);
+			}
+
+			return true;
+		}
+
+
+		void Experience::UpdateBestEpisodes(std::shared_ptr<Episode> episode)
+		{
+			if (!BestEpisode)
+			{
+				BestEpisode = episode;
+				BestEpisodes.push_back(BestEpisode);
+			}
+			else if(episode->Performance >= BestEpisode->Performance)
+			{
+				if (episode->Performance > BestEpisode->Performance)
 				{
-					BestEpisode = episode;
-					BestEpisodes.push_back(BestEpisode);
+					BestEpisodes.clear();
 				}
-				else if(episode->Performance >= BestEpisode->Performance)
+				BestEpisode = episode;
+				BestEpisodes.push_back(BestEpisode);
+			}
+		}
+
+
+		EpisodeView Experience::GetEpisode(size_t index) const
+		{
+			const size_t spilledCount = SpilledEpisodes.GetEpisodeCount();
+			const size_t compactCount = CompactEpisodes.GetEpisodeCount();
+			if (index < spilledCount || index >= GetEpisodeCount())
+			{
+				// spilled episodes must be read with LoadEpisode()
+				return EpisodeView(&EmptyEpisode);
+			}
+			if (index < spilledCount + compactCount)
+			{
+				return CompactEpisodes.GetEpisode(index - spilledCount);
+			}
+			const size_t episodeIndex = index - spilledCount - compactCount;
+			if (!SnapshotRepetitionsCounts.empty())
+			{
+				return EpisodeView(Episodes[episodeIndex].get(), SnapshotRepetitionsCounts[episodeIndex]);
+			}
+			return EpisodeView(Episodes[episodeIndex].get());
+		}
+
+
+		std::shared_ptr<Episode> Experience::LoadEpisode(size_t index) const
+		{
+			if (index >= GetEpisodeCount())
+			{
+				return nullptr;
+			}
+			if (index < SpilledEpisodes.GetEpisodeCount())
+			{
+				return SpilledEpisodes.ReadEpisode(index);
+			}
+			return GetEpisode(index).ToEpisode();
+		}
+
+
+		bool Experience::ForEachEpisode(const std::function<void(const EpisodeView&)>& episodeFunction) const
+		{
+			if (!SpilledEpisodes.ForEachEpisode(episodeFunction))
+			{
+				return false;
+			}
+			for (size_t i = 0; i < CompactEpisodes.GetEpisodeCount(); i++)
+			{
+				episodeFunction(CompactEpisodes.GetEpisode(i));
+			}
+			for (size_t i = 0; i < Episodes.size(); i++)
+			{
+				episodeFunction(SnapshotRepetitionsCounts.empty() ? EpisodeView(Episodes[i].get())
+					: EpisodeView(Episodes[i].get(), SnapshotRepetitionsCounts[i]));
+			}
+			return true;
+		}
+
+
+		void Experience::SetCompactStorage(bool enabled)
+		{
+			CompactStorage = enabled;
+			if (CompactStorage)
+			{
+				CompactStoredEpisodes();
+			}
+			else if (CompactEpisodes.GetEpisodeCount() > 0)
+			{
+				std::vector< std::shared_ptr<Episode> > episodes;
+				episodes.reserve(CompactEpisodes.GetEpisodeCount() + Episodes.size());
+				for (size_t i = 0; i < CompactEpisodes.GetEpisodeCount(); i++)
 				{
-					if (episode->Performance > BestEpisode->Performance)
+					episodes.push_back(CompactEpisodes.GetEpisode(i).ToEpisode());
+				}
+				episodes.insert(episodes.end(), Episodes.cbegin(), Episodes.cend());
+				Episodes.swap(episodes);
+				CompactEpisodes.Clear();
+				UpdateLastIndexedEpisode();
+			}
+		}
+
+
+		bool Experience::SetEpisodeSpill(const std::string& logFilePath, size_t maxResidentEpisodes)
+		{
+			if (logFilePath.empty())
+			{
+				// load the spilled episodes back in memory
+				if (SpilledEpisodes.GetEpisodeCount() > 0)
+				{
+					std::vector< std::shared_ptr<Episode> > episodes;
+					episodes.reserve(GetEpisodeCount());
+					const bool loaded = SpilledEpisodes.ForEachEpisode([&episodes](const EpisodeView& episode)
+					{
+						episodes.push_back(episode.ToEpisode());
+					});
+					if (!loaded)
+					{
+						LogMessage(LOG_ERROR, "Failed to load spilled episodes.", "DiScenFw");
+						return false;
+					}
+					for (size_t i = 0; i < CompactEpisodes.GetEpisodeCount(); i++)
 					{
-						BestEpisodes.clear();
+						episodes.push_back(CompactEpisodes.GetEpisode(i).ToEpisode());
 					}
-					BestEpisode = episode;
-					BestEpisodes.push_back(BestEpisode);
+					episodes.insert(episodes.end(), Episodes.cbegin(), Episodes.cend());
+					Episodes.swap(episodes);
+					CompactEpisodes.Clear();
 				}
+				SpilledEpisodes.Close();
+				MaxResidentEpisodes = 0;
+				UpdateLastIndexedEpisode();
+				if (CompactStorage)
+				{
+					CompactStoredEpisodes();
+				}
+				return true;
 			}
 
+			if (logFilePath != SpilledEpisodes.GetFilePath())
+			{
+				if (SpilledEpisodes.GetEpisodeCount() > 0)
+				{
+					// the spilled episodes are loaded before moving them to the new log file
+					SetEpisodeSpill("", 0);
+				}
+				if (!SpilledEpisodes.Open(logFilePath))
+				{
+					MaxResidentEpisodes = 0;
+					return false;
+				}
+			}
+			MaxResidentEpisodes = maxResidentEpisodes;
+			if (MaxResidentEpisodes > 0 && CompactEpisodes.GetEpisodeCount() + Episodes.size() > MaxResidentEpisodes)
+			{
+				SpillStoredEpisodes();
+			}
 			return true;
 		}
 
 
+		void Experience::CompactStoredEpisodes()
+		{
+			for (const std::shared_ptr<Episode>& episode : Episodes)
+			{
+				CompactEpisodes.AddEpisode(episode);
+			}
+			Episodes.clear();
+			UpdateLastIndexedEpisode();
+		}
+
+
+		void Experience::SpillStoredEpisodes()
+		{
+			const size_t spilledCount = SpilledEpisodes.GetEpisodeCount();
+			bool spilled = true;
+			for (size_t i = 0; spilled && i < CompactEpisodes.GetEpisodeCount(); i++)
+			{
+				spilled = SpilledEpisodes.AppendEpisode(CompactEpisodes.GetEpisode(i), CompactEpisodes.GetFingerprint(i));
+			}
+			for (size_t i = 0; spilled && i < Episodes.size(); i++)
+			{
+				spilled = SpilledEpisodes.AppendEpisode(EpisodeView(Episodes[i].get()), Episodes[i]->GetFingerprint());
+			}
+			if (!spilled)
+			{
+				// keep all the episodes in memory
+				SpilledEpisodes.Truncate(spilledCount);
+				MaxResidentEpisodes = 0;
+				LogMessage(LOG_ERROR, "Failed to spill episodes, episodes are kept in memory.", "DiScenFw");
+				return;
+			}
+			CompactEpisodes.Clear();
+			Episodes.clear();
+			UpdateLastIndexedEpisode();
+		}
+
+
+		void Experience::ClearEpisodes()
+		{
+			Episodes.clear();
+			CompactEpisodes.Clear();
+			SpilledEpisodes.Clear();
+			EpisodeFingerprints.clear();
+			StatePositions.clear();
+			IndexedEpisodeResults.clear();
+			IndexedEpisodeCount = 0;
+			LastIndexedEpisode = nullptr;
+			RewriteCount++;
+		}
+
+
+		void Experience::SetStateIndexEnabled(bool enabled)
+		{
+			if (enabled == StateIndexEnabled)
+			{
+				return;
+			}
+			StateIndexEnabled = enabled;
+			// rebuild the whole index (including states) or release the state index
+			EpisodeFingerprints.clear();
+			StatePositions.clear();
+			IndexedEpisodeResults.clear();
+			IndexedEpisodeCount = 0;
+			UpdateEpisodeIndex();
+		}
+
+
+		bool Experience::GetStatePositions(const StateRef& state, std::vector<EpisodeStatePosition>& positions)
+		{
+			positions.clear();
+			if (!StateIndexEnabled)
+			{
+				return false;
+			}
+			UpdateEpisodeIndex();
+			const auto& positionsIt = StatePositions.find(state.get());
+			if (positionsIt != StatePositions.cend())
+			{
+				positions = positionsIt->second;
+			}
+			return true;
+		}
+
+
+		bool Experience::GetEpisodesThroughState(const StateRef& state, std::vector<size_t>& episodeIndices)
+		{
+			return FindEpisodesThroughState(state, false, ActionResult::IN_PROGRESS, episodeIndices);
+		}
+
+
+		bool Experience::GetEpisodesThroughState(const StateRef& state, ActionResult result, std::vector<size_t>& episodeIndices)
+		{
+			return FindEpisodesThroughState(state, true, result, episodeIndices);
+		}
+
+
+		void Experience::IndexEpisodeStates(size_t episodeIndex, const EpisodeView& episode)
+		{
+			IndexedEpisodeResults.push_back(episode.GetResult());
+			auto addPosition = [this, episodeIndex](const StateRef& state, size_t position)
+			{
+				if (state)
+				{
+					EpisodeStatePosition statePosition;
+					statePosition.EpisodeIndex = episodeIndex;
+					statePosition.Position = position;
+					StatePositions[state.get()].push_back(statePosition);
+				}
+			};
+			const size_t transitionCount = episode.GetTransitionCount();
+			for (size_t t = 0; t < transitionCount; t++)
+			{
+				addPosition(episode.GetStartState(t), t);
+			}
+			addPosition(transitionCount > 0 ? episode.GetLastState() : episode.GetInitialState(), transitionCount);
+		}
+
+
+		bool Experience::FindEpisodesThroughState(
+			const StateRef& state,
+			bool filterResult,
+			ActionResult result,
+			std::vector<size_t>& episodeIndices
+			)
+		{
+			episodeIndices.clear();
+			if (!StateIndexEnabled)
+			{
+				return false;
+			}
+			UpdateEpisodeIndex();
+			const auto& positionsIt = StatePositions.find(state.get());
+			if (positionsIt == StatePositions.cend())
+			{
+				return true;
+			}
+			for (const EpisodeStatePosition& statePosition : positionsIt->second)
+			{
+				// positions in the same episode are contiguous
+				const size_t episodeIndex = statePosition.EpisodeIndex;
+				if (!episodeIndices.empty() && episodeIndices.back() == episodeIndex)
+				{
+					continue;
+				}
+				if (!filterResult || IndexedEpisodeResults[episodeIndex] == result)
+				{
+					episodeIndices.push_back(episodeIndex);
+				}
+			}
+			return true;
+		}
+
+
+		void Experience::MergeExperiences(const std::vector< std::shared_ptr<Experience> >& experiences)
+		{
+			// weighted sums of the state-action values (and sums of weights) of all the experiences
+			std::map< StateActionRef, std::pair<double, double> > valueSums;
+			auto addValues = [&valueSums](const Experience& experience)
+			{
+				std::map<StateActionRef, int> visitCounts;
+				experience.ForEachEpisode([&visitCounts](const EpisodeView& episode)
+				{
+					// a stored episode stands for itself and all its repetitions
+					const int occurrences = 1 + episode.GetRepetitionsCount();
+					for (size_t t = 0; t < episode.GetTransitionCount(); t++)
+					{
+						visitCounts[StateActionRef(episode.GetStartState(t), episode.GetActionTaken(t))] += occurrences;
+					}
+				});
+				for (const auto& stateActionValue : experience.StateActionValues)
+				{
+					const auto& countIt = visitCounts.find(stateActionValue.first);
+					const double weight = countIt != visitCounts.cend() ? (double)countIt->second : 1.0;
+					std::pair<double, double>& valueSum = valueSums[stateActionValue.first];
+					valueSum.first += weight * (double)stateActionValue.second;
+					valueSum.second += weight;
+				}
+			};
+
+			RewriteCount++;
+			addValues(*this);
+			std::set<Transition> failedTransitions(FailedTransitions.cbegin(), FailedTransitions.cend());
+			for (const std::shared_ptr<Experience>& experience : experiences)
+			{
+				if (!experience || experience.get() == this)
+				{
+					continue;
+				}
+				addValues(*experience);
+				if (experience->Level > Level)
+				{
+					Level = experience->Level;
+				}
+				for (const Transition& transition : experience->FailedTransitions)
+				{
+					if (failedTransitions.insert(transition).second)
+					{
+						FailedTransitions.push_back(transition);
+					}
+				}
+			}
+
+			// failed transitions of the episodes are added only if not present
+			for (const std::shared_ptr<Experience>& experience : experiences)
+			{
+				if (!experience || experience.get() == this)
+				{
+					continue;
+				}
+				experience->ForEachEpisode([this](const EpisodeView& episode)
+				{
+					StoreEpisode(episode.ToEpisode());
+				});
+			}
+
+			// best episodes are merged also if not stored (e.g. episodes cleared after training),
+			// those already stored were added to the best episodes by StoreEpisode()
+			auto sameEpisode = [](const Episode& episode1, const Episode& episode2)
+			{
+				if (episode1.InitialState != episode2.InitialState
+					|| episode1.LastState != episode2.LastState
+					|| episode1.TransitionSequence.size() != episode2.TransitionSequence.size())
+				{
+					return false;
+				}
+				for (size_t t = 0; t < episode1.TransitionSequence.size(); t++)
+				{
+					const Transition& transition1 = episode1.TransitionSequence[t];
+					const Transition& transition2 = episode2.TransitionSequence[t];
+					if (transition1.StartState != transition2.StartState
+						|| transition1.EndState != transition2.EndState
+						|| !(*transition1.ActionTaken == *transition2.ActionTaken))
+					{
+						return false;
+					}
+				}
+				return true;
+			};
+			for (const std::shared_ptr<Experience>& experience : experiences)
+			{
+				if (!experience || experience.get() == this)
+				{
+					continue;
+				}
+				for (const std::shared_ptr<Episode>& bestEpisode : experience->BestEpisodes)
+				{
+					const bool found = std::find_if(BestEpisodes.cbegin(), BestEpisodes.cend(),
+						[&sameEpisode, &bestEpisode](const std::shared_ptr<Episode>& episode)
+						{
+							return sameEpisode(*episode, *bestEpisode);
+						}) != BestEpisodes.cend();
+					if (!found)
+					{
+						UpdateBestEpisodes(EpisodeView(bestEpisode.get()).ToEpisode());
+					}
+				}
+			}
+
+			StateActionValues.clear();
+			for (const auto& valueSum : valueSums)
+			{
+				StateActionValues[valueSum.first] = (float)(valueSum.second.first / valueSum.second.second);
+			}
+		}
+
+
+		std::shared_ptr<Experience> Experience::CreateSnapshot() const
+		{
+			std::shared_ptr<Experience> snapshot = std::make_shared<Experience>();
+			snapshot->Model = Model;
+			snapshot->Goal = Goal;
+			snapshot->Role = Role;
+			snapshot->Agent = Agent;
+			snapshot->Level = Level;
+			snapshot->SystemFailureIgnored = SystemFailureIgnored;
+			snapshot->DiscountingConstant = DiscountingConstant;
+			if (SpilledEpisodes.GetEpisodeCount() > 0)
+			{
+				if (!snapshot->SpilledEpisodes.OpenSnapshot(SpilledEpisodes))
+				{
+					return nullptr;
+				}
+			}
+			snapshot->CompactEpisodes = CompactEpisodes;
+			snapshot->CompactStorage = CompactStorage;
+			snapshot->Episodes = Episodes;
+			snapshot->SnapshotRepetitionsCounts.reserve(Episodes.size());
+			for (const std::shared_ptr<Episode>& episode : Episodes)
+			{
+				snapshot->SnapshotRepetitionsCounts.push_back(episode->RepetitionsCount);
+			}
+			snapshot->BestEpisodes = BestEpisodes;
+			snapshot->BestEpisode = BestEpisode;
+			snapshot->FailedTransitions = FailedTransitions;
+			snapshot->StateActionValues = StateActionValues;
+			return snapshot;
+		}
+
+
+		void Experience::MarkReachableStates(StateMarkSet& reachableStates) const
+		{
+			SpilledEpisodes.MarkReachableStates(reachableStates);
+			CompactEpisodes.MarkReachableStates(reachableStates);
+			std::vector<const Episode*> episodes;
+			episodes.reserve(Episodes.size() + BestEpisodes.size());
+			for (const std::shared_ptr<Episode>& episode : Episodes)
+			{
+				episodes.push_back(episode.get());
+			}
+			for (const std::shared_ptr<Episode>& episode : BestEpisodes)
+			{
+				episodes.push_back(episode.get());
+			}
+			for (const Episode* episode : episodes)
+			{
+				reachableStates.insert(episode->InitialState.get());
+				reachableStates.insert(episode->LastState.get());
+				for (const Transition& transition : episode->TransitionSequence)
+				{
+					reachableStates.insert(transition.StartState.get());
+					reachableStates.insert(transition.EndState.get());
+				}
+			}
+			for (const Transition& transition : FailedTransitions)
+			{
+				reachableStates.insert(transition.StartState.get());
+				reachableStates.insert(transition.EndState.get());
+			}
+			for (const auto& stateActionValue : StateActionValues)
+			{
+				reachableStates.insert(stateActionValue.first.State.get());
+			}
+		}
+
+
 		bool Experience::StateActionValueDefined(const StateActionRef& stateAction) const
 		{
 			return StateActionValues.find(stateAction)!=StateActionValues.cend();
@@ -212,6 +811,10 @@ namespace discenfw
 				return;
 			}
 			StateActionValues[stateAction] = actionValue;
+			if (StateActionChangesTracked)
+			{
+				ChangedStateActions.insert(stateAction);
+			}
 		}
 
 
@@ -224,6 +827,21 @@ namespace discenfw
 		void Experience::ClearStateActionValues()
 		{
 			StateActionValues.clear();
+			RewriteCount++;
+		}
+
+
+		void Experience::SetStateActionChangesTracked(bool tracked)
+		{
+			StateActionChangesTracked = tracked;
+			ChangedStateActions.clear();
+		}
+
+
+		void Experience::TakeChangedStateActions(std::vector<StateActionRef>& stateActions)
+		{
+			stateActions.assign(ChangedStateActions.cbegin(), ChangedStateActions.cend());
+			ChangedStateActions.clear();
 		}
 
 
@@ -239,7 +857,7 @@ namespace discenfw
 			}
 			BestEpisode = nullptr;
 			BestEpisodes.clear();
-			Episodes.clear();
+			ClearEpisodes();
 			StateActionValues.clear();
 			FailedTransitions.clear();
 			Level = ExperienceLevel::NONE;
@@ -0,0 +1,321 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/xp/ExperienceJournal.h>
+#include <discenfw/xp/EnvironmentModel.h>
+#include <discenfw/util/MessageLog.h>
+
+#include "../JSON/JsonExperience.h"
+#include "../JSON/JsonEnvironmentModel.h"
+
+#include <gpvulc/json/RapidJsonInclude.h> // ParseException, FormatException
+
+#include <sstream>
+
+namespace
+{
+	// Journal header line: tag, size and hash of the experience file (snapshot) the journal was started for
+	const char* JournalTag = "Journal";
+
+	// Record layout: a header line (tag, size of the states text, size of the experience update text),
+	// followed by the two JSON texts
+	const char* RecordTag = "Record";
+
+
+	// FNV-1a hash, stable across platforms and builds (unlike std::hash)
+	uint64_t HashText(const std::string& text)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		for (const char c : text)
+		{
+			hash = (hash ^ (unsigned char)c) * 1099511628211ULL;
+		}
+		return hash;
+	}
+}
+
+
+namespace discenfw
+{
+	namespace xp
+	{
+
+		ExperienceJournal::ExperienceJournal()
+		{
+		}
+
+
+		ExperienceJournal::~ExperienceJournal()
+		{
+			Close();
+		}
+
+
+		bool ExperienceJournal::Start(
+			const std::string& filePath,
+			const std::shared_ptr<Experience>& experience,
+			const std::vector<StateRef>& savedStates,
+			const std::string& snapshotText
+			)
+		{
+			Close();
+			File.open(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+			SnapshotSize = (uint64_t)snapshotText.size();
+			SnapshotHash = HashText(snapshotText);
+			const std::string header = std::string(JournalTag) + " "
+				+ std::to_string(SnapshotSize) + " " + std::to_string(SnapshotHash) + "\n";
+			if (File.is_open())
+			{
+				File << header;
+				File.flush();
+			}
+			if (!File.is_open() || !File)
+			{
+				LogMessage(LOG_ERROR, "Failed to create experience journal " + filePath, "DiScenFw");
+				File.close();
+				return false;
+			}
+			FilePath = filePath;
+			FileSize = (uint64_t)header.size();
+			JournaledExperience = experience;
+			RewriteCount = experience->GetRewriteCount();
+			EpisodeCount = experience->GetEpisodeCount();
+			FailedTransitionCount = experience->FailedTransitions.size();
+			experience->SetStateActionChangesTracked(true);
+			States = savedStates;
+			StateIndices.reserve(States.size());
+			for (int i = 0; i < (int)States.size(); i++)
+			{
+				StateIndices[States[i].get()] = i;
+			}
+			return true;
+		}
+
+
+		void ExperienceJournal::Close()
+		{
+			if (File.is_open())
+			{
+				File.close();
+			}
+			std::shared_ptr<Experience> experience = JournaledExperience.lock();
+			if (experience)
+			{
+				experience->SetStateActionChangesTracked(false);
+			}
+			JournaledExperience.reset();
+			FileSize = 0;
+			RecordCount = 0;
+			EpisodeCount = 0;
+			FailedTransitionCount = 0;
+			States.clear();
+			StateIndices.clear();
+		}
+
+
+		bool ExperienceJournal::CanAppend(const std::shared_ptr<Experience>& experience) const
+		{
+			return IsStarted()
+				&& experience == JournaledExperience.lock()
+				&& experience->GetRewriteCount() == RewriteCount
+				&& experience->GetEpisodeCount() >= EpisodeCount
+				&& experience->FailedTransitions.size() >= FailedTransitionCount;
+		}
+
+
+		bool ExperienceJournal::Append(const std::shared_ptr<Experience>& experience)
+		{
+			if (!CanAppend(experience))
+			{
+				return false;
+			}
+
+			// collect the added data, the new spilled episodes are read from the log file
+			const size_t episodeCount = experience->GetEpisodeCount();
+			const size_t spilledCount = experience->GetSpilledEpisodeCount();
+			std::vector< std::shared_ptr<Episode> > loadedEpisodes;
+			std::vector<EpisodeView> episodes;
+			episodes.reserve(episodeCount - EpisodeCount);
+			for (size_t i = EpisodeCount; i < episodeCount; i++)
+			{
+				if (i < spilledCount)
+				{
+					std::shared_ptr<Episode> episode = experience->LoadEpisode(i);
+					if (!episode)
+					{
+						return false;
+					}
+					loadedEpisodes.push_back(episode);
+					episodes.push_back(EpisodeView(episode.get()));
+				}
+				else
+				{
+					episodes.push_back(experience->GetEpisode(i));
+				}
+			}
+			const std::vector<Transition> failedTransitions(
+				experience->FailedTransitions.cbegin() + FailedTransitionCount,
+				experience->FailedTransitions.cend()
+				);
+			std::vector<StateActionRef> stateActions;
+			experience->TakeChangedStateActions(stateActions);
+			if (episodes.empty() && failedTransitions.empty() && stateActions.empty())
+			{
+				return true;
+			}
+
+			std::vector<StateRef> newStates;
+			for (const EpisodeView& episode : episodes)
+			{
+				AddState(episode.GetInitialState(), newStates);
+				for (size_t t = 0; t < episode.GetTransitionCount(); t++)
+				{
+					AddState(episode.GetStartState(t), newStates);
+					AddState(episode.GetEndState(t), newStates);
+				}
+				AddState(episode.GetLastState(), newStates);
+			}
+			for (const Transition& transition : failedTransitions)
+			{
+				AddState(transition.StartState, newStates);
+				AddState(transition.EndState, newStates);
+			}
+			for (const StateActionRef& stateAction : stateActions)
+			{
+				AddState(stateAction.State, newStates);
+			}
+
+			std::string knowlJsonText;
+			if (!newStates.empty())
+			{
+				EnvironmentModelKnowledgeToJson(experience->GetModel(), knowlJsonText, &newStates);
+			}
+			std::string updateJsonText;
+			ExperienceUpdateToJson(experience, episodes, failedTransitions, stateActions, updateJsonText, &StateIndices);
+
+			const std::string header = std::string(RecordTag) + " "
+				+ std::to_string(knowlJsonText.size()) + " " + std::to_string(updateJsonText.size()) + "\n";
+			File << header << knowlJsonText << updateJsonText;
+			File.flush();
+			if (!File)
+			{
+				// the changed state-actions were taken, start again with a complete save
+				LogMessage(LOG_ERROR, "Failed to write experience journal " + FilePath, "DiScenFw");
+				Close();
+				return false;
+			}
+			FileSize += (uint64_t)(header.size() + knowlJsonText.size() + updateJsonText.size());
+			RecordCount++;
+			EpisodeCount = episodeCount;
+			FailedTransitionCount = experience->FailedTransitions.size();
+			return true;
+		}
+
+
+		bool ExperienceJournal::Replay(
+			const std::string& filePath,
+			const std::string& snapshotText,
+			const std::shared_ptr<Experience>& experience,
+			std::vector<StateRef>& stateTable
+			)
+		{
+			std::ifstream file(filePath, std::ios::in | std::ios::binary);
+			if (!file.is_open())
+			{
+				LogMessage(LOG_ERROR, "Failed to read experience journal " + filePath, "DiScenFw");
+				return false;
+			}
+			std::string header;
+			if (std::getline(file, header))
+			{
+				std::istringstream headerStream(header);
+				std::string tag;
+				uint64_t snapshotSize = 0;
+				uint64_t snapshotHash = 0;
+				if (!(headerStream >> tag >> snapshotSize >> snapshotHash) || tag != JournalTag
+					|| snapshotSize != (uint64_t)snapshotText.size() || snapshotHash != HashText(snapshotText))
+				{
+					LogMessage(LOG_WARNING, "Experience journal " + filePath + " was not saved for this experience file, ignored.", "DiScenFw");
+					return true;
+				}
+			}
+			std::shared_ptr<EnvironmentModel> model = experience->GetModel();
+			std::string knowlJsonText;
+			std::string updateJsonText;
+			std::vector<StateRef> newStates;
+			while (std::getline(file, header))
+			{
+				std::istringstream headerStream(header);
+				std::string tag;
+				size_t knowlSize = 0;
+				size_t updateSize = 0;
+				if (!(headerStream >> tag >> knowlSize >> updateSize) || tag != RecordTag)
+				{
+					LogMessage(LOG_WARNING, "Invalid record in experience journal " + filePath + ", the rest of the file is ignored.", "DiScenFw");
+					break;
+				}
+				knowlJsonText.resize(knowlSize);
+				updateJsonText.resize(updateSize);
+				file.read(&knowlJsonText[0], (std::streamsize)knowlSize);
+				file.read(&updateJsonText[0], (std::streamsize)updateSize);
+				if (!file)
+				{
+					LogMessage(LOG_WARNING, "Incomplete record at the end of experience journal " + filePath + " ignored.", "DiScenFw");
+					break;
+				}
+
+				std::string errMsg;
+				try
+				{
+					if (knowlSize > 0)
+					{
+						EnvironmentStatesFromJson(knowlJsonText, newStates);
+						for (const StateRef& state : newStates)
+						{
+							stateTable.push_back(model->GetStoredState(state));
+						}
+					}
+					ExperienceUpdateFromJson(updateJsonText, experience, &stateTable);
+				}
+				catch (gpvulc::json::ParseException parseException)
+				{
+					errMsg = GetParseExceptionErrorMessage(parseException);
+				}
+				catch (gpvulc::json::FormatException formatException)
+				{
+					errMsg = std::string("JSON assert failed: ") + formatException.what();
+				}
+				catch (gpvulc::json::ContentException contentException)
+				{
+					errMsg = contentException.what();
+				}
+				if (!errMsg.empty())
+				{
+					LogMessage(LOG_ERROR, "Error reading experience journal " + filePath + ":\n" + errMsg, "DiScenFw");
+					return false;
+				}
+			}
+			return true;
+		}
+
+
+		void ExperienceJournal::AddState(const StateRef& state, std::vector<StateRef>& newStates)
+		{
+			if (!state || StateIndices.find(state.get()) != StateIndices.cend())
+			{
+				return;
+			}
+			StateIndices[state.get()] = (int)States.size();
+			States.push_back(state);
+			newStates.push_back(state);
+		}
+
+	} // namespace xp
+}
+
@@ -27,6 +27,7 @@ namespace discenfw
 		RoleInfo::RoleInfo(const std::string& roleName, const std::string& modelName) :
 			RoleName(roleName),
 			StateInfo(),
+			StateInfoMutex(std::make_shared<std::recursive_mutex>()),
 			ModelName(modelName)
 		{
 		}
@@ -40,6 +41,7 @@ namespace discenfw
 			const std::string& modelName
 			) :
 			StateInfo(),
+			StateInfoMutex(std::make_shared<std::recursive_mutex>()),
 			RoleName(roleName),
 			SuccessCondition(successCondition),
 			FailureCondition(failureCondition),
@@ -136,6 +138,7 @@ namespace discenfw
 
 		EnvironmentStateInfo RoleInfo::GetStateInfo(std::shared_ptr<EnvironmentState> environmentState) const
 		{
+			std::lock_guard<std::recursive_mutex> lock(*StateInfoMutex);
 			if (StateInfo.find(environmentState) == StateInfo.end()
 				|| !StateReward.FeatureRewards.empty())
 			{
@@ -145,11 +148,30 @@ namespace discenfw
 		}
 
 
+		EnvironmentStateInfo RoleInfo::EvaluateStateInfo(
+			std::shared_ptr<EnvironmentState> environmentState,
+			bool systemFailed
+			) const
+		{
+			std::lock_guard<std::recursive_mutex> lock(*StateInfoMutex);
+			const auto& infoIt = StateInfo.find(environmentState);
+			if (infoIt != StateInfo.end() && StateReward.FeatureRewards.empty() && !systemFailed)
+			{
+				return infoIt->second;
+			}
+			EnvironmentStateInfo stateInfo;
+			stateInfo.Result = systemFailed ? ActionResult::FAILED : EvaluateStateConditions(environmentState);
+			ComputeStateReward(environmentState, stateInfo);
+			return stateInfo;
+		}
+
+
 		EnvironmentStateInfo RoleInfo::OverrideStateInfo(
 			std::shared_ptr<EnvironmentState> environmentState,
 			const EnvironmentStateInfo& stateInfo
 			) const
 		{
+			std::lock_guard<std::recursive_mutex> lock(*StateInfoMutex);
 			if (environmentState)
 			{
 				StateInfo[environmentState] = stateInfo;
@@ -167,6 +189,7 @@ namespace discenfw
 			const ActionResult& result
 			) const
 		{
+			std::lock_guard<std::recursive_mutex> lock(*StateInfoMutex);
 			if (environmentState)
 			{
 				GetStateInfo(environmentState);
@@ -185,6 +208,7 @@ namespace discenfw
 
 		EnvironmentStateInfo RoleInfo::OverrideStateReward(std::shared_ptr<EnvironmentState> environmentState, int reward) const
 		{
+			std::lock_guard<std::recursive_mutex> lock(*StateInfoMutex);
 			if (environmentState)
 			{
 				GetStateInfo(environmentState);
@@ -216,13 +240,32 @@ namespace discenfw
 
 		void RoleInfo::Clear() const
 		{
+			std::lock_guard<std::recursive_mutex> lock(*StateInfoMutex);
 			StateInfo.clear();
 		}
 
 
+		void RoleInfo::ReleaseStateInfo(const StateMarkSet& keptStates) const
+		{
+			std::lock_guard<std::recursive_mutex> lock(*StateInfoMutex);
+			for (auto infoIt = StateInfo.begin(); infoIt != StateInfo.end(); )
+			{
+				if (keptStates.find(infoIt->first.get()) == keptStates.cend())
+				{
+					infoIt = StateInfo.erase(infoIt);
+				}
+				else
+				{
+					++infoIt;
+				}
+			}
+		}
+
+
 
 		EnvironmentStateInfo RoleInfo::ComputeStateInfo(std::shared_ptr<EnvironmentState> environmentState) const
 		{
+			std::lock_guard<std::recursive_mutex> lock(*StateInfoMutex);
 			EnvironmentStateInfo stateInfo;
 			stateInfo.Result = EvaluateStateConditions(environmentState);
 			ComputeStateReward(environmentState, stateInfo);
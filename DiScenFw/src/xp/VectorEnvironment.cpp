@@ -0,0 +1,291 @@
+//--------------------------------------------------------------------//
+// Digital Scenario Framework                                         //
+//  by Giovanni Paolo Vigano', 2021                                   //
+//--------------------------------------------------------------------//
+//
+// Distributed under the MIT Software License.
+// See http://opensource.org/licenses/MIT
+//
+
+#include <discenfw/xp/VectorEnvironment.h>
+#include <discenfw/xp/CyberSystemAgent.h>
+#include <discenfw/RL/IAgent.h>
+#include <discenfw/util/MessageLog.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace discenfw
+{
+	namespace xp
+	{
+
+		VectorEnvironment::VectorEnvironment()
+		{
+		}
+
+
+		VectorEnvironment::~VectorEnvironment()
+		{
+			StopWorkers();
+		}
+
+
+		bool VectorEnvironment::Create(
+			int count,
+			CyberSystemMaker makeCyberSystem,
+			const std::string& roleName,
+			const std::string& goalName
+			)
+		{
+			StopWorkers();
+			Agents.clear();
+			for (int i = 0; i < count; i++)
+			{
+				std::shared_ptr<ICyberSystem> cyberSystem = makeCyberSystem ? makeCyberSystem() : nullptr;
+				if (!cyberSystem)
+				{
+					LogMessage(LOG_ERROR, "Failed to create cyber system instance " + std::to_string(i), "DiScenFw");
+					Agents.clear();
+					return false;
+				}
+				std::shared_ptr<CyberSystemAgent> agent = std::make_shared<CyberSystemAgent>(
+					cyberSystem, roleName, roleName + "_" + std::to_string(i));
+				if (!goalName.empty())
+				{
+					agent->SetCurrentGoal(goalName);
+				}
+				// initialize sequentially, roles and model are shared
+				agent->Initialize();
+				Agents.push_back(agent);
+			}
+			StartWorkers();
+			return true;
+		}
+
+
+		const std::vector<ActionRef>& VectorEnvironment::GetAvailableActions(int envIndex) const
+		{
+			return Agents[envIndex]->GetAvailableActions(true);
+		}
+
+
+		void VectorEnvironment::Reset(VectorStepResult& stepResult)
+		{
+			const size_t size = Agents.size();
+			stepResult.States.assign(size, nullptr);
+			stepResult.FinalStates.assign(size, nullptr);
+			stepResult.Rewards.assign(size, 0);
+			stepResult.Results.assign(size, ActionResult::IN_PROGRESS);
+			stepResult.Done.assign(size, 0);
+			ForEachEnvironment([this, &stepResult](int i)
+			{
+				const std::shared_ptr<CyberSystemAgent>& agent = Agents[i];
+				if (!agent->StartNextEpisode())
+				{
+					agent->NewEpisode();
+				}
+				stepResult.States[i] = agent->GetLastState();
+				stepResult.Rewards[i] = agent->GetStateInfo(stepResult.States[i]).Reward;
+			});
+		}
+
+
+		void VectorEnvironment::Step(
+			const std::vector<ActionRef>& actions,
+			bool updateXp,
+			VectorStepResult& stepResult
+			)
+		{
+			if (actions.size() != Agents.size())
+			{
+				LogMessage(LOG_ERROR, "Actions count (" + std::to_string(actions.size())
+					+ ") different from environments count (" + std::to_string(Agents.size()) + ")", "DiScenFw");
+				return;
+			}
+			const size_t size = Agents.size();
+			stepResult.States.resize(size);
+			stepResult.FinalStates.resize(size);
+			stepResult.Rewards.resize(size);
+			stepResult.Results.resize(size);
+			stepResult.Done.resize(size);
+			ForEachEnvironment([this, &actions, updateXp, &stepResult](int i)
+			{
+				StepEnvironment(i, actions[i], updateXp, stepResult);
+			});
+		}
+
+
+		void VectorEnvironment::Train(bool updateXp, VectorStepResult& stepResult)
+		{
+			Step(std::vector<ActionRef>(Agents.size()), updateXp, stepResult);
+		}
+
+
+		void VectorEnvironment::ChooseActions(
+			const std::shared_ptr<IAgent>& agent,
+			const VectorStepResult& stepResult,
+			bool updatePolicy,
+			std::vector<ActionRef>& actions
+			) const
+		{
+			actions.assign(Agents.size(), nullptr);
+			if (!agent || Agents.empty() || stepResult.States.size() != Agents.size())
+			{
+				return;
+			}
+			std::vector< std::vector<ActionRef> > possibleActions(Agents.size());
+			for (size_t i = 0; i < Agents.size(); i++)
+			{
+				possibleActions[i] = GetAvailableActions((int)i);
+			}
+			std::vector<int> chosenActions;
+			agent->ChooseActions(Agents[0]->GetCurrentExperience(), possibleActions, stepResult.States, updatePolicy, chosenActions);
+			for (size_t i = 0; i < Agents.size() && i < chosenActions.size(); i++)
+			{
+				if (chosenActions[i] >= 0 && chosenActions[i] < (int)possibleActions[i].size())
+				{
+					actions[i] = possibleActions[i][chosenActions[i]];
+				}
+			}
+		}
+
+
+		void VectorEnvironment::MarkReachableStates(StateMarkSet& reachableStates)
+		{
+			for (const std::shared_ptr<CyberSystemAgent>& agent : Agents)
+			{
+				agent->FlushLearning();
+				agent->MarkReachableStates(reachableStates);
+			}
+		}
+
+
+		void VectorEnvironment::StepEnvironment(int envIndex, const ActionRef& action, bool updateXp, VectorStepResult& stepResult)
+		{
+			const std::shared_ptr<CyberSystemAgent>& agent = Agents[envIndex];
+			ActionResult result = action ? agent->TakeAction(*action, updateXp) : agent->Train(updateXp);
+
+			StateRef state = agent->GetLastState();
+			stepResult.Results[envIndex] = result;
+			stepResult.Rewards[envIndex] = agent->GetStateInfo(state).Reward;
+			stepResult.FinalStates[envIndex] = nullptr;
+			stepResult.Done[envIndex] = 0;
+			if (result != ActionResult::IN_PROGRESS && result != ActionResult::DENIED)
+			{
+				stepResult.Done[envIndex] = 1;
+				stepResult.FinalStates[envIndex] = state;
+				if (AutoReset && agent->StartNextEpisode())
+				{
+					state = agent->GetLastState();
+				}
+			}
+			stepResult.States[envIndex] = state;
+		}
+
+
+		void VectorEnvironment::ForEachEnvironment(const std::function<void(int)>& envFunction)
+		{
+			if (Workers.empty())
+			{
+				RunWorkRange(0, envFunction);
+				return;
+			}
+
+			// wake up the workers, the calling thread steps the first range
+			{
+				std::lock_guard<std::mutex> lock(WorkersMutex);
+				WorkFunction = &envFunction;
+				PendingWorkers = (int)Workers.size();
+				WorkGeneration++;
+			}
+			WorkCondition.notify_all();
+			RunWorkRange(0, envFunction);
+			std::unique_lock<std::mutex> lock(WorkersMutex);
+			WorkDoneCondition.wait(lock, [this]() { return PendingWorkers == 0; });
+			WorkFunction = nullptr;
+		}
+
+
+		void VectorEnvironment::StartWorkers()
+		{
+			const int size = (int)Agents.size();
+			int threadCount = ThreadCount > 0 ? (int)ThreadCount : (int)std::thread::hardware_concurrency();
+			threadCount = std::max(1, std::min(threadCount, size));
+			WorkersStopping = false;
+			WorkGeneration = 0;
+			Workers.reserve(threadCount - 1);
+			for (int w = 1; w < threadCount; w++)
+			{
+				Workers.push_back(std::thread(&VectorEnvironment::RunWorker, this, w));
+			}
+		}
+
+
+		void VectorEnvironment::StopWorkers()
+		{
+			if (Workers.empty())
+			{
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock(WorkersMutex);
+				WorkersStopping = true;
+			}
+			WorkCondition.notify_all();
+			for (std::thread& worker : Workers)
+			{
+				worker.join();
+			}
+			Workers.clear();
+		}
+
+
+		void VectorEnvironment::RunWorker(int workerIndex)
+		{
+			unsigned lastGeneration = 0;
+			for (;;)
+			{
+				const std::function<void(int)>* envFunction = nullptr;
+				{
+					std::unique_lock<std::mutex> lock(WorkersMutex);
+					WorkCondition.wait(lock, [this, lastGeneration]()
+					{
+						return WorkersStopping || WorkGeneration != lastGeneration;
+					});
+					if (WorkersStopping)
+					{
+						return;
+					}
+					lastGeneration = WorkGeneration;
+					envFunction = WorkFunction;
+				}
+				RunWorkRange(workerIndex, *envFunction);
+				bool lastWorker = false;
+				{
+					std::lock_guard<std::mutex> lock(WorkersMutex);
+					lastWorker = --PendingWorkers == 0;
+				}
+				if (lastWorker)
+				{
+					WorkDoneCondition.notify_one();
+				}
+			}
+		}
+
+
+		void VectorEnvironment::RunWorkRange(int workerIndex, const std::function<void(int)>& envFunction)
+		{
+			// each worker steps a contiguous range of environments
+			const int size = (int)Agents.size();
+			const int workerCount = (int)Workers.size() + 1;
+			const int first = size * workerIndex / workerCount;
+			const int last = size * (workerIndex + 1) / workerCount;
+			for (int i = first; i < last; i++)
+			{
+				envFunction(i);
+			}
+		}
+
+	} // namespace xp
+}
@@ -16,9 +16,111 @@
 #include <gpvulc/console/console_menu.h>
 #include <gpvulc/console/console_util.h>
 
+#include <algorithm>
+
 
 using namespace discenfw;
 
+namespace
+{
+	bool SameVector(const discenfw::Vector3D& v1, const discenfw::Vector3D& v2)
+	{
+		return v1.Right == v2.Right && v1.Forward == v2.Forward && v1.Up == v2.Up;
+	}
+
+
+	bool SameTransform(const discenfw::LocalTransform& t1, const discenfw::LocalTransform& t2)
+	{
+		if (t1.ParentId != t2.ParentId || t1.UseCoordSys != t2.UseCoordSys)
+		{
+			return false;
+		}
+		if (t1.UseCoordSys)
+		{
+			return SameVector(t1.CoordSys.Origin, t2.CoordSys.Origin)
+				&& SameVector(t1.CoordSys.RightAxis, t2.CoordSys.RightAxis)
+				&& SameVector(t1.CoordSys.ForwardAxis, t2.CoordSys.ForwardAxis)
+				&& SameVector(t1.CoordSys.UpAxis, t2.CoordSys.UpAxis);
+		}
+		return SameVector(t1.Location, t2.Location)
+			&& SameVector(t1.EulerAngles, t2.EulerAngles)
+			&& SameVector(t1.Scale, t2.Scale);
+	}
+
+
+	// Compare entity states and events of two histories, print the first difference found.
+	bool CompareHistories(const discenfw::sim::ScenarioHistory& history1, const discenfw::sim::ScenarioHistory& history2)
+	{
+		using namespace discenfw::sim;
+		if (history1.EntityHistories.size() != history2.EntityHistories.size())
+		{
+			std::cout << "Different number of entity histories." << std::endl;
+			return false;
+		}
+		for (const auto& entityHistoryPair : history1.EntityHistories)
+		{
+			const std::string& entityId = entityHistoryPair.first;
+			const auto& entityHistoryIt = history2.EntityHistories.find(entityId);
+			if (entityHistoryIt == history2.EntityHistories.cend())
+			{
+				std::cout << "History of " << entityId << " not found." << std::endl;
+				return false;
+			}
+			const auto& states1 = entityHistoryPair.second->States;
+			const auto& states2 = entityHistoryIt->second->States;
+			if (states1.size() != states2.size())
+			{
+				std::cout << "Different number of states for " << entityId << "." << std::endl;
+				return false;
+			}
+			for (size_t i = 0; i < states1.size(); i++)
+			{
+				const TemporalState& state1 = *states1[i];
+				const TemporalState& state2 = *states2[i];
+				bool same = std::string(state1.GetClassName()) == state2.GetClassName()
+					&& state1.StartDateTime == state2.StartDateTime
+					&& state1.EndDateTime == state2.EndDateTime
+					&& state1.Origin == state2.Origin;
+				if (same && state1.IsA("ElementState"))
+				{
+					const ElementState& elementState1 = static_cast<const ElementState&>(state1);
+					const ElementState& elementState2 = static_cast<const ElementState&>(state2);
+					same = elementState1.Representation == elementState2.Representation
+						&& SameTransform(elementState1.Transform, elementState2.Transform);
+				}
+				if (!same)
+				{
+					std::cout << "Different state " << i << " for " << entityId << "." << std::endl;
+					return false;
+				}
+			}
+		}
+
+		// events are archived sorted by time
+		std::vector< std::shared_ptr<HistoryEvent> > events1 = history1.Events;
+		std::stable_sort(events1.begin(), events1.end(),
+			[](const std::shared_ptr<HistoryEvent>& e1, const std::shared_ptr<HistoryEvent>& e2) { return e1->DateTime < e2->DateTime; });
+		if (events1.size() != history2.Events.size())
+		{
+			std::cout << "Different number of events." << std::endl;
+			return false;
+		}
+		for (size_t i = 0; i < events1.size(); i++)
+		{
+			const HistoryEvent& event1 = *events1[i];
+			const HistoryEvent& event2 = *history2.Events[i];
+			if (event1.Uri != event2.Uri || event1.Category != event2.Category
+				|| event1.EntityId != event2.EntityId || !(event1.DateTime == event2.DateTime))
+			{
+				std::cout << "Different event " << i << "." << std::endl;
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+
 namespace discenfw_test
 {
 
@@ -35,6 +137,7 @@ namespace discenfw_test
 					"Scenario serialization (errors)",
 					"Scenario simulation",
 					"Catalog serialization",
+					"History archive",
 					//TODO: add XP tests
 					"All"
 				}, "Back");
@@ -89,6 +192,31 @@ namespace discenfw_test
 			};
 
 
+			auto testHistoryArchive = []()
+			{
+				DiScenFw()->LoadScenario("../data/sample_scenario.json");
+				if (DiScenFw()->LoadScenarioHistory("../data/history.json")
+					&& DiScenFw()->ScenarioSimulation()->SaveHistoryArchive("../test/history.dsfh"))
+				{
+					std::cout << "History archive saved." << std::endl;
+					// entity histories and events are replaced (not modified) by loading
+					const sim::ScenarioHistory savedHistory = *DiScenFw()->ScenarioSimulation()->GetHistoryData();
+					if (DiScenFw()->ScenarioSimulation()->LoadHistoryArchive("../test/history.dsfh"))
+					{
+						std::cout << "History archive loaded." << std::endl;
+						if (CompareHistories(savedHistory, *DiScenFw()->ScenarioSimulation()->GetHistoryData()))
+						{
+							std::cout << "History archive OK." << std::endl;
+						}
+						else
+						{
+							std::cout << "History archive error." << std::endl;
+						}
+					}
+				}
+			};
+
+
 			auto testStart = GetTimeNow();
 
 			switch (subTestChoice)
@@ -106,9 +234,13 @@ namespace discenfw_test
 				testCatalogSerialization();
 				break;
 			case 5:
+				testHistoryArchive();
+				break;
+			case 6:
 				testScenarioSerialization();
 				testScenarioSimulation();
 				testCatalogSerialization();
+				testHistoryArchive();
 				break;
 			default:
 				DiScenFw()->ResetAll();
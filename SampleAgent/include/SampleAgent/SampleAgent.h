@@ -50,6 +50,19 @@ namespace sample_agent
 			) override;
 
 
+		/*!
+		Choose an action for each of the given states with a single call.
+		@see discenfw::xp::IAgent::ChooseActions()
+		*/
+		virtual void ChooseActions(
+			const std::shared_ptr<discenfw::xp::Experience> experience,
+			const std::vector< std::vector<discenfw::xp::ActionRef> >& possibleActions,
+			const std::vector<discenfw::xp::StateRef>& envStates,
+			bool updatePolicy,
+			std::vector<int>& chosenActions
+			) override;
+
+
 		/*!
 		Get the overall actions count, return 0 if no choice was made.
 		*/
@@ -105,6 +118,22 @@ namespace sample_agent
 		std::set<discenfw::xp::StateActionRef> KnownActions;
 		std::set<discenfw::xp::StateActionRef> SuccessActions;
 
+		//! Accumulated Boltzmann weights, reused between choices.
+		std::vector<float> Distribution;
+
+
+		/*!
+		Choose an action with a Boltzmann distribution of the state-action values.
+		*/
+		int ChooseBoltzmannAction(
+			const std::shared_ptr<discenfw::xp::Experience> experience,
+			const std::vector<discenfw::xp::ActionRef>& possibleActions,
+			discenfw::xp::StateRef envState,
+			bool updatePolicy,
+			float temperature
+			);
+
+		float GetTemperature() const;
 
 		bool IsStateActionKnown(discenfw::xp::StateActionRef stateAction);
 		float GetStateActionValue(
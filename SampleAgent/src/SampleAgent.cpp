@@ -57,6 +57,37 @@ namespace sample_agent
 		StateRef envState,
 		bool updatePolicy
 		)
+	{
+		return ChooseBoltzmannAction(experience, possibleActions, envState, updatePolicy, GetTemperature());
+	}
+
+
+	void SampleAgent::ChooseActions(
+		const std::shared_ptr<Experience> experience,
+		const std::vector< std::vector<ActionRef> >& possibleActions,
+		const std::vector<StateRef>& envStates,
+		bool updatePolicy,
+		std::vector<int>& chosenActions
+		)
+	{
+		// choose all the actions in a single call, sharing the temperature and the distribution buffer
+		const float temperature = GetTemperature();
+		chosenActions.resize(envStates.size());
+		for (size_t i = 0; i < envStates.size(); i++)
+		{
+			chosenActions[i] = i < possibleActions.size()
+				? ChooseBoltzmannAction(experience, possibleActions[i], envStates[i], updatePolicy, temperature) : -1;
+		}
+	}
+
+
+	int SampleAgent::ChooseBoltzmannAction(
+		const std::shared_ptr<Experience> experience,
+		const std::vector<ActionRef>& possibleActions,
+		StateRef envState,
+		bool updatePolicy,
+		float temperature
+		)
 	{
 		if (possibleActions.empty())
 		{
@@ -79,68 +110,41 @@ namespace sample_agent
 
 		// Use a Boltzmann distribution for policy
 
-		// temperature: high values make the probability
-		// distribution virtually uniform, while low values
-		// make the policy nearly a greedy selection.
-		float temperature = Configuration->NewActionValue;
-		if (temperature < 1.0f)
+		// boost exploration
+		if (updatePolicy && Configuration->BoostExploration)
 		{
-			temperature = 1.0f;
+			for (int i = 0; i < (int)possibleActions.size(); i++)
+			{
+				stateAction.Action = possibleActions[i];
+				if (!IsStateActionKnown(stateAction))
+				{
+					ExplorationActionCount++;
+					ActionChoiceCount++;
+					return i;
+				}
+			}
 		}
 
 		// Accumulator of probability distribution:
 		// each value represent an upper limit for the range related
 		// to the probability of choosing an action.
 		// A random number (0..1) will select an action.
-		std::vector<float> distribution(possibleActions.size(), 0.0f);
+		// Each exponential is computed once and accumulated,
+		// then the random number is scaled by the denominator instead of normalizing the distribution.
+		Distribution.resize(possibleActions.size());
 		float denominatorBoltzmann = 0.0f;
 		for (int i = 0; i < (int)possibleActions.size(); i++)
 		{
 			stateAction.Action = possibleActions[i];
 			denominatorBoltzmann += expf(GetStateActionValue(experience, stateAction) / temperature);
-		}
-
-		//float maxStateVal = -1.0f;
-
-		//bool found = false;
-
-		for (int i = 0; i < (int)possibleActions.size(); i++)
-		{
-			const ActionRef& action = possibleActions[i];
-			float stateActionValue = 0;
-			stateAction.Action = possibleActions[i];
-			// boost exploration
-			if (updatePolicy && Configuration->BoostExploration
-				&& !IsStateActionKnown(stateAction))
-			{
-				chosenAction = i;
-				//found = true;
-				ExplorationActionCount++;
-				ActionChoiceCount++;
-				return chosenAction;
-			}
-			stateActionValue = GetStateActionValue(experience, stateAction);
-
-			// Calculate Boltzmann distribution
-			float p = expf(stateActionValue / temperature) / denominatorBoltzmann;
-			distribution[i] = i > 0 ? distribution[i - 1] + p : p;
-
-			//if (!found || stateActionValue > maxStateVal)
-			//{
-			//	maxStateVal = stateActionValue;
-			//	found = true;
-			//}
-			//if (found && stateActionValue > maxStateVal)
-			//{
-			//	chosenAction = i;
-			//}
+			Distribution[i] = denominatorBoltzmann;
 		}
 
 		// Random number (0..1) used to select an action.
-		float randomValue = RandFloat(0.0f, 1.0f);
+		float randomValue = RandFloat(0.0f, 1.0f) * denominatorBoltzmann;
 		for (int i = 0; i < (int)possibleActions.size(); i++)
 		{
-			if (randomValue < distribution[i])
+			if (randomValue < Distribution[i])
 			{
 				chosenAction = i;
 				stateAction.Action = possibleActions[i];
@@ -153,20 +157,24 @@ namespace sample_agent
 			}
 		}
 
-		//if (chosenAction >= 0)
-		//{
-		//	ActionChoiceCount++;
-		//}
-		//else
-		//{
-		//	chosenAction = RandIndex((int)possibleActions.size());
-		//	ExplorationActionCount++;
-		//}
-
 		return chosenAction;
 	}
 
 
+	float SampleAgent::GetTemperature() const
+	{
+		// temperature: high values make the probability
+		// distribution virtually uniform, while low values
+		// make the policy nearly a greedy selection.
+		float temperature = Configuration->NewActionValue;
+		if (temperature < 1.0f)
+		{
+			temperature = 1.0f;
+		}
+		return temperature;
+	}
+
+
 	int SampleAgent::GetActionChoiceCount() const
 	{
 		return ActionChoiceCount;